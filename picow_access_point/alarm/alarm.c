@@ -0,0 +1,300 @@
+/**
+ * Motor do alarme e renderizador do display (ver alarm.h).
+ */
+#include <string.h>
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/i2c.h"
+#include "hardware/sync.h"
+#include "alarm.h"
+#if PICOW_DUAL_CORE
+#include "pico/multicore.h"
+#endif
+#include "spsc_queue.h"
+#include "seqlock.h"
+#include "latency.h"
+#include "stack_profile.h"
+#include "inc/ssd1306.h"
+
+// =============================================
+// Configurações de Hardware
+// =============================================
+
+// Configuração dos GPIOs
+#define RED_LED_GPIO       13      // Pino do LED vermelho do alarme
+#define PWM_GPIO          21      // Pino do buzzer (PWM)
+#define I2C_SDA           14      // Pino I2C SDA para o display
+#define I2C_SCL           15      // Pino I2C SCL para o display
+
+// Configuração do Buzzer PWM
+#define PWM_FREQ_HZ       1000    // Frequência do bipe em Hz (1 kHz)
+#define CLOCK_DIV         2.0f    // Divisor ajustado para evitar overflow
+#define PWM_WRAP          (uint16_t)(125000000 / (PWM_FREQ_HZ * CLOCK_DIV))  // = 62500
+#define BEEP_DURATION_MS  200     // Duração de cada bipe em ms
+#define BEEP_INTERVAL_MS  100     // Intervalo entre bipes em ms
+
+// Configuração do Display OLED
+#define SSD1306_I2C_ADDR  0x3C    // Endereço I2C do display OLED
+
+// Período do laço do core 1
+#define ALARM_CORE1_PERIOD_MS 5
+
+#define ALARM_QUEUE_LEN   16      // Potência de 2
+#define ALARM_CMD_BATCH   8       // Comandos aplicados por passo do motor
+
+// =============================================
+// Estado
+// =============================================
+
+// Área de renderização do display
+static struct render_area display_area = {
+    .start_column = 0,
+    .end_column = ssd1306_width - 1,
+    .start_page = 0,
+    .end_page = ssd1306_n_pages - 1
+};
+
+static uint8_t ssd1306_buffer[ssd1306_buffer_length]; // Buffer do display
+
+// Privado do motor (core 1 ou laço principal)
+static struct {
+    alarm_state_t pub;                  // Próximo instantâneo a publicar
+    absolute_time_t next_toggle_time;   // Próximo momento para alternar o LED/buzzer
+    absolute_time_t beep_end_time;      // Quando o bipe atual deve terminar
+    absolute_time_t test_end_time;      // Fim do bipe de teste
+    int shown;                          // Estado desenhado no display (-1: nenhum)
+} engine = { .shown = -1 };
+
+static alarm_cmd_t queue_storage[ALARM_QUEUE_LEN];
+static spsc_queue_t queue;
+static alarm_state_t snapshot[2];
+static seqlock_t snapshot_lock;
+static uint32_t dropped;                // Escrito só pelo produtor
+static atomic_uint frames;              // Escrito só pelo renderizador
+
+#if PICOW_DUAL_CORE
+static atomic_bool core1_stop;
+static atomic_bool core1_done;
+#endif
+
+// =============================================
+// Display
+// =============================================
+
+static void display_message(const char *line1, const char *line2) {
+    ssd1306_clear_display(ssd1306_buffer);
+    
+    if (line1) {
+        int x1 = (ssd1306_width - strlen(line1) * 6) / 2; // 6px por caractere
+        ssd1306_draw_string(ssd1306_buffer, x1, 20, line1); // Y = 20px
+    }
+    
+    if (line2) {
+        int x2 = (ssd1306_width - strlen(line2) * 6) / 2;
+        ssd1306_draw_string(ssd1306_buffer, x2, 30, line2); // Y = 30px
+    }
+    
+    uint32_t t0 = latency_begin();
+    render_on_display(ssd1306_buffer, &display_area);
+    latency_end(LATENCY_DISPLAY, t0);
+    atomic_store_explicit(&frames, atomic_load_explicit(&frames, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+}
+
+// =============================================
+// Motor do alarme
+// =============================================
+
+static void apply(const alarm_cmd_t *cmd) {
+    engine.pub.commands++;
+    if (cmd->type == ALARM_CMD_TEST) {
+        if (!engine.pub.active) {
+            engine.pub.testing = true;
+            engine.test_end_time = delayed_by_us(get_absolute_time(), BEEP_DURATION_MS * 1000);
+            printf("Alarme em teste\n");
+        }
+        return;
+    }
+    bool active = cmd->type == ALARM_CMD_ARM;
+    if (active && !engine.pub.active) {
+        engine.next_toggle_time = get_absolute_time();
+    }
+    engine.pub.active = active;
+    engine.pub.testing = false;
+    printf("Alarme %s\n", active ? "ativado" : "desativado");
+}
+
+void alarm_update(void) {
+    // Consome um lote; o resto fica para o próximo passo
+    alarm_cmd_t batch[ALARM_CMD_BATCH];
+    uint32_t n = spsc_queue_pop_batch(&queue, batch, ALARM_CMD_BATCH);
+    uint32_t now = time_us_32();
+    for (uint32_t i = 0; i < n; i++) {
+        latency_record(LATENCY_ALARM_CMD_QUEUE, now - batch[i].t_us);
+        apply(&batch[i]);
+    }
+
+    if (engine.pub.active) {
+        // Alarme ativado - piscar o LED e emitir bipes
+        if (absolute_time_diff_us(get_absolute_time(), engine.next_toggle_time) <= 0) {
+            engine.pub.led_on = !engine.pub.led_on;
+            gpio_put(RED_LED_GPIO, engine.pub.led_on);
+            
+            // Ativa/desativa o buzzer
+            if (engine.pub.led_on) {
+                pwm_set_gpio_level(PWM_GPIO, PWM_WRAP / 2);  // Duty 50%
+                engine.pub.beep_active = true;
+                engine.beep_end_time = delayed_by_us(get_absolute_time(), BEEP_DURATION_MS * 1000);
+            } else {
+                pwm_set_gpio_level(PWM_GPIO, 0);  // Silencia buzzer
+                engine.pub.beep_active = false;
+            }
+            
+            // Configura o próximo tempo de alternância
+            engine.next_toggle_time = delayed_by_us(get_absolute_time(), BEEP_INTERVAL_MS * 1000);
+        }
+        
+        // Desativa o buzzer após o tempo configurado
+        if (engine.pub.beep_active && absolute_time_diff_us(get_absolute_time(), engine.beep_end_time) <= 0) {
+            pwm_set_gpio_level(PWM_GPIO, 0);
+            engine.pub.beep_active = false;
+        }
+    } else if (engine.pub.testing) {
+        // Teste - LED aceso e um bipe
+        bool on = absolute_time_diff_us(get_absolute_time(), engine.test_end_time) > 0;
+        gpio_put(RED_LED_GPIO, on);
+        pwm_set_gpio_level(PWM_GPIO, on ? PWM_WRAP / 2 : 0);
+        engine.pub.led_on = on;
+        engine.pub.beep_active = on;
+        engine.pub.testing = on;
+    } else {
+        // Alarme desativado - LED apagado e buzzer silenciado
+        gpio_put(RED_LED_GPIO, 0);
+        pwm_set_gpio_level(PWM_GPIO, 0);
+        engine.pub.led_on = false;
+        engine.pub.beep_active = false;
+    }
+
+    // As saídas já refletem o lote: latência do envio até o GPIO/PWM
+    if (n) {
+        now = time_us_32();
+        for (uint32_t i = 0; i < n; i++) {
+            latency_record(LATENCY_ALARM_CMD_OUTPUT, now - batch[i].t_us);
+        }
+    }
+
+    seqlock_write(&snapshot_lock, &engine.pub);
+}
+
+// Redesenha só quando a mensagem muda: o quadro ocupa o I2C por ~25 ms. Lê o
+// instantâneo publicado, e não o estado do motor, para poder rodar numa
+// tarefa separada de alarm_update() (build FreeRTOS)
+void alarm_render(void) {
+    alarm_state_t pub;
+    seqlock_read(&snapshot_lock, &pub);
+    int show = pub.active;
+    if (show == engine.shown) {
+        return;
+    }
+    engine.shown = show;
+    if (show) {
+        display_message("ALARME", "EVACUAR");
+    } else {
+        display_message("Sistema", "em repouso");
+    }
+}
+
+// =============================================
+// Interface com a rede
+// =============================================
+
+bool alarm_post(alarm_cmd_type_t type, alarm_cmd_source_t source) {
+    alarm_cmd_t cmd = { .type = type, .source = source, .t_us = time_us_32() };
+    // Console e lwIP podem ser interrupções diferentes no core 0: com elas
+    // mascaradas durante o push, a fila continua tendo um só produtor
+    uint32_t save = save_and_disable_interrupts();
+    bool ok = spsc_queue_push(&queue, &cmd);
+    if (!ok) {
+        dropped++;
+    }
+    restore_interrupts(save);
+    return ok;
+}
+
+void alarm_get_state(alarm_state_t *state) {
+    seqlock_read(&snapshot_lock, state);
+    state->dropped = dropped;
+    state->frames = atomic_load_explicit(&frames, memory_order_relaxed);
+}
+
+// =============================================
+// Inicialização e core 1
+// =============================================
+
+void alarm_init(void) {
+    spsc_queue_init(&queue, queue_storage, sizeof(alarm_cmd_t), ALARM_QUEUE_LEN);
+    seqlock_init(&snapshot_lock, &snapshot[0], &snapshot[1], sizeof(alarm_state_t));
+
+    // Configuração do hardware
+    gpio_init(RED_LED_GPIO);
+    gpio_set_dir(RED_LED_GPIO, GPIO_OUT);
+    gpio_put(RED_LED_GPIO, 0);
+
+    // Configuração do Buzzer PWM
+    gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
+    uint slice = pwm_gpio_to_slice_num(PWM_GPIO);
+    pwm_config cfg = pwm_get_default_config();
+    pwm_config_set_clkdiv(&cfg, CLOCK_DIV);
+    pwm_config_set_wrap(&cfg, PWM_WRAP);
+    pwm_init(slice, &cfg, true);
+    pwm_set_gpio_level(PWM_GPIO, 0);
+
+    // Inicialização do display OLED
+    i2c_init(i2c1, 400 * 1000);
+    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
+    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
+    gpio_pull_up(I2C_SDA);
+    gpio_pull_up(I2C_SCL);
+    
+    // Inicialização do display
+    calculate_render_area_buffer_length(&display_area);
+    ssd1306_init();
+    display_message("Iniciando", "sistema...");
+}
+
+#if PICOW_DUAL_CORE
+static void core1_main(void) {
+    while (!atomic_load_explicit(&core1_stop, memory_order_acquire)) {
+        uintptr_t stack_token = stack_probe_enter();
+        uint32_t t0 = latency_begin();
+        alarm_update();
+        latency_end(LATENCY_LOOP_ALARM, t0);
+        t0 = latency_begin();
+        alarm_render();
+        latency_end(LATENCY_LOOP_DISPLAY, t0);
+        stack_probe_exit(stack_token);
+        sleep_ms(ALARM_CORE1_PERIOD_MS);
+    }
+    atomic_store_explicit(&core1_done, true, memory_order_release);
+}
+#endif
+
+void alarm_start(void) {
+#if PICOW_DUAL_CORE
+    multicore_launch_core1(core1_main);
+#endif
+}
+
+void alarm_stop(void) {
+#if PICOW_DUAL_CORE
+    atomic_store_explicit(&core1_stop, true, memory_order_release);
+    while (!atomic_load_explicit(&core1_done, memory_order_acquire)) {
+        sleep_ms(1);
+    }
+    multicore_reset_core1();
+#endif
+    // Desliga buzzer e LED antes de encerrar
+    gpio_put(RED_LED_GPIO, 0);
+    pwm_set_gpio_level(PWM_GPIO, 0);
+}
@@ -0,0 +1,68 @@
+/**
+ * Motor do alarme (LED e buzzer) e renderizador do display.
+ *
+ * Com PICOW_DUAL_CORE=1 o motor roda sozinho no core 1: a rede (core 0) envia
+ * comandos por uma fila SPSC sem trava e lê o estado publicado por um
+ * seqlock, sem nunca esperar pelo I2C do display. O motor consome os comandos
+ * em lotes e mede, pelo instante gravado em cada um, o tempo na fila e o tempo
+ * até a saída (GPIO/PWM) refletir o comando. Com PICOW_DUAL_CORE=0 (build
+ * de simulação) o laço principal chama alarm_update() e alarm_render() a cada
+ * iteração, com o mesmo caminho de fila e seqlock. No build FreeRTOS os dois
+ * rodam em tarefas próprias (rtos_tasks.h): o renderizador só lê o
+ * instantâneo publicado, então o motor continua sendo o único escritor.
+ */
+#ifndef _ALARM_H_
+#define _ALARM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef PICOW_DUAL_CORE
+#define PICOW_DUAL_CORE 1
+#endif
+
+typedef enum {
+    ALARM_CMD_DISARM,
+    ALARM_CMD_ARM,
+    ALARM_CMD_TEST,         // Um bipe e um piscar, só com o alarme desarmado
+} alarm_cmd_type_t;
+
+typedef enum {
+    ALARM_SRC_HTTP,
+    ALARM_SRC_CONSOLE,
+} alarm_cmd_source_t;
+
+// Mensagem na fila; t_us é o instante do envio (time_us_32)
+typedef struct {
+    uint8_t type;           // alarm_cmd_type_t
+    uint8_t source;         // alarm_cmd_source_t
+    uint32_t t_us;
+} alarm_cmd_t;
+
+// Instantâneo publicado pelo motor
+typedef struct {
+    bool active;            // Alarme armado
+    bool led_on;
+    bool beep_active;
+    bool testing;           // Teste em andamento
+    uint32_t commands;      // Comandos aplicados
+    uint32_t dropped;       // Comandos perdidos com a fila cheia
+    uint32_t frames;        // Quadros enviados ao display (contados pelo renderizador)
+} alarm_state_t;
+
+// Configura GPIO, PWM e display e mostra a mensagem de inicialização
+void alarm_init(void);
+// Inicia o core 1 (PICOW_DUAL_CORE)
+void alarm_start(void);
+// Para o core 1 e desliga LED e buzzer
+void alarm_stop(void);
+
+// Produtores no core 0 (callbacks do lwIP, console); false com a fila cheia
+bool alarm_post(alarm_cmd_type_t type, alarm_cmd_source_t source);
+void alarm_get_state(alarm_state_t *state);
+
+// Passos do motor, chamados pelo core 1, pelo laço principal ou pelas tarefas
+void alarm_update(void);
+void alarm_render(void);
+
+#endif
@@ -0,0 +1,294 @@
+/**
+ * chunk_stream_test: memória constante ao enviar um corpo grande em chunks
+ * (HTTP_CHUNK, http/http_handler.h), no host.
+ *
+ * Um handler gera --lines linhas com HTTP_CHUNK_PRINTF e termina com
+ * HTTP_CHUNK_END, como /metrics e /alarm/events. O tcp_write daqui decodifica
+ * o Transfer-Encoding à medida que os bytes chegam, sem guardar o corpo, e
+ * confere cada byte com a linha esperada. A cada retomada o buffer de envio
+ * reabre com uma janela sorteada, e às vezes o tcp_write recusa com ERR_MEM,
+ * então os pedaços são cortados em qualquer ponto (linha de tamanho, dados ou
+ * CRLF). O teste falha se o corpo decodificado não for o gerado ou se houver
+ * qualquer malloc, calloc ou realloc entre o início e o fim da resposta: a
+ * memória da conexão é o http_ctx_t, qualquer que seja o tamanho do corpo.
+ *
+ * Exemplo:
+ *   chunk_stream_test --lines 100000 --seed 7
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "http_handler.h"
+
+#define TEST_ARENA_SIZE 256
+#define TEST_ERR_MEM_ONE_IN 8   // Uma escrita em 8 recusada com ERR_MEM
+
+static struct {
+    uint32_t lines;
+    unsigned seed;
+} cfg = {
+    .lines = 100000,
+    .seed = 1,
+};
+
+// =============================================
+// Contagem de alocações (-Wl,--wrap=...)
+// =============================================
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+void __real_free(void *p);
+
+static unsigned long allocs;
+
+void *__wrap_malloc(size_t size) {
+    allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    allocs++;
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+    allocs++;
+    return __real_realloc(p, size);
+}
+
+void __wrap_free(void *p) {
+    __real_free(p);
+}
+
+// http_now_ms (prazos dos handlers); este teste não espera por tempo
+uint64_t time_us_64(void) {
+    return 0;
+}
+
+// =============================================
+// Cliente: decodificador de chunks em fluxo
+// =============================================
+
+typedef enum {
+    DEC_SIZE,       // Dígitos hexadecimais da linha de tamanho
+    DEC_SIZE_LF,
+    DEC_DATA,
+    DEC_DATA_CR,
+    DEC_DATA_LF,
+    DEC_LAST_CR,    // CRLF depois do chunk vazio
+    DEC_LAST_LF,
+    DEC_DONE,
+    DEC_BAD,
+} dec_state_t;
+
+static struct {
+    dec_state_t state;
+    uint32_t size;          // Tamanho do chunk atual
+    uint32_t left;          // Bytes do chunk atual ainda por vir
+    uint32_t line;          // Linha esperada
+    char expect[HTTP_LINE_MAX];
+    uint32_t expect_len;
+    uint32_t expect_off;
+    uint64_t body;          // Bytes do corpo decodificados
+    uint32_t chunks;
+    const char *why;
+} dec;
+
+static void expect_line(void) {
+    dec.expect_len = (uint32_t)snprintf(dec.expect, sizeof(dec.expect), "line %lu of %lu\n",
+                                        (unsigned long)dec.line, (unsigned long)cfg.lines);
+    dec.expect_off = 0;
+}
+
+static void dec_fail(const char *why) {
+    dec.state = DEC_BAD;
+    dec.why = why;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static void dec_byte(char c) {
+    switch (dec.state) {
+    case DEC_SIZE:
+        if (c == '\r') {
+            dec.state = DEC_SIZE_LF;
+        } else if (hex_digit(c) >= 0 && dec.size < 0x1000000) {
+            dec.size = dec.size * 16 + hex_digit(c);
+        } else {
+            dec_fail("bad chunk size");
+        }
+        break;
+    case DEC_SIZE_LF:
+        if (c != '\n') {
+            dec_fail("chunk size line without LF");
+        } else if (dec.size == 0) {
+            dec.state = DEC_LAST_CR;
+        } else {
+            dec.left = dec.size;
+            dec.state = DEC_DATA;
+        }
+        break;
+    case DEC_DATA:
+        if (dec.line == cfg.lines || c != dec.expect[dec.expect_off]) {
+            dec_fail("body differs from the generated lines");
+            break;
+        }
+        dec.body++;
+        if (++dec.expect_off == dec.expect_len) {
+            dec.line++;
+            expect_line();
+        }
+        if (--dec.left == 0) {
+            dec.state = DEC_DATA_CR;
+        }
+        break;
+    case DEC_DATA_CR:
+        dec.state = c == '\r' ? DEC_DATA_LF : DEC_BAD;
+        break;
+    case DEC_DATA_LF:
+        if (c != '\n') {
+            dec_fail("chunk data without CRLF");
+            break;
+        }
+        dec.chunks++;
+        dec.size = 0;
+        dec.state = DEC_SIZE;
+        break;
+    case DEC_LAST_CR:
+        dec.state = c == '\r' ? DEC_LAST_LF : DEC_BAD;
+        break;
+    case DEC_LAST_LF:
+        dec.state = c == '\n' ? DEC_DONE : DEC_BAD;
+        break;
+    case DEC_DONE:
+        dec_fail("bytes after the last chunk");
+        break;
+    case DEC_BAD:
+        break;
+    }
+    if (dec.state == DEC_BAD && dec.why == NULL) {
+        dec.why = "bad chunk framing";
+    }
+}
+
+// =============================================
+// lwIP: buffer de envio
+// =============================================
+
+static unsigned long writes, refused;
+
+err_t tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    (void)apiflags;
+    if (rand() % TEST_ERR_MEM_ONE_IN == 0) {
+        refused++;
+        return ERR_MEM;
+    }
+    if (len > pcb->snd_buf) {
+        dec_fail("tcp_write past tcp_sndbuf");
+        return ERR_MEM;
+    }
+    pcb->snd_buf -= len;
+    writes++;
+    const char *p = dataptr;
+    for (u16_t i = 0; i < len; i++) {
+        dec_byte(p[i]);
+    }
+    return ERR_OK;
+}
+
+// =============================================
+// Handler
+// =============================================
+
+static http_status_t lines_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    for (ctx->var[0] = 0; ctx->var[0] < cfg.lines; ctx->var[0]++) {
+        HTTP_CHUNK_PRINTF(ctx, "line %lu of %lu\n", (unsigned long)ctx->var[0], (unsigned long)cfg.lines);
+    }
+    HTTP_CHUNK_END(ctx);
+    HTTP_END(ctx);
+}
+
+static void usage(const char *prog) {
+    printf("usage: %s [--lines N] [--seed N]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        { "lines", required_argument, NULL, 'l' },
+        { "seed", required_argument, NULL, 's' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "l:s:h", options, NULL)) != -1) {
+        switch (opt) {
+        case 'l':
+            cfg.lines = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            cfg.seed = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+    srand(cfg.seed);
+
+    static uint8_t arena_buf[TEST_ARENA_SIZE];
+    static http_ctx_t ctx;
+    static struct tcp_pcb pcb;
+    http_arena_init(&ctx.arena, arena_buf, sizeof(arena_buf));
+    pcb.snd_buf = TCP_SND_BUF;
+    expect_line();
+
+    // O printf abaixo pode alocar o buffer do stdout: conta só a resposta
+    unsigned long allocs_before = allocs;
+    unsigned long resumes = 0;
+    http_ctx_start(&ctx, &pcb, "/lines", NULL);
+    http_status_t status;
+    for (;;) {
+        status = lines_handler(&ctx);
+        if (status != HTTP_WAIT_WRITABLE || dec.state == DEC_BAD) {
+            break;
+        }
+        // tcp_sent: o cliente confirmou, a janela reabre com um tamanho qualquer
+        pcb.snd_buf = 1 + rand() % TCP_SND_BUF;
+        resumes++;
+    }
+    unsigned long allocs_during = allocs - allocs_before;
+
+    printf("chunk stream: %lu lines, %llu body bytes in %lu chunks, %lu resumes, "
+           "%lu writes (%lu refused), %lu allocations while streaming\n",
+           (unsigned long)cfg.lines, (unsigned long long)dec.body, (unsigned long)dec.chunks,
+           resumes, writes, refused, allocs_during);
+    bool ok = true;
+    if (status != HTTP_DONE) {
+        printf("  handler ended with %s\n", http_status_name(status));
+        ok = false;
+    }
+    if (dec.state != DEC_DONE) {
+        printf("  client: %s (line %lu)\n", dec.why ? dec.why : "response ended early",
+               (unsigned long)dec.line);
+        ok = false;
+    } else if (dec.line != cfg.lines) {
+        printf("  client: %lu of %lu lines\n", (unsigned long)dec.line, (unsigned long)cfg.lines);
+        ok = false;
+    }
+    if (allocs_during != 0) {
+        printf("  memory grows with the body\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
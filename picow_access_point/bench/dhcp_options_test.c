@@ -0,0 +1,198 @@
+/**
+ * dhcp_options_test: opções da resposta DHCP (dhcpserver/dhcp_options.h) para
+ * a lista de parâmetros (opção 55) de cada sistema cliente.
+ *
+ * Cada caso é a opção 55 típica de um sistema, como aparece nas capturas do
+ * DHCPDISCOVER, e as opções que a resposta precisa ter, nesta ordem: o
+ * identificador do servidor e o tempo de concessão sempre primeiro, depois o
+ * que o cliente pediu e o servidor conhece, na ordem do pedido, e o END. Os
+ * valores (IP, máscara, concessão) também são conferidos. Os últimos casos
+ * cobrem o cliente sem opção 55, pedidos repetidos e uma resposta sem espaço
+ * para as opções pedidas. Depois vêm os casos da busca na requisição
+ * (dhcp_opt_find): uma opção cortada pelo fim do que chegou não é achada, e
+ * nada além desse fim é lido.
+ *
+ * Exemplo:
+ *   dhcp_options_test --verbose
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <getopt.h>
+
+#include "dhcp_options.h"
+
+#define TEST_OPTIONS_LEN 308    // dhcp_msg_t.options sem o cookie
+#define TEST_MAX_CODES 16
+
+typedef struct {
+    const char *name;
+    const uint8_t *prl;         // NULL: cliente sem opção 55
+    size_t prl_len;
+    size_t space;               // Bytes para as opções; 0 = TEST_OPTIONS_LEN
+    const uint8_t *expect;      // Códigos esperados, sem o END
+    size_t expect_len;
+} test_case_t;
+
+#define LIST(...) (const uint8_t[]){ __VA_ARGS__ }, sizeof((const uint8_t[]){ __VA_ARGS__ })
+
+static const test_case_t cases[] = {
+    { "Windows 10/11", LIST(1, 3, 6, 15, 31, 33, 43, 44, 46, 47, 119, 121, 249, 252), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "macOS", LIST(1, 121, 3, 6, 15, 108, 114, 119, 252, 95, 44, 46), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "iOS", LIST(1, 121, 3, 6, 15, 108, 114, 119, 252), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "Android", LIST(1, 3, 6, 15, 26, 28, 51, 58, 59, 43, 114, 108), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "Linux dhclient", LIST(1, 28, 2, 3, 15, 6, 119, 12, 44, 47, 26, 121, 42), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "systemd-networkd", LIST(1, 3, 6, 12, 15, 28, 42, 43, 119, 121, 249, 252), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "lwIP (ESP32, Pico W)", LIST(1, 3, 28, 6), 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "no option 55", NULL, 0, 0,
+      LIST(54, 51, 1, 3, 6) },
+    { "own order, repeated", LIST(6, 3, 6, 54, 1, 3), 0,
+      LIST(54, 51, 6, 3, 1) },
+    { "only router", LIST(3), 0,
+      LIST(54, 51, 3) },
+    // Só cabem as obrigatórias (2 x 6 bytes) e o END
+    { "no room", LIST(1, 3, 6), 13,
+      LIST(54, 51) },
+};
+
+static const dhcp_opt_server_t server = {
+    .ip = { 192, 168, 4, 1 },
+    .nm = { 255, 255, 255, 0 },
+    .lease_time_s = 24 * 60 * 60,
+};
+
+static bool verbose;
+
+typedef struct {
+    const char *name;
+    const uint8_t *opts;        // Opções depois do cookie, como chegaram
+    size_t len;
+    uint8_t code;
+    int expect_off;             // Posição da opção achada; -1 = não achada
+} find_case_t;
+
+static const find_case_t find_cases[] = {
+    { "found", LIST(53, 1, 1, 55, 3, 1, 3, 6, 255), 55, 3 },
+    { "ends exactly at the datagram end", LIST(53, 1, 1, 55, 3, 1, 3, 6), 55, 3 },
+    { "data cut by the datagram end", LIST(53, 1, 1, 55, 8, 1, 3, 6), 55, -1 },
+    { "length byte cut off", LIST(53, 1, 1, 55), 55, -1 },
+    { "earlier option cut", LIST(53, 1, 1, 12, 200, 55, 1, 1), 55, -1 },
+    { "after pad", LIST(0, 0, 53, 1, 3), 53, 2 },
+    { "after END", LIST(53, 1, 1, 255, 55, 1, 1), 55, -1 },
+    { "missing", LIST(53, 1, 1, 255), 55, -1 },
+};
+
+static bool run_find_case(const find_case_t *t) {
+    // Bytes além do fim valem 55 com tamanho 1: uma leitura além do fim
+    // acharia a opção
+    uint8_t buf[64];
+    memset(buf, 55, sizeof(buf));
+    memcpy(buf, t->opts, t->len);
+    buf[t->len + 1] = 1;
+    const uint8_t *o = dhcp_opt_find(buf, buf + t->len, t->code);
+    int off = o ? (int)(o - buf) : -1;
+    bool ok = off == t->expect_off;
+    if (!ok || verbose) {
+        printf("  find %s: got %d, expected %d\n", t->name, off, t->expect_off);
+    }
+    return ok;
+}
+
+// Valor esperado de cada opção que o servidor conhece
+static bool check_value(uint8_t code, const uint8_t *data, uint8_t len) {
+    static const uint8_t lease[4] = { 0x00, 0x01, 0x51, 0x80 };    // 86400 s
+    switch (code) {
+    case DHCP_OPT_SERVER_ID:
+    case DHCP_OPT_ROUTER:
+    case DHCP_OPT_DNS:
+        return len == 4 && memcmp(data, server.ip, 4) == 0;
+    case DHCP_OPT_SUBNET_MASK:
+        return len == 4 && memcmp(data, server.nm, 4) == 0;
+    case DHCP_OPT_IP_LEASE_TIME:
+        return len == 4 && memcmp(data, lease, 4) == 0;
+    default:
+        return false;
+    }
+}
+
+static bool run_case(const test_case_t *t) {
+    uint8_t buf[TEST_OPTIONS_LEN + 16];
+    memset(buf, 0xaa, sizeof(buf));
+    size_t space = t->space ? t->space : TEST_OPTIONS_LEN;
+    uint8_t *end = dhcp_opt_write_reply(&server, buf, buf + space, t->prl, t->prl_len);
+
+    size_t used = end - buf;
+    if (used > space || end[-1] != DHCP_OPT_END || buf[space] != 0xaa) {
+        printf("  %s: reply overruns its %zu bytes or misses END (%zu used)\n", t->name, space, used);
+        return false;
+    }
+    uint8_t codes[TEST_MAX_CODES];
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < used; i += 2 + buf[i + 1]) {
+        if (n == TEST_MAX_CODES || i + 2 + buf[i + 1] >= used) {
+            printf("  %s: malformed option at byte %zu\n", t->name, i);
+            return false;
+        }
+        if (!check_value(buf[i], &buf[i + 2], buf[i + 1])) {
+            printf("  %s: option %u has the wrong value\n", t->name, buf[i]);
+            return false;
+        }
+        codes[n++] = buf[i];
+    }
+    bool ok = n == t->expect_len && memcmp(codes, t->expect, n) == 0;
+    if (!ok || verbose) {
+        printf("  %s: got", t->name);
+        for (size_t i = 0; i < n; i++) {
+            printf(" %u", codes[i]);
+        }
+        printf(", expected");
+        for (size_t i = 0; i < t->expect_len; i++) {
+            printf(" %u", t->expect[i]);
+        }
+        printf(" (%zu bytes)\n", used);
+    }
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        { "verbose", no_argument, NULL, 'v' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "vh", options, NULL)) != -1) {
+        switch (opt) {
+        case 'v':
+            verbose = true;
+            break;
+        default:
+            printf("usage: %s [--verbose]\n", argv[0]);
+            return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    size_t failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (!run_case(&cases[i])) {
+            failed++;
+        }
+    }
+    for (size_t i = 0; i < sizeof(find_cases) / sizeof(find_cases[0]); i++) {
+        if (!run_find_case(&find_cases[i])) {
+            failed++;
+        }
+    }
+    printf("dhcp options: %zu cases, %zu failed\n",
+           sizeof(cases) / sizeof(cases[0]) + sizeof(find_cases) / sizeof(find_cases[0]), failed);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/**
+ * form_bench: vazão do decodificador de formulários (http/http_form.h) no host.
+ *
+ * Para cada query string do conjunto, copia a string para um buffer (a
+ * decodificação é no lugar) e extrai o parâmetro alarm de duas formas: com
+ * http_form_parse + http_param_enum, como o servidor faz agora, e com
+ * sscanf("alarm=%d"), como fazia antes. Imprime ns por query, MB/s e quantas
+ * queries cada forma entendeu: o sscanf só acha o parâmetro na primeira
+ * posição e em decimal.
+ *
+ * O tamanho no firmware é medido à parte por tools/size_report.py.
+ *
+ * Exemplo:
+ *   form_bench --iterations 5000000
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "http_form.h"
+
+#define QUERY_MAX 128
+
+static const char *const queries[] = {
+    "alarm=1",
+    "alarm=0",
+    "alarm=test",
+    "alarm=on",
+    "x=1&alarm=2",
+    "alarm=1&ts=1712345678",
+    "name=Sala%20de+estar&alarm=on&zone=3",
+    "zone=%C3%A1rea+externa&delay=30&alarm=1",
+};
+#define QUERY_COUNT (sizeof(queries) / sizeof(queries[0]))
+
+static const char *const alarm_names[] = { "off", "on", "test" };
+
+static size_t query_len[QUERY_COUNT];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int decode_form(char *buf) {
+    http_param_t form[HTTP_FORM_MAX_PARAMS];
+    size_t n = http_form_parse(buf, form, HTTP_FORM_MAX_PARAMS);
+    int value;
+    return http_param_enum(form, n, "alarm", alarm_names, 3, &value) ? value : -1;
+}
+
+static int decode_sscanf(char *buf) {
+    int value;
+    return sscanf(buf, "alarm=%d", &value) == 1 ? value : -1;
+}
+
+typedef int (*decode_fn)(char *buf);
+
+static void run(const char *name, decode_fn decode, uint64_t iterations) {
+    char buf[QUERY_MAX];
+    unsigned understood = 0;
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+        memcpy(buf, queries[q], query_len[q] + 1);
+        understood += decode(buf) >= 0;
+    }
+
+    uint64_t bytes = 0;
+    long sum = 0;
+    uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < iterations; i++) {
+        size_t q = i % QUERY_COUNT;
+        memcpy(buf, queries[q], query_len[q] + 1);
+        sum += decode(buf);
+        bytes += query_len[q];
+    }
+    double elapsed = (double)(now_ns() - t0);
+    printf("%-12s %7.1f ns/query %8.1f MB/s  %u/%zu queries understood (checksum %ld)\n",
+           name, elapsed / iterations, bytes / elapsed * 1e3, understood, QUERY_COUNT, sum);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --iterations N     queries decoded per method (default 5000000)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "iterations", required_argument, NULL, 'n' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    uint64_t iterations = 5000000;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'n': iterations = strtoull(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (iterations == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    for (size_t q = 0; q < QUERY_COUNT; q++) {
+        query_len[q] = strlen(queries[q]);
+    }
+
+    run("http_form", decode_form, iterations);
+    run("sscanf", decode_sscanf, iterations);
+    return 0;
+}
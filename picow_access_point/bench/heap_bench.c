@@ -0,0 +1,285 @@
+/**
+ * heap_bench: tempo de pior caso e fragmentação do alocador TLSF
+ * (heap/tlsf.h) contra o malloc da libc, no host.
+ *
+ * A carga imita o heap do build poll: pbufs de RAM e segmentos copiados do
+ * lwIP (60 a 1560 bytes, vida curta), estado de conexão (~1 KB), o buffer
+ * do display (1025 bytes, livre logo depois) e alocações pequenas. Há
+ * --live vagas; cada operação sorteia uma vaga e libera o bloco dela ou
+ * aloca um novo, então o conjunto vivo oscila em volta da metade das vagas.
+ * A mesma sequência (--seed) roda nos dois alocadores, o TLSF num pool de
+ * --pool bytes como o do dispositivo. Cada malloc e free é medido sozinho
+ * no contador de ciclos (o TSC no x86, cntvct no ARM; clock_gettime nos
+ * demais), e o relatório traz p50, p99 e p99.99 de cada um, as falhas por
+ * falta de bloco e, no TLSF, a fragmentação (1 - maior bloco livre / bytes
+ * livres) média e a pior vista. O máximo de tempo no host mede preempções,
+ * não o alocador, então o pior caso do TLSF sai em passos (TLSF_STEPS em
+ * tlsf.h: buscas de bitmap e operações de lista), conferidos contra o limite
+ * teórico; a libc não tem um equivalente.
+ *
+ * No host a libc é a glibc; a newlib do dispositivo não roda aqui.
+ *
+ * Exemplo:
+ *   heap_bench --ops 5000000 --live 64 --pool 65536
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "tlsf.h"
+
+// Histograma de latência em ciclos, exato até BENCH_HIST_CYCLES
+#define BENCH_HIST_CYCLES 100000
+#define BENCH_MAX_LIVE 4096
+
+static struct {
+    uint32_t ops;
+    uint32_t live;
+    uint32_t pool;
+    uint32_t seed;
+    uint32_t check;         // tlsf_check a cada N operações, 0 = só no fim
+} cfg = {
+    .ops = 5000000,
+    .live = 64,
+    .pool = 65536,
+    .seed = 1,
+    .check = 0,
+};
+
+typedef struct {
+    uint32_t hist[BENCH_HIST_CYCLES + 1];   // O último balde junta o resto
+    uint64_t n;
+    uint32_t max_steps;                     // Só no TLSF
+} lat_t;
+
+typedef struct {
+    const char *name;
+    void *(*alloc)(size_t size);
+    void (*release)(void *ptr);
+} allocator_t;
+
+static tlsf_t tlsf;
+static uint8_t *pool;
+
+static void *tlsf_alloc(size_t size) {
+    return tlsf_malloc(&tlsf, size);
+}
+
+static void tlsf_release(void *ptr) {
+    tlsf_free(&tlsf, ptr);
+}
+
+static const allocator_t allocators[] = {
+    { "tlsf", tlsf_alloc, tlsf_release },
+    { "libc", malloc, free },
+};
+
+static uint32_t rng;
+
+static uint32_t next_rand(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+// Tamanho de uma alocação, na proporção aproximada do firmware
+static size_t draw_size(void) {
+    uint32_t r = next_rand() % 100;
+    if (r < 55) {
+        return 60 + next_rand() % 1500;     // pbuf de RAM / segmento TCP
+    }
+    if (r < 80) {
+        return 16 + next_rand() % 112;      // Pequenas
+    }
+    if (r < 92) {
+        return 1025;                        // Buffer do display
+    }
+    return 900 + next_rand() % 200;         // Estado de conexão
+}
+
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+static void lat_add(lat_t *l, uint64_t cycles) {
+    l->hist[cycles < BENCH_HIST_CYCLES ? cycles : BENCH_HIST_CYCLES]++;
+    l->n++;
+}
+
+static void steps_add(lat_t *l, uint32_t steps) {
+    if (steps > l->max_steps) {
+        l->max_steps = steps;
+    }
+}
+
+static uint32_t lat_percentile(const lat_t *l, double p) {
+    uint64_t want = (uint64_t)(l->n * p / 100);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i <= BENCH_HIST_CYCLES; i++) {
+        seen += l->hist[i];
+        if (seen > want) {
+            return i;
+        }
+    }
+    return BENCH_HIST_CYCLES;
+}
+
+// bound 0: sem contagem de passos (libc)
+static void lat_report(const char *name, const lat_t *l, uint32_t bound) {
+    printf("  %-7s p50 %5u cyc  p99 %5u cyc  p99.99 %6u cyc", name, lat_percentile(l, 50),
+           lat_percentile(l, 99), lat_percentile(l, 99.99));
+    if (bound) {
+        printf("  worst %u steps (bound %u)\n", (unsigned)l->max_steps, (unsigned)bound);
+    } else {
+        printf("  worst n/a\n");
+    }
+}
+
+static int run(const allocator_t *a) {
+    static void *slots[BENCH_MAX_LIVE];
+    static lat_t lat_alloc, lat_free;
+    memset(slots, 0, sizeof(slots));
+    memset(&lat_alloc, 0, sizeof(lat_alloc));
+    memset(&lat_free, 0, sizeof(lat_free));
+    bool is_tlsf = a->alloc == tlsf_alloc;
+    if (is_tlsf && !tlsf_init(&tlsf, pool, cfg.pool)) {
+        fprintf(stderr, "pool too small\n");
+        return 1;
+    }
+    rng = cfg.seed;
+    uint32_t failures = 0, samples = 0, worst_frag = 0;
+    uint64_t frag_sum = 0;
+    for (uint32_t i = 0; i < cfg.ops; i++) {
+        void **slot = &slots[next_rand() % cfg.live];
+        if (*slot) {
+            uint64_t t0 = now_cycles();
+            a->release(*slot);
+            lat_add(&lat_free, now_cycles() - t0);
+            if (is_tlsf) {
+                steps_add(&lat_free, tlsf.steps);
+            }
+            *slot = NULL;
+        } else {
+            size_t size = draw_size();
+            uint64_t t0 = now_cycles();
+            void *p = a->alloc(size);
+            lat_add(&lat_alloc, now_cycles() - t0);
+            if (is_tlsf) {
+                steps_add(&lat_alloc, tlsf.steps);
+            }
+            if (!p) {
+                failures++;
+                continue;
+            }
+            // Escreve no bloco, como o firmware, para o custo de cache contar
+            // igual nos dois
+            memset(p, (int)i, size < 64 ? size : 64);
+            *slot = p;
+        }
+        if (is_tlsf && (i & 0xFFF) == 0) {
+            tlsf_stats_t s;
+            tlsf_get_stats(&tlsf, &s);
+            uint32_t frag = s.free_bytes ? (uint32_t)(1000 - (uint64_t)s.largest_free * 1000 / s.free_bytes) : 0;
+            frag_sum += frag;
+            samples++;
+            if (frag > worst_frag) {
+                worst_frag = frag;
+            }
+        }
+        if (is_tlsf && cfg.check && i % cfg.check == 0 && !tlsf_check(&tlsf)) {
+            fprintf(stderr, "tlsf_check failed at op %u\n", (unsigned)i);
+            return 1;
+        }
+    }
+    printf("%s: %llu mallocs (%u failed), %llu frees\n", a->name, (unsigned long long)lat_alloc.n,
+           (unsigned)failures, (unsigned long long)lat_free.n);
+    lat_report("malloc", &lat_alloc, is_tlsf ? TLSF_MALLOC_STEPS : 0);
+    lat_report("free", &lat_free, is_tlsf ? TLSF_FREE_STEPS : 0);
+    if (is_tlsf) {
+        if (lat_alloc.max_steps > TLSF_MALLOC_STEPS || lat_free.max_steps > TLSF_FREE_STEPS) {
+            fprintf(stderr, "tlsf steps above the bound\n");
+            return 1;
+        }
+        tlsf_stats_t s;
+        tlsf_get_stats(&tlsf, &s);
+        printf("  pool %zu bytes, peak %zu used, fragmentation mean %.1f%% worst %.1f%%\n", s.size, s.peak,
+               samples ? frag_sum / 10.0 / samples : 0.0, worst_frag / 10.0);
+        if (!tlsf_check(&tlsf)) {
+            fprintf(stderr, "tlsf_check failed\n");
+            return 1;
+        }
+    }
+    for (uint32_t i = 0; i < cfg.live; i++) {
+        a->release(slots[i]);
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --ops N            malloc/free operations per allocator (default 5000000)\n"
+        "  --live N           allocation slots, about half live at a time (default 64)\n"
+        "  --pool N           TLSF pool size in bytes (default 65536)\n"
+        "  --seed N           workload seed (default 1)\n"
+        "  --check N          run tlsf_check every N operations (default 0, end only)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "ops", required_argument, NULL, 'o' },
+        { "live", required_argument, NULL, 'l' },
+        { "pool", required_argument, NULL, 'p' },
+        { "seed", required_argument, NULL, 's' },
+        { "check", required_argument, NULL, 'c' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'o': cfg.ops = (uint32_t)atoi(optarg); break;
+            case 'l': cfg.live = (uint32_t)atoi(optarg); break;
+            case 'p': cfg.pool = (uint32_t)atoi(optarg); break;
+            case 's': cfg.seed = (uint32_t)atoi(optarg); break;
+            case 'c': cfg.check = (uint32_t)atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (cfg.ops == 0 || cfg.live == 0 || cfg.live > BENCH_MAX_LIVE || cfg.seed == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    pool = malloc(cfg.pool);
+    if (!pool) {
+        return 1;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(allocators) / sizeof(allocators[0]); i++) {
+        failed |= run(&allocators[i]);
+    }
+    free(pool);
+    return failed;
+}
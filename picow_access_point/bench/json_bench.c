@@ -0,0 +1,283 @@
+/**
+ * json_bench: taxa de serialização e de parsing do JSON da API (http/json.h)
+ * no host.
+ *
+ * Serialização: o documento de /api/state (e uma lista de --items eventos,
+ * para um documento maior) escrito num sink de memória, comparado com o
+ * mesmo texto montado por snprintf. Com --window W o sink aceita só W bytes
+ * por passada, como um buffer de envio do TCP que enche: o gerador roda de
+ * novo pulando o que já saiu, e o relatório mostra quantas passadas e quanto
+ * isso custa a mais.
+ *
+ * Parsing: o corpo de POST /api/alarm e os documentos acima passados pelo
+ * tokenizador, mais uma entrada patológica (colchetes aninhados) que precisa
+ * ser recusada sem recursão e sem passar do limite de profundidade; para ela
+ * o relatório traz o tempo por recusa, não MB/s, já que o parser para no
+ * primeiro nível além do limite.
+ *
+ * Exemplo:
+ *   json_bench --items 32 --window 536
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "json.h"
+
+#define BENCH_DOC_MAX 16384
+#define BENCH_MAX_TOKENS 1024
+
+static struct {
+    uint32_t iterations;
+    uint32_t items;
+    uint32_t window;
+} cfg = {
+    .iterations = 200000,
+    .items = 16,
+    .window = 0,
+};
+
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t room;            // Bytes aceitos nesta passada (--window)
+} mem_sink_t;
+
+static size_t mem_sink(void *arg, const char *data, size_t len) {
+    mem_sink_t *m = arg;
+    if (len > m->room) {
+        len = m->room;
+    }
+    if (len > BENCH_DOC_MAX - m->len) {
+        len = BENCH_DOC_MAX - m->len;
+    }
+    memcpy(m->buf + m->len, data, len);
+    m->len += len;
+    m->room -= len;
+    return len;
+}
+
+// Mesmos campos de api_state_json em picow_access_point.c
+static void state_json(json_writer_t *w, uint32_t i) {
+    json_object_begin(w);
+    JSON_KEY(w, "active");
+    json_bool(w, i & 1);
+    JSON_KEY(w, "testing");
+    json_bool(w, false);
+    JSON_KEY(w, "led_on");
+    json_bool(w, i & 1);
+    JSON_KEY(w, "beep_active");
+    json_bool(w, false);
+    JSON_KEY(w, "commands");
+    json_uint(w, i);
+    JSON_KEY(w, "dropped");
+    json_uint(w, 0);
+    JSON_KEY(w, "uptime_ms");
+    json_uint(w, 123456789 + i);
+    json_object_end(w);
+}
+
+static const char *const event_types[] = { "arm", "disarm", "test" };
+
+static void events_json(json_writer_t *w, uint32_t i) {
+    json_object_begin(w);
+    JSON_KEY(w, "events");
+    json_array_begin(w);
+    for (uint32_t k = 0; k < cfg.items; k++) {
+        json_object_begin(w);
+        JSON_KEY(w, "t_ms");
+        json_uint(w, 1000 * k + i);
+        JSON_KEY(w, "type");
+        json_string(w, event_types[k % 3]);
+        JSON_KEY(w, "source");
+        json_string(w, k & 1 ? "http" : "console");
+        json_object_end(w);
+    }
+    json_array_end(w);
+    json_object_end(w);
+}
+
+static int state_snprintf(char *buf, size_t size, uint32_t i) {
+    return snprintf(buf, size,
+                    "{\"active\":%s,\"testing\":false,\"led_on\":%s,\"beep_active\":false,"
+                    "\"commands\":%lu,\"dropped\":0,\"uptime_ms\":%lu}",
+                    i & 1 ? "true" : "false", i & 1 ? "true" : "false",
+                    (unsigned long)i, (unsigned long)(123456789 + i));
+}
+
+static int events_snprintf(char *buf, size_t size, uint32_t i) {
+    int len = snprintf(buf, size, "{\"events\":[");
+    for (uint32_t k = 0; k < cfg.items && len < (int)size; k++) {
+        len += snprintf(buf + len, size - len, "%s{\"t_ms\":%lu,\"type\":\"%s\",\"source\":\"%s\"}",
+                        k ? "," : "", (unsigned long)(1000 * k + i), event_types[k % 3],
+                        k & 1 ? "http" : "console");
+    }
+    if (len < (int)size) {
+        len += snprintf(buf + len, size - len, "]}");
+    }
+    return len;
+}
+
+typedef void (*doc_fn)(json_writer_t *w, uint32_t i);
+
+// Gera o documento inteiro com o sink limitado a cfg.window bytes por
+// passada; retorna o número de passadas
+static uint32_t write_doc(doc_fn fn, uint32_t i, char *buf, size_t *len) {
+    mem_sink_t m = { .buf = buf };
+    uint32_t skip = 0, passes = 0;
+    for (;;) {
+        json_writer_t w;
+        m.room = cfg.window ? cfg.window : SIZE_MAX;
+        json_writer_init(&w, mem_sink, &m, skip);
+        fn(&w, i);
+        json_writer_flush(&w);
+        passes++;
+        if (json_writer_done(&w) || w.sent == skip) {
+            break;
+        }
+        skip = w.sent;
+    }
+    *len = m.len;
+    return passes;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void report(const char *name, uint32_t docs, uint64_t bytes, uint64_t ns, const char *extra) {
+    double s = ns / 1e9;
+    printf("  %-22s %9.0f docs/s %8.1f MB/s %7.0f ns/doc%s\n", name, docs / s, bytes / s / 1e6,
+           (double)ns / docs, extra);
+}
+
+static int bench_serialize(const char *name, doc_fn fn, int (*baseline)(char *, size_t, uint32_t),
+                           uint32_t iterations) {
+    static char json[BENCH_DOC_MAX], text[BENCH_DOC_MAX];
+    // Os dois caminhos precisam produzir o mesmo texto
+    size_t len;
+    write_doc(fn, 7, json, &len);
+    int text_len = baseline(text, sizeof(text), 7);
+    if ((size_t)text_len != len || memcmp(json, text, len) != 0) {
+        fprintf(stderr, "%s: writer and snprintf disagree\n%.*s\n%.*s\n", name, (int)len, json, text_len, text);
+        return 1;
+    }
+    printf("%s (%zu bytes):\n", name, len);
+
+    uint64_t bytes = 0, passes = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        passes += write_doc(fn, i, json, &len);
+        bytes += len;
+    }
+    char extra[64] = "";
+    if (cfg.window) {
+        snprintf(extra, sizeof(extra), "  %.1f passes/doc (window %u)", (double)passes / iterations,
+                 (unsigned)cfg.window);
+    }
+    report("json writer", iterations, bytes, now_ns() - t0, extra);
+
+    bytes = 0;
+    t0 = now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        bytes += baseline(text, sizeof(text), i);
+    }
+    report("snprintf", iterations, bytes, now_ns() - t0, "");
+
+    // Só a medição do tamanho (o Content-Length)
+    t0 = now_ns();
+    bytes = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        json_writer_t w;
+        json_writer_init(&w, NULL, NULL, 0);
+        fn(&w, i);
+        bytes += w.pos;
+    }
+    report("length only", iterations, bytes, now_ns() - t0, "");
+    return 0;
+}
+
+static int bench_parse(const char *name, const char *doc, size_t len, int expect) {
+    static json_token_t tokens[BENCH_MAX_TOKENS];
+    int n = json_parse(doc, len, tokens, BENCH_MAX_TOKENS);
+    if (expect >= 0 ? n < 0 : n != expect) {
+        fprintf(stderr, "%s: unexpected result %d (%s)\n", name, n, json_error_name(n));
+        return 1;
+    }
+    // Uma recusa para no primeiro erro, sem ler o resto: vale o tempo por
+    // recusa, não os bytes da entrada
+    uint32_t iterations = expect < 0 ? cfg.iterations : (uint32_t)(cfg.iterations * 64 / (len + 64)) + 1;
+    uint64_t t0 = now_ns();
+    int64_t total = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        total += json_parse(doc, len, tokens, BENCH_MAX_TOKENS);
+    }
+    uint64_t ns = now_ns() - t0;
+    if (n < 0) {
+        printf("  %-22s %9.0f rejects/s %7.0f ns/reject  %s (%zu-byte input)\n", name,
+               iterations / (ns / 1e9), (double)ns / iterations, json_error_name(n), len);
+    } else {
+        char extra[64];
+        snprintf(extra, sizeof(extra), "  %d tokens", n);
+        report(name, iterations, (uint64_t)len * iterations, ns, extra);
+    }
+    return total == (int64_t)n * iterations ? 0 : 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --iterations N     documents per measurement (default 200000)\n"
+        "  --items N          events in the larger document (default 16)\n"
+        "  --window W         bytes the sink takes per pass, 0 = all (default 0)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "iterations", required_argument, NULL, 'i' },
+        { "items", required_argument, NULL, 'n' },
+        { "window", required_argument, NULL, 'w' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'i': cfg.iterations = (uint32_t)atoi(optarg); break;
+            case 'n': cfg.items = (uint32_t)atoi(optarg); break;
+            case 'w': cfg.window = (uint32_t)atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (cfg.iterations == 0 || cfg.items > 256) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("serialize:\n");
+    int failed = bench_serialize("state", state_json, state_snprintf, cfg.iterations);
+    // O documento maior com o mesmo número de eventos escritos no total
+    failed |= bench_serialize("events", events_json, events_snprintf, cfg.iterations / (cfg.items + 1) + 1);
+
+    static char state[BENCH_DOC_MAX], events[BENCH_DOC_MAX], deep[BENCH_DOC_MAX];
+    int state_len = state_snprintf(state, sizeof(state), 7);
+    int events_len = events_snprintf(events, sizeof(events), 7);
+    memset(deep, '[', sizeof(deep));
+
+    printf("parse:\n");
+    static const char command[] = "{\"alarm\":\"on\"}";
+    failed |= bench_parse("alarm command", command, sizeof(command) - 1, 0);
+    failed |= bench_parse("state", state, state_len, 0);
+    failed |= bench_parse("events", events, events_len, 0);
+    failed |= bench_parse("nested brackets", deep, sizeof(deep), JSON_ERR_DEPTH);
+    return failed;
+}
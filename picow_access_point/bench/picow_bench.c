@@ -0,0 +1,615 @@
+/**
+ * picow_bench: gerador de carga HTTP para o servidor do alarme.
+ *
+ * Mantém N clientes concorrentes, cada um em laço de conectar, enviar uma
+ * requisição sorteada do mix (GET /alarm, GET /alarm?alarm=1, sondas de
+ * portal cativo), ler a resposta e registrar a latência. Como um navegador,
+ * o cliente fecha assim que recebe Content-Length bytes de corpo (o TIME_WAIT
+ * fica do lado dele); sem Content-Length, ou com --wait-close, lê até o
+ * servidor fechar. O relatório conta quem fechou primeiro. Ao final, imprime vazão, p50/p99/p99.9, recusas e, se o servidor
+ * foi iniciado pelo próprio bench (--spawn), o pico de heap e de pbufs
+ * relatado por ele ao encerrar. Com --json o resultado sai em JSON, para
+ * comparar execuções entre commits.
+ *
+ * Exemplo, com a interface tap configurada (ver README):
+ *   picow_bench --spawn ./host/picow_access_point_host --clients 4 --duration 30 --json out.json
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <getopt.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define BENCH_MAX_CLIENTS 256
+#define BENCH_RX_MAX 4096
+#define BENCH_HEAD_MAX 256
+#define BENCH_SERVER_OUT_MAX 4096
+
+typedef enum {
+    REQ_ALARM,
+    REQ_ARM,
+    REQ_PROBE,
+    REQ_KINDS,
+} req_kind_t;
+
+static const char *const req_names[REQ_KINDS] = { "alarm", "arm", "probe" };
+
+static const char *const probe_requests[] = {
+    "GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\n\r\n",
+    "GET /hotspot-detect.html HTTP/1.1\r\nHost: captive.apple.com\r\n\r\n",
+    "GET /connecttest.txt HTTP/1.1\r\nHost: www.msftconnecttest.com\r\n\r\n",
+};
+
+typedef struct {
+    uint32_t *v;
+    size_t n;
+    size_t cap;
+} series_t;
+
+typedef enum {
+    CLIENT_IDLE,
+    CLIENT_CONNECTING,
+    CLIENT_SENDING,
+    CLIENT_READING,
+} client_state_t;
+
+typedef struct {
+    int fd;
+    client_state_t state;
+    req_kind_t kind;
+    const char *request;
+    size_t sent;
+    size_t received;
+    size_t expected;        // Headers + Content-Length, 0 enquanto desconhecido
+    uint64_t start_us;
+} client_t;
+
+static struct {
+    // Configuração
+    struct sockaddr_in server;
+    int clients;
+    double duration_s;
+    uint64_t max_requests;
+    uint32_t timeout_ms;
+    unsigned weight[REQ_KINDS];
+    const char *spawn;
+    const char *json_path;
+    uint32_t seed;
+    bool wait_close;
+
+    // Resultados
+    series_t latency_us;
+    series_t latency_kind_us[REQ_KINDS];
+    uint64_t started;
+    uint64_t completed;
+    uint64_t refused;
+    uint64_t timeouts;
+    uint64_t errors;
+    uint64_t bytes_rx;
+    uint64_t client_closes; // Resposta completa pelo Content-Length
+    uint64_t server_closes; // Fim da resposta pelo fechamento do servidor
+    uint64_t status[6]; // 1xx..5xx, 0 = sem linha de status
+
+    // Servidor iniciado com --spawn
+    pid_t server_pid;
+    int server_in;
+    int server_out;
+    char server_stats[BENCH_SERVER_OUT_MAX];
+    char line[BENCH_SERVER_OUT_MAX];
+    size_t line_len;
+} bench = {
+    .clients = 4,
+    .duration_s = 10,
+    .timeout_ms = 5000,
+    .weight = { 70, 10, 20 },
+    .seed = 1,
+    .server_pid = -1,
+    .server_in = -1,
+    .server_out = -1,
+};
+
+static uint64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint32_t bench_rand(void) {
+    uint32_t x = bench.seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return bench.seed = x;
+}
+
+static void series_add(series_t *s, uint32_t v) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 4096;
+        s->v = realloc(s->v, s->cap * sizeof(s->v[0]));
+    }
+    s->v[s->n++] = v;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Requer a série ordenada
+static uint32_t series_percentile(const series_t *s, double p) {
+    if (s->n == 0) {
+        return 0;
+    }
+    return s->v[(size_t)(p / 100.0 * (s->n - 1) + 0.5)];
+}
+
+// =============================================
+// Servidor iniciado pelo bench
+// =============================================
+
+// Lê a saída do servidor sem bloquear, guardando a linha HOST_STATS
+static void server_drain(void) {
+    char buf[1024];
+    ssize_t n = -1;
+    while (bench.server_out >= 0 && (n = read(bench.server_out, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != '\n') {
+                if (bench.line_len < sizeof(bench.line) - 1) {
+                    bench.line[bench.line_len++] = buf[i];
+                }
+                continue;
+            }
+            bench.line[bench.line_len] = 0;
+            if (strncmp(bench.line, "HOST_STATS ", 11) == 0) {
+                memcpy(bench.server_stats, bench.line + 11, bench.line_len - 11 + 1);
+            }
+            bench.line_len = 0;
+        }
+    }
+    if (n == 0) {
+        close(bench.server_out);
+        bench.server_out = -1;
+    }
+}
+
+static bool server_spawn(const char *path) {
+    int in[2], out[2];
+    if (pipe(in) || pipe(out)) {
+        perror("pipe");
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return false;
+    }
+    if (pid == 0) {
+        dup2(in[0], STDIN_FILENO);
+        dup2(out[1], STDOUT_FILENO);
+        close(in[1]);
+        close(out[0]);
+        execl(path, path, (char *)NULL);
+        perror("exec");
+        _exit(127);
+    }
+    close(in[0]);
+    close(out[1]);
+    bench.server_pid = pid;
+    bench.server_in = in[1];
+    bench.server_out = out[0];
+    fcntl(bench.server_out, F_SETFL, O_NONBLOCK);
+
+    // Espera o servidor abrir a porta (mensagem "Access Point criado")
+    uint64_t deadline = now_us() + 5 * 1000000;
+    while (now_us() < deadline) {
+        struct pollfd pfd = { .fd = bench.server_out, .events = POLLIN };
+        poll(&pfd, 1, 100);
+        char buf[1024];
+        ssize_t n = read(bench.server_out, buf, sizeof(buf) - 1);
+        if (n == 0) {
+            fprintf(stderr, "server exited during startup\n");
+            return false;
+        }
+        if (n > 0) {
+            buf[n] = 0;
+            if (strstr(buf, "Access Point criado")) {
+                return true;
+            }
+        }
+    }
+    fprintf(stderr, "server did not start\n");
+    return false;
+}
+
+static void server_stop(void) {
+    if (bench.server_pid < 0) {
+        return;
+    }
+    // Mesma tecla que encerra o firmware pelo console
+    if (write(bench.server_in, "d", 1) != 1) {
+        kill(bench.server_pid, SIGTERM);
+    }
+    uint64_t deadline = now_us() + 5 * 1000000;
+    while (bench.server_out >= 0 && now_us() < deadline) {
+        struct pollfd pfd = { .fd = bench.server_out, .events = POLLIN };
+        poll(&pfd, 1, 100);
+        server_drain();
+    }
+    if (bench.server_out >= 0) {
+        kill(bench.server_pid, SIGKILL);
+    }
+    waitpid(bench.server_pid, NULL, 0);
+    close(bench.server_in);
+}
+
+// =============================================
+// Clientes
+// =============================================
+
+static req_kind_t pick_kind(void) {
+    unsigned total = 0;
+    for (int k = 0; k < REQ_KINDS; k++) {
+        total += bench.weight[k];
+    }
+    unsigned r = bench_rand() % total;
+    for (int k = 0; k < REQ_KINDS; k++) {
+        if (r < bench.weight[k]) {
+            return (req_kind_t)k;
+        }
+        r -= bench.weight[k];
+    }
+    return REQ_ALARM;
+}
+
+static void client_close(client_t *c) {
+    if (c->fd >= 0) {
+        close(c->fd);
+        c->fd = -1;
+    }
+    c->state = CLIENT_IDLE;
+}
+
+static void client_start(client_t *c) {
+    c->kind = pick_kind();
+    switch (c->kind) {
+        case REQ_ARM:
+            c->request = "GET /alarm?alarm=1 HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n";
+            break;
+        case REQ_PROBE:
+            c->request = probe_requests[bench_rand() % (sizeof(probe_requests) / sizeof(probe_requests[0]))];
+            break;
+        default:
+            c->request = "GET /alarm HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n";
+            break;
+    }
+    c->sent = 0;
+    c->received = 0;
+    c->expected = 0;
+    c->start_us = now_us();
+    bench.started++;
+
+    c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (c->fd < 0) {
+        bench.errors++;
+        return;
+    }
+    int one = 1;
+    setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(c->fd, (struct sockaddr *)&bench.server, sizeof(bench.server)) < 0 && errno != EINPROGRESS) {
+        bench.refused++;
+        client_close(c);
+        return;
+    }
+    c->state = CLIENT_CONNECTING;
+}
+
+// Tamanho da resposta (headers + Content-Length) pelo seu início, ou 0 se os
+// headers ainda não acabaram ou não há Content-Length
+static size_t response_length(const char *head) {
+    static const char header[] = "content-length:";
+    const char *end = NULL;
+    for (const char *p = strchr(head, '\n'); p; p = strchr(p + 1, '\n')) {
+        if (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n')) {
+            end = p + (p[1] == '\n' ? 2 : 3);
+            break;
+        }
+    }
+    if (!end) {
+        return 0;
+    }
+    for (const char *line = head; line < end; line = strchr(line, '\n') + 1) {
+        if (strncasecmp(line, header, sizeof(header) - 1) == 0) {
+            return (size_t)(end - head) + strtoul(line + sizeof(header) - 1, NULL, 10);
+        }
+    }
+    return 0;
+}
+
+static void client_done(client_t *c, const char *first_bytes) {
+    uint32_t lat = (uint32_t)(now_us() - c->start_us);
+    bench.completed++;
+    series_add(&bench.latency_us, lat);
+    series_add(&bench.latency_kind_us[c->kind], lat);
+    int code = 0;
+    if (first_bytes && sscanf(first_bytes, "HTTP/1.%*d %d", &code) == 1 && code >= 100 && code < 600) {
+        bench.status[code / 100]++;
+    } else {
+        bench.status[0]++;
+    }
+    client_close(c);
+}
+
+static void client_event(client_t *c, short revents, char *rx_first, size_t rx_first_len) {
+    if (c->state == CLIENT_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err) {
+            if (err == ECONNREFUSED || err == ECONNRESET) {
+                bench.refused++;
+            } else {
+                bench.errors++;
+            }
+            client_close(c);
+            return;
+        }
+        c->state = CLIENT_SENDING;
+    }
+    if (c->state == CLIENT_SENDING && (revents & POLLOUT)) {
+        size_t total = strlen(c->request);
+        ssize_t n = send(c->fd, c->request + c->sent, total - c->sent, MSG_NOSIGNAL);
+        if (n < 0 && errno != EAGAIN) {
+            bench.errors++;
+            client_close(c);
+            return;
+        }
+        if (n > 0 && (c->sent += n) == total) {
+            c->state = CLIENT_READING;
+        }
+    }
+    if (c->state == CLIENT_READING && (revents & (POLLIN | POLLHUP))) {
+        char buf[BENCH_RX_MAX];
+        ssize_t n;
+        while ((n = recv(c->fd, buf, sizeof(buf), 0)) > 0) {
+            if (c->received < rx_first_len - 1) {
+                size_t k = (size_t)n < rx_first_len - 1 - c->received ? (size_t)n : rx_first_len - 1 - c->received;
+                memcpy(rx_first + c->received, buf, k);
+                rx_first[c->received + k] = 0;
+            }
+            c->received += n;
+            bench.bytes_rx += n;
+        }
+        if (!bench.wait_close && !c->expected) {
+            c->expected = response_length(rx_first);
+        }
+        if (n == 0) {
+            // O servidor fechou: resposta sem tamanho ou cliente lento
+            bench.server_closes++;
+            client_done(c, c->received ? rx_first : NULL);
+        } else if (errno == EAGAIN) {
+            if (c->expected && c->received >= c->expected) {
+                // Resposta completa: o cliente fecha primeiro
+                bench.client_closes++;
+                client_done(c, rx_first);
+            }
+        } else {
+            if (errno == ECONNRESET && c->received == 0) {
+                bench.refused++;
+            } else {
+                bench.errors++;
+            }
+            client_close(c);
+        }
+    }
+}
+
+static void run(void) {
+    static client_t clients[BENCH_MAX_CLIENTS];
+    static char rx_first[BENCH_MAX_CLIENTS][BENCH_HEAD_MAX];
+    struct pollfd pfd[BENCH_MAX_CLIENTS];
+    for (int i = 0; i < bench.clients; i++) {
+        clients[i].fd = -1;
+        clients[i].state = CLIENT_IDLE;
+    }
+
+    uint64_t t0 = now_us();
+    uint64_t end = t0 + (uint64_t)(bench.duration_s * 1e6);
+    bool stopping = false;
+    for (;;) {
+        uint64_t t = now_us();
+        if (t >= end || (bench.max_requests && bench.started >= bench.max_requests)) {
+            stopping = true;
+        }
+        int active = 0;
+        for (int i = 0; i < bench.clients; i++) {
+            client_t *c = &clients[i];
+            if (c->state != CLIENT_IDLE && t - c->start_us > bench.timeout_ms * 1000ull) {
+                bench.timeouts++;
+                client_close(c);
+            }
+            if (c->state == CLIENT_IDLE && !stopping) {
+                client_start(c);
+            }
+            pfd[i].fd = c->state == CLIENT_IDLE ? -1 : c->fd;
+            pfd[i].events = c->state == CLIENT_READING ? POLLIN : POLLOUT;
+            pfd[i].revents = 0;
+            active += c->state != CLIENT_IDLE;
+        }
+        if (stopping && active == 0) {
+            break;
+        }
+        poll(pfd, bench.clients, 10);
+        for (int i = 0; i < bench.clients; i++) {
+            if (pfd[i].revents) {
+                client_event(&clients[i], pfd[i].revents, rx_first[i], sizeof(rx_first[i]));
+            }
+        }
+        server_drain();
+    }
+    bench.duration_s = (now_us() - t0) / 1e6;
+}
+
+// =============================================
+// Relatório
+// =============================================
+
+static void report_json(FILE *f) {
+    fprintf(f, "{\n  \"config\": {\"server\": \"%s:%u\", \"clients\": %d, \"timeout_ms\": %u, \"mix\": {",
+        inet_ntoa(bench.server.sin_addr), ntohs(bench.server.sin_port), bench.clients, bench.timeout_ms);
+    for (int k = 0; k < REQ_KINDS; k++) {
+        fprintf(f, "%s\"%s\": %u", k ? ", " : "", req_names[k], bench.weight[k]);
+    }
+    fprintf(f, "}},\n");
+    fprintf(f, "  \"duration_s\": %.3f,\n  \"throughput_rps\": %.2f,\n", bench.duration_s,
+        bench.completed / bench.duration_s);
+    fprintf(f, "  \"requests\": {\"started\": %llu, \"completed\": %llu, \"refused\": %llu, \"timeouts\": %llu, \"errors\": %llu},\n",
+        (unsigned long long)bench.started, (unsigned long long)bench.completed, (unsigned long long)bench.refused,
+        (unsigned long long)bench.timeouts, (unsigned long long)bench.errors);
+    fprintf(f, "  \"status\": {\"none\": %llu, \"2xx\": %llu, \"3xx\": %llu, \"4xx\": %llu, \"5xx\": %llu},\n",
+        (unsigned long long)bench.status[0], (unsigned long long)bench.status[2], (unsigned long long)bench.status[3],
+        (unsigned long long)bench.status[4], (unsigned long long)bench.status[5]);
+    fprintf(f, "  \"closes\": {\"client_first\": %llu, \"server_first\": %llu},\n",
+        (unsigned long long)bench.client_closes, (unsigned long long)bench.server_closes);
+    fprintf(f, "  \"bytes_rx\": %llu,\n", (unsigned long long)bench.bytes_rx);
+    fprintf(f, "  \"latency_us\": {\"p50\": %u, \"p99\": %u, \"p999\": %u, \"max\": %u},\n",
+        series_percentile(&bench.latency_us, 50), series_percentile(&bench.latency_us, 99),
+        series_percentile(&bench.latency_us, 99.9), series_percentile(&bench.latency_us, 100));
+    fprintf(f, "  \"latency_by_kind_us\": {");
+    for (int k = 0; k < REQ_KINDS; k++) {
+        series_t *s = &bench.latency_kind_us[k];
+        fprintf(f, "%s\"%s\": {\"n\": %zu, \"p50\": %u, \"p99\": %u}", k ? ", " : "", req_names[k], s->n,
+            series_percentile(s, 50), series_percentile(s, 99));
+    }
+    fprintf(f, "},\n  \"server\": %s\n}\n", bench.server_stats[0] ? bench.server_stats : "null");
+}
+
+static void report_text(void) {
+    printf("%.1f s, %d clients: %llu requests, %.1f req/s\n", bench.duration_s, bench.clients,
+        (unsigned long long)bench.completed, bench.completed / bench.duration_s);
+    printf("latency p50=%.2fms p99=%.2fms p99.9=%.2fms max=%.2fms\n",
+        series_percentile(&bench.latency_us, 50) / 1000.0, series_percentile(&bench.latency_us, 99) / 1000.0,
+        series_percentile(&bench.latency_us, 99.9) / 1000.0, series_percentile(&bench.latency_us, 100) / 1000.0);
+    printf("refused=%llu timeouts=%llu errors=%llu\n", (unsigned long long)bench.refused,
+        (unsigned long long)bench.timeouts, (unsigned long long)bench.errors);
+    printf("closed first by client=%llu server=%llu\n", (unsigned long long)bench.client_closes,
+        (unsigned long long)bench.server_closes);
+    if (bench.server_stats[0]) {
+        printf("server %s\n", bench.server_stats);
+    }
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --server IP        server address (default 192.168.4.1)\n"
+        "  --port N           server port (default 80)\n"
+        "  --clients N        concurrent clients (default 4, max %d)\n"
+        "  --duration S       run time in seconds (default 10)\n"
+        "  --requests N       stop after N requests\n"
+        "  --timeout MS       per-request timeout (default 5000)\n"
+        "  --mix A,B,P        weights of GET /alarm, /alarm?alarm=1, captive probes (default 70,10,20)\n"
+        "  --spawn PATH       start the host server, stop it at the end and collect its stats\n"
+        "  --json FILE        write results as JSON (- for stdout)\n"
+        "  --seed N           request mix seed (default 1)\n"
+        "  --wait-close       read until the server closes, even with Content-Length\n",
+        prog, BENCH_MAX_CLIENTS);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "server", required_argument, NULL, 's' },
+        { "port", required_argument, NULL, 'p' },
+        { "clients", required_argument, NULL, 'c' },
+        { "duration", required_argument, NULL, 'd' },
+        { "requests", required_argument, NULL, 'n' },
+        { "timeout", required_argument, NULL, 't' },
+        { "mix", required_argument, NULL, 'm' },
+        { "spawn", required_argument, NULL, 'x' },
+        { "json", required_argument, NULL, 'j' },
+        { "seed", required_argument, NULL, 'r' },
+        { "wait-close", no_argument, NULL, 'w' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    const char *server = "192.168.4.1";
+    int port = 80;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 's': server = optarg; break;
+            case 'p': port = atoi(optarg); break;
+            case 'c': bench.clients = atoi(optarg); break;
+            case 'd': bench.duration_s = atof(optarg); break;
+            case 'n': bench.max_requests = strtoull(optarg, NULL, 0); break;
+            case 't': bench.timeout_ms = (uint32_t)atoi(optarg); break;
+            case 'm':
+                if (sscanf(optarg, "%u,%u,%u", &bench.weight[0], &bench.weight[1], &bench.weight[2]) != 3 ||
+                    bench.weight[0] + bench.weight[1] + bench.weight[2] == 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                break;
+            case 'x': bench.spawn = optarg; break;
+            case 'j': bench.json_path = optarg; break;
+            case 'r': bench.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'w': bench.wait_close = true; break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (bench.clients < 1 || bench.clients > BENCH_MAX_CLIENTS) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (bench.seed == 0) {
+        bench.seed = 1;
+    }
+    bench.server.sin_family = AF_INET;
+    bench.server.sin_port = htons(port);
+    if (inet_pton(AF_INET, server, &bench.server.sin_addr) != 1) {
+        fprintf(stderr, "bad server address %s\n", server);
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    if (bench.spawn && !server_spawn(bench.spawn)) {
+        server_stop();
+        return 1;
+    }
+
+    run();
+    server_stop();
+
+    qsort(bench.latency_us.v, bench.latency_us.n, sizeof(uint32_t), cmp_u32);
+    for (int k = 0; k < REQ_KINDS; k++) {
+        qsort(bench.latency_kind_us[k].v, bench.latency_kind_us[k].n, sizeof(uint32_t), cmp_u32);
+    }
+
+    report_text();
+    if (bench.json_path) {
+        FILE *f = strcmp(bench.json_path, "-") == 0 ? stdout : fopen(bench.json_path, "w");
+        if (!f) {
+            perror(bench.json_path);
+            return 1;
+        }
+        report_json(f);
+        if (f != stdout) {
+            fclose(f);
+        }
+    }
+    return 0;
+}
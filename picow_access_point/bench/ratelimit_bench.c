@@ -0,0 +1,357 @@
+/**
+ * ratelimit_bench: justiça entre clientes sob inundação (ratelimit.h) no host.
+ *
+ * Modelo em tempo virtual, passo de 1 ms: N clientes legítimos e F
+ * inundadores mandam pacotes de um serviço (chegadas exponenciais), e o
+ * servidor, de uma thread só, atende até --capacity pacotes por segundo com
+ * uma fila de --queue pacotes (o que não cabe é perdido, como pbufs
+ * esgotados). A mesma carga roda duas vezes, sem e com o limite por cliente
+ * de ratelimit.c, e o relatório mostra, por classe de cliente, quanto foi
+ * atendido, descartado pelo limite e perdido na fila, mais o índice de Jain
+ * da fração atendida entre os clientes legítimos (1 = todos iguais).
+ * No fim mede o custo de uma consulta à tabela. Com --min-served P o
+ * programa falha se, com o limite, algum cliente legítimo tiver menos de P%
+ * dos pacotes atendidos; é assim que ele roda no ctest. Com --flood-keys K
+ * cada inundador sorteia a origem de cada pacote entre K (IPs forjados, um
+ * cliente DHCP trocando de chaddr), mais origens que RATE_LIMIT_ENTRIES, e
+ * com --max-flood R o programa falha se os inundadores, juntos, passarem de
+ * R pacotes por segundo pelo limite.
+ *
+ * Exemplo:
+ *   ratelimit_bench --service dns --clients 8 --flooders 1 --flood-rate 2000
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "ratelimit.h"
+
+#define BENCH_MAX_CLIENTS 64
+#define BENCH_MAX_QUEUE 256
+
+typedef struct {
+    bool flooder;
+    double rate;            // Pacotes por segundo
+    double next_ms;         // Próxima chegada
+    uint8_t key[RATE_LIMIT_KEY_MAX];
+    uint32_t offered;
+    uint32_t limited;       // Descartados pelo limite
+    uint32_t lost;          // Fila cheia
+    uint32_t served;
+} client_t;
+
+static struct {
+    rate_limit_service_t service;
+    int clients;
+    double rate;
+    int flooders;
+    double flood_rate;
+    uint32_t capacity;
+    uint32_t queue;
+    uint32_t seconds;
+    uint32_t seed;
+    int per_s;              // -1: padrão do serviço
+    int burst;
+    double min_served;      // %; 0: não confere
+    uint32_t flood_keys;    // Origens por inundador
+    double max_flood;       // Pacotes/s; 0: não confere
+} cfg = {
+    .service = RATE_LIMIT_DNS,
+    .clients = 8,
+    .rate = 2,
+    .flooders = 1,
+    .flood_rate = 1000,
+    .capacity = 300,
+    .queue = 8,
+    .seconds = 60,
+    .seed = 1,
+    .per_s = -1,
+    .burst = -1,
+    .flood_keys = 1,
+};
+
+static const struct {
+    uint16_t per_s;
+    uint16_t burst;
+} defaults[RATE_LIMIT_SERVICE_COUNT] = {
+    [RATE_LIMIT_HTTP] = { RATE_LIMIT_HTTP_PER_S, RATE_LIMIT_HTTP_BURST },
+    [RATE_LIMIT_DNS] = { RATE_LIMIT_DNS_PER_S, RATE_LIMIT_DNS_BURST },
+    [RATE_LIMIT_DHCP] = { RATE_LIMIT_DHCP_PER_S, RATE_LIMIT_DHCP_BURST },
+};
+
+static uint32_t rng;
+
+static double bench_uniform(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) / (double)(1 << 24);
+}
+
+static double bench_exp_ms(double rate) {
+    return -log(1.0 - bench_uniform()) * 1000.0 / rate;
+}
+
+static size_t key_len(void) {
+    // DHCP usa o MAC do chaddr; HTTP e DNS, o IPv4 de origem
+    return cfg.service == RATE_LIMIT_DHCP ? 6 : 4;
+}
+
+// Origem do próximo pacote de um inundador que gira entre --flood-keys
+static const uint8_t *flood_key(const client_t *cl, int id) {
+    static uint8_t key[RATE_LIMIT_KEY_MAX];
+    uint32_t k = (uint32_t)(bench_uniform() * cfg.flood_keys);
+    memcpy(key, cl->key, sizeof(key));
+    key[key_len() - 3] = (uint8_t)id;
+    key[key_len() - 2] = (uint8_t)(k >> 8);
+    key[key_len() - 1] = (uint8_t)k;
+    if (key_len() == 4) {
+        key[0] = 10;    // Fora da rede do AP, sem colidir com os legítimos
+    }
+    return key;
+}
+
+static void clients_init(client_t *c, int n) {
+    memset(c, 0, n * sizeof(*c));
+    for (int i = 0; i < n; i++) {
+        c[i].flooder = i >= cfg.clients;
+        c[i].rate = c[i].flooder ? cfg.flood_rate : cfg.rate;
+        c[i].next_ms = bench_exp_ms(c[i].rate);
+        if (cfg.service == RATE_LIMIT_DHCP) {
+            uint8_t mac[6] = { 0x02, 0, 0, 0, 0, (uint8_t)i };
+            memcpy(c[i].key, mac, 6);
+        } else {
+            uint8_t ip[4] = { 192, 168, 4, (uint8_t)(16 + i) };
+            memcpy(c[i].key, ip, 4);
+        }
+    }
+}
+
+static void run(client_t *c, int n, bool limit) {
+    rng = cfg.seed;
+    clients_init(c, n);
+    rate_limit_reset();
+    if (limit) {
+        rate_limit_set(cfg.service,
+                       cfg.per_s >= 0 ? cfg.per_s : defaults[cfg.service].per_s,
+                       cfg.burst >= 0 ? cfg.burst : defaults[cfg.service].burst);
+    } else {
+        rate_limit_set(cfg.service, 0, 1);
+    }
+
+    uint8_t queue[BENCH_MAX_QUEUE];
+    uint32_t head = 0, depth = 0;
+    uint32_t budget = 0;    // Em milésimos de pacote
+    for (uint32_t t = 0; t < cfg.seconds * 1000; t++) {
+        // Chegadas deste ms, a partir de um cliente sorteado (sem prioridade fixa)
+        int start = (int)(bench_uniform() * n);
+        for (int k = 0; k < n; k++) {
+            client_t *cl = &c[(start + k) % n];
+            int id = (int)(cl - c);
+            while (cl->next_ms < t + 1) {
+                cl->next_ms += bench_exp_ms(cl->rate);
+                cl->offered++;
+                const uint8_t *key = cl->flooder && cfg.flood_keys > 1 ? flood_key(cl, id) : cl->key;
+                if (!rate_limit_allow(cfg.service, key, key_len(), t)) {
+                    cl->limited++;
+                } else if (depth == cfg.queue) {
+                    cl->lost++;
+                } else {
+                    queue[(head + depth++) % BENCH_MAX_QUEUE] = (uint8_t)id;
+                }
+            }
+        }
+        // Atendimento
+        budget += cfg.capacity;
+        while (depth && budget >= 1000) {
+            c[queue[head]].served++;
+            head = (head + 1) % BENCH_MAX_QUEUE;
+            depth--;
+            budget -= 1000;
+        }
+        if (!depth && budget > 1000) {
+            budget = 1000;
+        }
+    }
+}
+
+// Retorna a menor fração atendida entre os clientes legítimos e, em
+// *flood_allowed, os pacotes/s dos inundadores que passaram pelo limite
+static double report(const char *name, const client_t *c, int n, double *flood_allowed) {
+    double legit_worst = 1;
+    *flood_allowed = 0;
+    printf("%s:\n", name);
+    for (int flooder = 0; flooder <= 1; flooder++) {
+        uint64_t offered = 0, limited = 0, lost = 0, served = 0;
+        double sum = 0, sum_sq = 0, worst = 1;
+        int count = 0;
+        for (int i = 0; i < n; i++) {
+            if (c[i].flooder != flooder) {
+                continue;
+            }
+            offered += c[i].offered;
+            limited += c[i].limited;
+            lost += c[i].lost;
+            served += c[i].served;
+            double share = c[i].offered ? (double)c[i].served / c[i].offered : 1;
+            sum += share;
+            sum_sq += share * share;
+            worst = share < worst ? share : worst;
+            count++;
+        }
+        if (!count) {
+            continue;
+        }
+        printf("  %-9s n=%-3d offered=%7.1f/s served=%7.1f/s limited=%7.1f/s lost=%7.1f/s",
+               flooder ? "flooders" : "legit", count, offered / (double)cfg.seconds,
+               served / (double)cfg.seconds, limited / (double)cfg.seconds, lost / (double)cfg.seconds);
+        if (!flooder) {
+            printf("  served %.1f%% (worst %.1f%%) jain=%.3f", offered ? 100.0 * served / offered : 100.0,
+                   100 * worst, sum_sq ? sum * sum / (count * sum_sq) : 1.0);
+            legit_worst = worst;
+        } else {
+            *flood_allowed = (offered - limited) / (double)cfg.seconds;
+        }
+        printf("\n");
+    }
+    return legit_worst;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Custo de uma consulta com a tabela cheia de origens distintas
+static void measure_lookup(void) {
+    const uint32_t iterations = 2000000;
+    rate_limit_reset();
+    rate_limit_set(RATE_LIMIT_DNS, 1000, 1000);
+    uint32_t allowed = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint32_t ip = 0xC0A80410 + i % RATE_LIMIT_ENTRIES;
+        allowed += rate_limit_allow(RATE_LIMIT_DNS, &ip, sizeof(ip), i / 64);
+    }
+    double ns = (double)(now_ns() - t0) / iterations;
+    printf("lookup: %.1f ns per packet with %d entries (%u allowed)\n", ns, RATE_LIMIT_ENTRIES, (unsigned)allowed);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --service NAME     http, dns or dhcp (default dns)\n"
+        "  --clients N        legitimate clients (default 8)\n"
+        "  --rate R           packets per second per legitimate client (default 2)\n"
+        "  --flooders N       flooding clients (default 1)\n"
+        "  --flood-rate R     packets per second per flooder (default 1000)\n"
+        "  --capacity C       packets per second the server can handle (default 300)\n"
+        "  --queue N          packets waiting for the server (default 8, max %d)\n"
+        "  --seconds S        simulated time (default 60)\n"
+        "  --limit P,B        per-client rate and burst (default: the service's)\n"
+        "  --seed N           arrival seed (default 1)\n"
+        "  --min-served P     fail if a legitimate client gets less than P%% served with the limit\n"
+        "  --flood-keys K     source addresses each flooder rotates through (default 1)\n"
+        "  --max-flood R      fail if flooders get more than R packets/s past the limit\n",
+        prog, BENCH_MAX_QUEUE);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "service", required_argument, NULL, 'S' },
+        { "clients", required_argument, NULL, 'c' },
+        { "rate", required_argument, NULL, 'r' },
+        { "flooders", required_argument, NULL, 'f' },
+        { "flood-rate", required_argument, NULL, 'F' },
+        { "capacity", required_argument, NULL, 'C' },
+        { "queue", required_argument, NULL, 'q' },
+        { "seconds", required_argument, NULL, 's' },
+        { "limit", required_argument, NULL, 'l' },
+        { "seed", required_argument, NULL, 'x' },
+        { "min-served", required_argument, NULL, 'm' },
+        { "flood-keys", required_argument, NULL, 'k' },
+        { "max-flood", required_argument, NULL, 'M' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'S': {
+                int found = -1;
+                for (int i = 0; i < RATE_LIMIT_SERVICE_COUNT; i++) {
+                    if (strcmp(optarg, rate_limit_service_name(i)) == 0) {
+                        found = i;
+                    }
+                }
+                if (found < 0) {
+                    usage(argv[0]);
+                    return 1;
+                }
+                cfg.service = found;
+                break;
+            }
+            case 'c': cfg.clients = atoi(optarg); break;
+            case 'r': cfg.rate = atof(optarg); break;
+            case 'f': cfg.flooders = atoi(optarg); break;
+            case 'F': cfg.flood_rate = atof(optarg); break;
+            case 'C': cfg.capacity = (uint32_t)atoi(optarg); break;
+            case 'q': cfg.queue = (uint32_t)atoi(optarg); break;
+            case 's': cfg.seconds = (uint32_t)atoi(optarg); break;
+            case 'l': {
+                char *end;
+                cfg.per_s = (int)strtol(optarg, &end, 10);
+                cfg.burst = *end == ',' ? atoi(end + 1) : cfg.per_s;
+                break;
+            }
+            case 'x': cfg.seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'm': cfg.min_served = atof(optarg); break;
+            case 'k': cfg.flood_keys = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'M': cfg.max_flood = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    int n = cfg.clients + cfg.flooders;
+    if (cfg.clients < 1 || cfg.flooders < 0 || n > BENCH_MAX_CLIENTS || cfg.rate <= 0 || cfg.flood_rate <= 0 ||
+        cfg.queue < 1 || cfg.queue > BENCH_MAX_QUEUE || cfg.seconds == 0 || cfg.flood_keys < 1 ||
+        cfg.flood_keys > 65536) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (cfg.seed == 0) {
+        cfg.seed = 1;
+    }
+
+    static client_t c[BENCH_MAX_CLIENTS];
+    printf("%s: %d clients at %.1f/s, %d flooders at %.0f/s from %u sources each, server %u/s, queue %u\n",
+           rate_limit_service_name(cfg.service), cfg.clients, cfg.rate, cfg.flooders, cfg.flood_rate,
+           (unsigned)cfg.flood_keys, (unsigned)cfg.capacity, (unsigned)cfg.queue);
+    double flood_allowed;
+    run(c, n, false);
+    report("no limit", c, n, &flood_allowed);
+    run(c, n, true);
+    double worst = report("per-client limit", c, n, &flood_allowed);
+    rate_limit_stats_t rs;
+    rate_limit_get_stats(&rs);
+    printf("  table: %u evictions, %u packets charged to the shared bucket\n",
+           (unsigned)rs.evictions, (unsigned)rs.overflowed);
+    measure_lookup();
+    int ret = 0;
+    if (100 * worst < cfg.min_served) {
+        printf("a legitimate client got %.1f%% served, below %.1f%%\n", 100 * worst, cfg.min_served);
+        ret = 1;
+    }
+    if (cfg.max_flood > 0 && flood_allowed > cfg.max_flood) {
+        printf("flooders got %.1f packets/s past the limit, above %.1f\n", flood_allowed, cfg.max_flood);
+        ret = 1;
+    }
+    return ret;
+}
@@ -0,0 +1,155 @@
+/**
+ * route_bench: custo da busca de rota HTTP no host.
+ *
+ * Compara a tabela gerada por tools/gen_routes.py (http_route_lookup, hash
+ * perfeito) com uma cadeia de strncmp sobre as mesmas rotas, como era o
+ * roteamento antes da tabela. A carga é uma sequência sorteada de chaves
+ * "MÉTODO caminho", com a fração --hit de rotas existentes; o resto são
+ * caminhos desconhecidos (sondas de portal cativo, prefixos e extensões das
+ * rotas, outros métodos), que no servidor viram o redirecionamento.
+ *
+ * Exemplo:
+ *   route_bench --hit 20 --lookups 50000000
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "http_routes.h"
+
+#define SEQUENCE_LEN 4096
+
+typedef struct {
+    const char *key;
+    size_t len;
+} route_key_t;
+
+#define ROUTE_KEY(name, method, path, handler) { method " " path, sizeof(method " " path) - 1 },
+static const route_key_t routes[HTTP_ROUTE_COUNT] = { HTTP_ROUTES(ROUTE_KEY) };
+
+static const char *const misses[] = {
+    "GET /",
+    "GET /generate_204",
+    "GET /gen_204",
+    "GET /hotspot-detect.html",
+    "GET /connecttest.txt",
+    "GET /ncsi.txt",
+    "GET /success.txt",
+    "GET /favicon.ico",
+    "GET /alar",
+    "GET /alarmx",
+    "GET /alarm/",
+    "GET /metrics/x",
+    "POST /alarm",
+    "HEAD /metrics",
+};
+
+static route_key_t sequence[SEQUENCE_LEN];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static uint32_t xorshift(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// Roteamento anterior: uma comparação por rota, na ordem da tabela
+static http_route_id_t strncmp_lookup(const char *key, size_t len) {
+    for (int i = 0; i < HTTP_ROUTE_COUNT; i++) {
+        if (len == routes[i].len && strncmp(key, routes[i].key, routes[i].len) == 0) {
+            return (http_route_id_t)i;
+        }
+    }
+    return HTTP_ROUTE_NONE;
+}
+
+typedef http_route_id_t (*lookup_fn)(const char *key, size_t len);
+
+static double run(lookup_fn lookup, uint64_t lookups, long *checksum) {
+    long sum = 0;
+    uint64_t t0 = now_ns();
+    for (uint64_t i = 0; i < lookups; i++) {
+        const route_key_t *k = &sequence[i % SEQUENCE_LEN];
+        sum += lookup(k->key, k->len);
+    }
+    uint64_t elapsed = now_ns() - t0;
+    *checksum = sum;
+    return (double)elapsed / lookups;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --hit PCT          percentage of lookups that match a route (default 50)\n"
+        "  --lookups N        lookups per method (default 20000000)\n"
+        "  --seed N           key sequence seed (default 1)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "hit", required_argument, NULL, 'p' },
+        { "lookups", required_argument, NULL, 'n' },
+        { "seed", required_argument, NULL, 'r' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    unsigned hit = 50;
+    uint64_t lookups = 20000000;
+    uint32_t seed = 1;
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'p': hit = (unsigned)atoi(optarg); break;
+            case 'n': lookups = strtoull(optarg, NULL, 0); break;
+            case 'r': seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (hit > 100 || lookups == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+
+    const size_t n_misses = sizeof(misses) / sizeof(misses[0]);
+    for (int i = 0; i < SEQUENCE_LEN; i++) {
+        if (xorshift(&seed) % 100 < hit) {
+            sequence[i] = routes[xorshift(&seed) % HTTP_ROUTE_COUNT];
+        } else {
+            const char *key = misses[xorshift(&seed) % n_misses];
+            sequence[i] = (route_key_t){ key, strlen(key) };
+        }
+        // As duas buscas precisam concordar antes de medir
+        if (http_route_lookup(sequence[i].key, sequence[i].len) != strncmp_lookup(sequence[i].key, sequence[i].len)) {
+            fprintf(stderr, "mismatch on '%s'\n", sequence[i].key);
+            return 1;
+        }
+    }
+
+    long sum_hash, sum_chain;
+    double hash_ns = run(http_route_lookup, lookups, &sum_hash);
+    double chain_ns = run(strncmp_lookup, lookups, &sum_chain);
+    if (sum_hash != sum_chain) {
+        fprintf(stderr, "checksum mismatch\n");
+        return 1;
+    }
+    printf("%d routes, %u%% hits, %llu lookups\n", HTTP_ROUTE_COUNT, hit, (unsigned long long)lookups);
+    printf("perfect hash   %6.2f ns/lookup\n", hash_ns);
+    printf("strncmp chain  %6.2f ns/lookup\n", chain_ns);
+    return 0;
+}
@@ -0,0 +1,234 @@
+/**
+ * template_bench: custo de montar as respostas pelos templates compilados
+ * (templates/, gerados por tools/gen_templates.py) no host, contra snprintf
+ * com as strings de formato que eles substituíram.
+ *
+ * Para a página do alarme (headers com o Content-Length e corpo), os headers
+ * da API e o redirecionamento: primeiro confere que os dois caminhos dão os
+ * mesmos bytes, depois mede a medição do tamanho e a escrita num sink de
+ * memória. Com --window W o sink aceita só W bytes por chamada, como um
+ * buffer de envio do TCP que enche, e o texto é retomado do byte onde parou.
+ *
+ * Exemplo:
+ *   template_bench --iterations 1000000 --window 64
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "http_templates.h"
+
+#define BENCH_DOC_MAX 1024
+
+// Formatos de antes dos templates (mesmo texto, já sem os espaços do HTML)
+#define HTML_CONTENT_TYPE "text/html; charset=utf-8"
+#define RESPONSE_HEADERS "HTTP/1.1 %d %s\r\nContent-Length: %lu\r\nContent-Type: %s\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n"
+#define ALARM_CONTROL_BODY "<html><body style=\"text-align:center;margin-top:50px\">" \
+"<h1>Alarme</h1>" \
+"<p>%s</p>" \
+"<a href=\"?alarm=%d\" style=\"background:#4CAF50;color:white;padding:5px 10px;text-decoration:none\">%s</a>" \
+"</body></html>"
+#define RESPONSE_REDIRECT "HTTP/1.1 302 Redirect\r\nLocation: http://%s%s\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"
+
+static struct {
+    uint32_t iterations;
+    uint32_t window;
+} cfg = {
+    .iterations = 1000000,
+    .window = 0,
+};
+
+typedef struct {
+    char *buf;
+    uint32_t len;
+    uint32_t calls;
+} mem_sink_t;
+
+static uint32_t mem_sink(void *arg, const char *data, uint32_t len) {
+    mem_sink_t *m = arg;
+    m->calls++;
+    if (cfg.window && len > cfg.window) {
+        len = cfg.window;
+    }
+    if (len > BENCH_DOC_MAX - m->len) {
+        len = BENCH_DOC_MAX - m->len;
+    }
+    memcpy(m->buf + m->len, data, len);
+    m->len += len;
+    return len;
+}
+
+typedef struct {
+    const char *name;
+    void (*args)(http_tmpl_arg_t *args, uint32_t i);
+    const http_template_t *const *templates;   // Terminado em NULL
+    int (*baseline)(char *buf, size_t size, uint32_t i);
+} bench_case_t;
+
+static void alarm_args(http_tmpl_arg_t *args, uint32_t i) {
+    bool active = i & 1;
+    args[HTTP_SLOT_STATE].s = active ? "ATIVADO" : "DESATIVADO";
+    args[HTTP_SLOT_NEXT].u = !active;
+    args[HTTP_SLOT_ACTION].s = active ? "Desligar" : "Ligar";
+    args[HTTP_SLOT_CODE].u = 200;
+    args[HTTP_SLOT_REASON].s = "OK";
+    args[HTTP_SLOT_TYPE].s = HTML_CONTENT_TYPE;
+    args[HTTP_SLOT_LENGTH].u = http_template_length(&http_template_alarm, args);
+}
+
+static int alarm_snprintf(char *buf, size_t size, uint32_t i) {
+    bool active = i & 1;
+    int body = snprintf(NULL, 0, ALARM_CONTROL_BODY, active ? "ATIVADO" : "DESATIVADO", !active,
+                        active ? "Desligar" : "Ligar");
+    int len = snprintf(buf, size, RESPONSE_HEADERS, 200, "OK", (unsigned long)body, HTML_CONTENT_TYPE);
+    return len + snprintf(buf + len, size - len, ALARM_CONTROL_BODY, active ? "ATIVADO" : "DESATIVADO",
+                          !active, active ? "Desligar" : "Ligar");
+}
+
+static void api_args(http_tmpl_arg_t *args, uint32_t i) {
+    args[HTTP_SLOT_CODE].u = 200;
+    args[HTTP_SLOT_REASON].s = "OK";
+    args[HTTP_SLOT_TYPE].s = "application/json";
+    args[HTTP_SLOT_LENGTH].u = 100 + i % 1000;
+}
+
+static int api_snprintf(char *buf, size_t size, uint32_t i) {
+    return snprintf(buf, size, RESPONSE_HEADERS, 200, "OK", (unsigned long)(100 + i % 1000), "application/json");
+}
+
+static void redirect_args(http_tmpl_arg_t *args, uint32_t i) {
+    (void)i;
+    args[HTTP_SLOT_HOST].s = "192.168.4.1";
+    args[HTTP_SLOT_PATH].s = "/";
+}
+
+static int redirect_snprintf(char *buf, size_t size, uint32_t i) {
+    (void)i;
+    return snprintf(buf, size, RESPONSE_REDIRECT, "192.168.4.1", "/");
+}
+
+static const http_template_t *const alarm_templates[] = { &http_template_response, &http_template_alarm, NULL };
+static const http_template_t *const api_templates[] = { &http_template_response, NULL };
+static const http_template_t *const redirect_templates[] = { &http_template_redirect, NULL };
+
+static const bench_case_t cases[] = {
+    { "alarm page", alarm_args, alarm_templates, alarm_snprintf },
+    { "api headers", api_args, api_templates, api_snprintf },
+    { "redirect", redirect_args, redirect_templates, redirect_snprintf },
+};
+
+// Escreve a resposta inteira, retomando cada template do byte onde o sink
+// parou, como HTTP_TEMPLATE
+static uint32_t write_doc(const bench_case_t *c, uint32_t i, mem_sink_t *m) {
+    http_tmpl_arg_t args[HTTP_TEMPLATE_MAX_SLOTS];
+    c->args(args, i);
+    m->len = 0;
+    for (const http_template_t *const *t = c->templates; *t; t++) {
+        uint32_t off = 0;
+        while (!http_template_emit(*t, args, &off, mem_sink, m)) {
+            if (m->len == BENCH_DOC_MAX) {
+                return 0;
+            }
+        }
+    }
+    return m->len;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void report(const char *name, uint64_t bytes, uint64_t ns, const char *extra) {
+    double s = ns / 1e9;
+    printf("  %-16s %10.0f docs/s %8.1f MB/s %7.1f ns/doc%s\n", name, cfg.iterations / s, bytes / s / 1e6,
+           (double)ns / cfg.iterations, extra);
+}
+
+static int bench_case(const bench_case_t *c) {
+    static char doc[BENCH_DOC_MAX], text[BENCH_DOC_MAX];
+    mem_sink_t m = { .buf = doc };
+    for (uint32_t i = 0; i < 2; i++) {
+        uint32_t len = write_doc(c, i, &m);
+        int text_len = c->baseline(text, sizeof(text), i);
+        if ((int)len != text_len || memcmp(doc, text, len) != 0) {
+            fprintf(stderr, "%s: template and snprintf disagree\n%.*s\n%.*s\n", c->name, (int)len, doc, text_len,
+                    text);
+            return 1;
+        }
+    }
+    printf("%s (%u bytes):\n", c->name, (unsigned)m.len);
+
+    uint64_t bytes = 0;
+    m.calls = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < cfg.iterations; i++) {
+        bytes += write_doc(c, i, &m);
+    }
+    uint64_t ns = now_ns() - t0;
+    char extra[64];
+    snprintf(extra, sizeof(extra), "  %.1f sink calls/doc", (double)m.calls / cfg.iterations);
+    report("template", bytes, ns, extra);
+
+    bytes = 0;
+    t0 = now_ns();
+    for (uint32_t i = 0; i < cfg.iterations; i++) {
+        bytes += c->baseline(text, sizeof(text), i);
+    }
+    report("snprintf", bytes, now_ns() - t0, "");
+
+    // Só o tamanho (o Content-Length), sem escrever nada
+    http_tmpl_arg_t args[HTTP_TEMPLATE_MAX_SLOTS];
+    bytes = 0;
+    t0 = now_ns();
+    for (uint32_t i = 0; i < cfg.iterations; i++) {
+        c->args(args, i);
+        for (const http_template_t *const *t = c->templates; *t; t++) {
+            bytes += http_template_length(*t, args);
+        }
+    }
+    report("length only", bytes, now_ns() - t0, "");
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --iterations N     responses per measurement (default 1000000)\n"
+        "  --window W         bytes the sink takes per call, 0 = all (default 0)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "iterations", required_argument, NULL, 'i' },
+        { "window", required_argument, NULL, 'w' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'i': cfg.iterations = (uint32_t)atoi(optarg); break;
+            case 'w': cfg.window = (uint32_t)atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (cfg.iterations == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        failed |= bench_case(&cases[i]);
+    }
+    return failed;
+}
@@ -0,0 +1,136 @@
+/**
+ * web_bench: bytes enviados por visualização do painel (web/, gerado por
+ * tools/gen_assets.py) e custo por requisição no host.
+ *
+ * Lê a mesma imagem que o firmware envia (picow_web_assets): por arquivo, o
+ * tamanho original, minificado e em gzip, a resposta 200 (headers prontos +
+ * conteúdo) e a 304, com o número de segmentos de --mss bytes. Uma
+ * visualização busca cada arquivo uma vez: na primeira o navegador recebe
+ * tudo, nas seguintes manda If-None-Match e recebe só as 304. O relatório
+ * compara com os arquivos originais sem compressão e dá a média para uma
+ * fração --cold de primeiras visitas. No fim mede a busca do arquivo e a
+ * comparação do ETag, que é todo o trabalho do servidor por requisição.
+ *
+ * Exemplo:
+ *   web_bench --cold 20 --mss 1460
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "web_assets.h"
+
+static struct {
+    double cold;            // Fração de primeiras visitas
+    uint32_t mss;
+    uint32_t iterations;
+} cfg = {
+    .cold = 0.2,
+    .mss = 1460,
+    .iterations = 5000000,
+};
+
+static uint32_t segments(uint32_t bytes) {
+    return (bytes + cfg.mss - 1) / cfg.mss;
+}
+
+// Headers da 200 do arquivo original: os mesmos sem o Content-Encoding e com
+// o Content-Length do arquivo
+static uint32_t identity_bytes(const web_asset_t *a) {
+    char len[2][16];
+    int grow = snprintf(len[0], sizeof(len[0]), "%lu", (unsigned long)a->raw_len) -
+               snprintf(len[1], sizeof(len[1]), "%lu", (unsigned long)a->len);
+    return a->headers_len - (uint32_t)strlen("Content-Encoding: gzip\r\n") + grow + a->raw_len;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Como http_etag_match em picow_access_point.c
+static bool etag_match(const char *if_none_match, const char *etag) {
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL;
+}
+
+static void measure_request(void) {
+    char keys[WEB_ASSET_COUNT][64];
+    for (int i = 0; i < WEB_ASSET_COUNT; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "GET %s", web_assets[i].path);
+    }
+    uint32_t hits = 0;
+    uint64_t t0 = now_ns();
+    for (uint32_t i = 0; i < cfg.iterations; i++) {
+        const char *key = keys[i % WEB_ASSET_COUNT];
+        const web_asset_t *a = web_asset_lookup(key, strlen(key));
+        hits += a && etag_match(a->etag, a->etag);
+    }
+    double ns = (double)(now_ns() - t0) / cfg.iterations;
+    printf("per request: %.1f ns for lookup and If-None-Match (%u hits)\n", ns, (unsigned)hits);
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  --cold P           percent of views that are first visits (default 20)\n"
+        "  --mss N            TCP segment size (default 1460)\n"
+        "  --iterations N     requests in the timing loop (default 5000000)\n",
+        prog);
+}
+
+int main(int argc, char **argv) {
+    static const struct option opts[] = {
+        { "cold", required_argument, NULL, 'c' },
+        { "mss", required_argument, NULL, 'm' },
+        { "iterations", required_argument, NULL, 'i' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 },
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "h", opts, NULL)) != -1) {
+        switch (opt) {
+            case 'c': cfg.cold = atof(optarg) / 100; break;
+            case 'm': cfg.mss = (uint32_t)atoi(optarg); break;
+            case 'i': cfg.iterations = (uint32_t)atoi(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt != 'h';
+        }
+    }
+    if (cfg.cold < 0 || cfg.cold > 1 || cfg.mss == 0 || cfg.iterations == 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    printf("%-16s %8s %8s %8s %10s %6s %10s %10s\n", "file", "raw", "minified", "gzip", "200 bytes", "segs",
+           "304 bytes", "identity");
+    uint32_t first = 0, repeat = 0, identity = 0, first_segs = 0, identity_segs = 0;
+    for (int i = 0; i < WEB_ASSET_COUNT; i++) {
+        const web_asset_t *a = &web_assets[i];
+        uint32_t ok = a->headers_len + a->len;
+        uint32_t plain = identity_bytes(a);
+        printf("%-16s %8lu %8lu %8lu %10lu %6lu %10u %10lu\n", a->path, (unsigned long)a->raw_len,
+               (unsigned long)a->min_len, (unsigned long)a->len, (unsigned long)ok, (unsigned long)segments(ok),
+               a->not_modified_len, (unsigned long)plain);
+        first += ok;
+        first_segs += segments(ok);
+        repeat += a->not_modified_len;
+        identity += plain;
+        identity_segs += segments(plain);
+    }
+    printf("page view (%d files):\n", WEB_ASSET_COUNT);
+    printf("  first visit   %6lu bytes in %lu segments\n", (unsigned long)first, (unsigned long)first_segs);
+    printf("  repeat (304)  %6lu bytes in %d segments\n", (unsigned long)repeat, WEB_ASSET_COUNT);
+    printf("  uncompressed  %6lu bytes in %lu segments (original files, same headers)\n",
+           (unsigned long)identity, (unsigned long)identity_segs);
+    printf("  %.0f%% first visits: %.0f bytes per view (%.1f%% of uncompressed)\n", cfg.cold * 100,
+           cfg.cold * first + (1 - cfg.cold) * repeat,
+           100 * (cfg.cold * first + (1 - cfg.cold) * repeat) / identity);
+    measure_request();
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Reply options for dhcpserver.c (see dhcp_options.h).
+ */
+#include <stdbool.h>
+#include <string.h>
+
+#include "dhcp_options.h"
+
+// Each encoder returns the number of bytes it wrote (code + len + data), or 0
+// if the option does not fit in the space left.
+typedef size_t (*dhcp_opt_encode_fn)(const dhcp_opt_server_t *s, uint8_t code, uint8_t *buf, size_t avail);
+
+typedef struct {
+    uint8_t code;
+    bool always; // sent even if the client did not ask for it
+    dhcp_opt_encode_fn encode;
+} dhcp_opt_entry_t;
+
+static size_t opt_encode_n(uint8_t code, const void *data, size_t n, uint8_t *buf, size_t avail) {
+    if (avail < 2 + n) {
+        return 0;
+    }
+    buf[0] = code;
+    buf[1] = n;
+    memcpy(buf + 2, data, n);
+    return 2 + n;
+}
+
+static size_t opt_encode_server_ip(const dhcp_opt_server_t *s, uint8_t code, uint8_t *buf, size_t avail) {
+    // server id, router and dns are all this server
+    return opt_encode_n(code, s->ip, 4, buf, avail);
+}
+
+static size_t opt_encode_netmask(const dhcp_opt_server_t *s, uint8_t code, uint8_t *buf, size_t avail) {
+    return opt_encode_n(code, s->nm, 4, buf, avail);
+}
+
+static size_t opt_encode_lease_time(const dhcp_opt_server_t *s, uint8_t code, uint8_t *buf, size_t avail) {
+    uint32_t t = s->lease_time_s;
+    const uint8_t be[4] = { t >> 24, t >> 16, t >> 8, t };
+    return opt_encode_n(code, be, 4, buf, avail);
+}
+
+// Options this server knows how to answer, in the order they are sent when
+// the client gives no parameter request list
+static const dhcp_opt_entry_t dhcp_opt_table[] = {
+    { DHCP_OPT_SERVER_ID, true, opt_encode_server_ip },
+    { DHCP_OPT_IP_LEASE_TIME, true, opt_encode_lease_time },
+    { DHCP_OPT_SUBNET_MASK, false, opt_encode_netmask },
+    { DHCP_OPT_ROUTER, false, opt_encode_server_ip }, // aka gateway; can have multiple addresses
+    { DHCP_OPT_DNS, false, opt_encode_server_ip }, // this server is the dns
+};
+
+static const dhcp_opt_entry_t *opt_table_find(uint8_t code) {
+    for (size_t i = 0; i < sizeof(dhcp_opt_table) / sizeof(dhcp_opt_table[0]); ++i) {
+        if (dhcp_opt_table[i].code == code) {
+            return &dhcp_opt_table[i];
+        }
+    }
+    return NULL;
+}
+
+const uint8_t *dhcp_opt_find(const uint8_t *opt, const uint8_t *end, uint8_t code) {
+    while (opt < end && *opt != DHCP_OPT_END) {
+        if (*opt == DHCP_OPT_PAD) {
+            // The only option besides END without a length byte
+            ++opt;
+            continue;
+        }
+        if (end - opt < 2 || opt[1] > end - opt - 2) {
+            return NULL;
+        }
+        if (*opt == code) {
+            return opt;
+        }
+        opt += 2 + opt[1];
+    }
+    return NULL;
+}
+
+uint8_t *dhcp_opt_write_reply(const dhcp_opt_server_t *s, uint8_t *opt, const uint8_t *opt_end,
+    const uint8_t *req, size_t req_len) {
+    const size_t n_table = sizeof(dhcp_opt_table) / sizeof(dhcp_opt_table[0]);
+    bool sent[sizeof(dhcp_opt_table) / sizeof(dhcp_opt_table[0])] = { false };
+
+    for (size_t i = 0; i < n_table; ++i) {
+        if (dhcp_opt_table[i].always) {
+            opt += dhcp_opt_table[i].encode(s, dhcp_opt_table[i].code, opt, opt_end - opt - 1);
+            sent[i] = true;
+        }
+    }
+
+    if (req == NULL) {
+        // Legacy client: send everything we have
+        for (size_t i = 0; i < n_table; ++i) {
+            if (!sent[i]) {
+                opt += dhcp_opt_table[i].encode(s, dhcp_opt_table[i].code, opt, opt_end - opt - 1);
+            }
+        }
+    } else {
+        // Answer in the client's order of preference, skipping duplicates
+        for (size_t i = 0; i < req_len; ++i) {
+            const dhcp_opt_entry_t *e = opt_table_find(req[i]);
+            if (e == NULL || sent[e - dhcp_opt_table]) {
+                continue;
+            }
+            sent[e - dhcp_opt_table] = true;
+            opt += e->encode(s, e->code, opt, opt_end - opt - 1);
+        }
+    }
+
+    *opt++ = DHCP_OPT_END;
+    return opt;
+}
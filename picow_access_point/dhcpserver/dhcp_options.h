@@ -0,0 +1,49 @@
+/*
+ * Reply options for dhcpserver.c, table driven.
+ *
+ * Kept free of lwIP so the host tests (bench/dhcp_options_test.c) can feed it
+ * the parameter request list of each client OS and check the reply.
+ */
+#ifndef _DHCP_OPTIONS_H_
+#define _DHCP_OPTIONS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DHCP_OPT_PAD                (0)
+#define DHCP_OPT_SUBNET_MASK        (1)
+#define DHCP_OPT_ROUTER             (3)
+#define DHCP_OPT_DNS                (6)
+#define DHCP_OPT_HOST_NAME          (12)
+#define DHCP_OPT_REQUESTED_IP       (50)
+#define DHCP_OPT_IP_LEASE_TIME      (51)
+#define DHCP_OPT_MSG_TYPE           (53)
+#define DHCP_OPT_SERVER_ID          (54)
+#define DHCP_OPT_PARAM_REQUEST_LIST (55)
+#define DHCP_OPT_MAX_MSG_SIZE       (57)
+#define DHCP_OPT_VENDOR_CLASS_ID    (60)
+#define DHCP_OPT_CLIENT_ID          (61)
+#define DHCP_OPT_END                (255)
+
+// What the options say about this server
+typedef struct {
+    uint8_t ip[4]; // server id, router and dns, in network order
+    uint8_t nm[4];
+    uint32_t lease_time_s;
+} dhcp_opt_server_t;
+
+// Finds option code in the request options (opt points past the magic
+// cookie, end is the end of the bytes actually received). Returns NULL if the
+// option is missing or its data runs past end, so a truncated option is
+// treated as absent and nothing past end is ever read.
+const uint8_t *dhcp_opt_find(const uint8_t *opt, const uint8_t *end, uint8_t code);
+
+// Writes the reply options after the message type, honouring the client's
+// parameter request list (option 55, req == NULL if it sent none). Mandatory
+// options go first so they are never the ones dropped for lack of space.
+// Always leaves room for, and writes, the END option; returns the byte after
+// it.
+uint8_t *dhcp_opt_write_reply(const dhcp_opt_server_t *s, uint8_t *opt, const uint8_t *opt_end,
+    const uint8_t *req, size_t req_len);
+
+#endif
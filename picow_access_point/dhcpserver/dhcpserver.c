@@ -29,12 +29,19 @@
 //  https://tools.ietf.org/html/rfc2132 -- DHCP Options and BOOTP Vendor Extensions
 
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 #include <errno.h>
+#include <stdbool.h>
 
 #include "cyw43_config.h"
 #include "dhcpserver.h"
+#include "dhcp_options.h"
 #include "lwip/udp.h"
+#include "lwip/sys.h"
+#include "latency.h"
+#include "ratelimit.h"
+#include "stack_profile.h"
 
 #define DHCPDISCOVER    (1)
 #define DHCPOFFER       (2)
@@ -45,26 +52,18 @@
 #define DHCPRELEASE     (7)
 #define DHCPINFORM      (8)
 
-#define DHCP_OPT_PAD                (0)
-#define DHCP_OPT_SUBNET_MASK        (1)
-#define DHCP_OPT_ROUTER             (3)
-#define DHCP_OPT_DNS                (6)
-#define DHCP_OPT_HOST_NAME          (12)
-#define DHCP_OPT_REQUESTED_IP       (50)
-#define DHCP_OPT_IP_LEASE_TIME      (51)
-#define DHCP_OPT_MSG_TYPE           (53)
-#define DHCP_OPT_SERVER_ID          (54)
-#define DHCP_OPT_PARAM_REQUEST_LIST (55)
-#define DHCP_OPT_MAX_MSG_SIZE       (57)
-#define DHCP_OPT_VENDOR_CLASS_ID    (60)
-#define DHCP_OPT_CLIENT_ID          (61)
-#define DHCP_OPT_END                (255)
-
 #define PORT_DHCP_SERVER (67)
 #define PORT_DHCP_CLIENT (68)
 
 #define DEFAULT_LEASE_TIME_S (24 * 60 * 60) // in seconds
 
+// RFC 2132 9.10: the smallest maximum message size a client may advertise
+// (option 57), which also counts the IP and UDP headers in front of the DHCP
+// message
+#define DHCP_MIN_MAX_MSG_SIZE (576)
+#define DHCP_IP_UDP_HDR_LEN (20 + 8)
+#define DHCP_MAX_PARAM_REQ (32)
+
 #define MAC_LEN (6)
 #define MAKE_IP4(a, b, c, d) ((a) << 24 | (b) << 16 | (c) << 8 | (d))
 
@@ -86,6 +85,11 @@ typedef struct {
     uint8_t options[312]; // optional parameters, variable, starts with magic
 } dhcp_msg_t;
 
+// The reply is built in a dhcp_msg_t, so it always fits the smallest maximum
+// message size and option 57 never needs to shorten it
+_Static_assert(sizeof(dhcp_msg_t) <= DHCP_MIN_MAX_MSG_SIZE - DHCP_IP_UDP_HDR_LEN,
+    "DHCP reply larger than the RFC 2132 minimum message size");
+
 static int dhcp_socket_new_dgram(struct udp_pcb **udp, void *cb_data, udp_recv_fn cb_udp_recv) {
     // family is AF_INET
     // type is SOCK_DGRAM
@@ -143,24 +147,6 @@ static int dhcp_socket_sendto(struct udp_pcb **udp, struct netif *nif, const voi
     return len;
 }
 
-static uint8_t *opt_find(uint8_t *opt, uint8_t cmd) {
-    for (int i = 0; i < 308 && opt[i] != DHCP_OPT_END;) {
-        if (opt[i] == cmd) {
-            return &opt[i];
-        }
-        i += 2 + opt[i + 1];
-    }
-    return NULL;
-}
-
-static void opt_write_n(uint8_t **opt, uint8_t cmd, size_t n, const void *data) {
-    uint8_t *o = *opt;
-    *o++ = cmd;
-    *o++ = n;
-    memcpy(o, data, n);
-    *opt = o + n;
-}
-
 static void opt_write_u8(uint8_t **opt, uint8_t cmd, uint8_t val) {
     uint8_t *o = *opt;
     *o++ = cmd;
@@ -169,18 +155,9 @@ static void opt_write_u8(uint8_t **opt, uint8_t cmd, uint8_t val) {
     *opt = o;
 }
 
-static void opt_write_u32(uint8_t **opt, uint8_t cmd, uint32_t val) {
-    uint8_t *o = *opt;
-    *o++ = cmd;
-    *o++ = 4;
-    *o++ = val >> 24;
-    *o++ = val >> 16;
-    *o++ = val >> 8;
-    *o++ = val;
-    *opt = o;
-}
-
 static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
     dhcp_server_t *d = arg;
     (void)upcb;
     (void)src_addr;
@@ -189,6 +166,14 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
     // This is around 548 bytes
     dhcp_msg_t dhcp_msg;
 
+    // Cliente acima do limite: descarta antes de copiar e interpretar. A
+    // origem é 0.0.0.0 até a concessão, então a chave é o MAC do chaddr
+    uint8_t mac[MAC_LEN];
+    if (pbuf_copy_partial(p, mac, MAC_LEN, offsetof(dhcp_msg_t, chaddr)) != MAC_LEN ||
+        !rate_limit_allow(RATE_LIMIT_DHCP, mac, MAC_LEN, sys_now())) {
+        goto ignore_request;
+    }
+
     #define DHCP_MIN_SIZE (240 + 3)
     if (p->tot_len < DHCP_MIN_SIZE) {
         goto ignore_request;
@@ -204,13 +189,26 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
 
     uint8_t *opt = (uint8_t *)&dhcp_msg.options;
     opt += 4; // assume magic cookie: 99, 130, 83, 99
+    // Options are only read up to what was received: past that, dhcp_msg
+    // holds stale stack bytes
+    const uint8_t *opt_end = (const uint8_t *)&dhcp_msg + len;
 
-    uint8_t *msgtype = opt_find(opt, DHCP_OPT_MSG_TYPE);
-    if (msgtype == NULL) {
+    const uint8_t *msgtype = dhcp_opt_find(opt, opt_end, DHCP_OPT_MSG_TYPE);
+    if (msgtype == NULL || msgtype[1] < 1) {
         // A DHCP package without MSG_TYPE?
         goto ignore_request;
     }
 
+    // The reply is built in place over the request options, so save what we
+    // need from them before anything is written
+    uint8_t param_req[DHCP_MAX_PARAM_REQ];
+    size_t param_req_len = 0;
+    const uint8_t *prl = dhcp_opt_find(opt, opt_end, DHCP_OPT_PARAM_REQUEST_LIST);
+    if (prl != NULL) {
+        param_req_len = prl[1] < sizeof(param_req) ? prl[1] : sizeof(param_req);
+        memcpy(param_req, prl + 2, param_req_len);
+    }
+
     switch (msgtype[2]) {
         case DHCPDISCOVER: {
             int yi = DHCPS_MAX_IP;
@@ -244,8 +242,8 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
         }
 
         case DHCPREQUEST: {
-            uint8_t *o = opt_find(opt, DHCP_OPT_REQUESTED_IP);
-            if (o == NULL) {
+            const uint8_t *o = dhcp_opt_find(opt, opt_end, DHCP_OPT_REQUESTED_IP);
+            if (o == NULL || o[1] != 4) {
                 // Should be NACK
                 goto ignore_request;
             }
@@ -281,17 +279,18 @@ static void dhcp_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
             goto ignore_request;
     }
 
-    opt_write_n(&opt, DHCP_OPT_SERVER_ID, 4, &ip4_addr_get_u32(ip_2_ip4(&d->ip)));
-    opt_write_n(&opt, DHCP_OPT_SUBNET_MASK, 4, &ip4_addr_get_u32(ip_2_ip4(&d->nm)));
-    opt_write_n(&opt, DHCP_OPT_ROUTER, 4, &ip4_addr_get_u32(ip_2_ip4(&d->ip))); // aka gateway; can have multiple addresses
-    opt_write_n(&opt, DHCP_OPT_DNS, 4, &ip4_addr_get_u32(ip_2_ip4(&d->ip))); // this server is the dns
-    opt_write_u32(&opt, DHCP_OPT_IP_LEASE_TIME, DEFAULT_LEASE_TIME_S);
-    *opt++ = DHCP_OPT_END;
+    dhcp_opt_server_t server = { .lease_time_s = DEFAULT_LEASE_TIME_S };
+    memcpy(server.ip, &ip4_addr_get_u32(ip_2_ip4(&d->ip)), 4);
+    memcpy(server.nm, &ip4_addr_get_u32(ip_2_ip4(&d->nm)), 4);
+    opt = dhcp_opt_write_reply(&server, opt, (uint8_t *)&dhcp_msg + sizeof(dhcp_msg),
+        prl != NULL ? param_req : NULL, param_req_len);
     struct netif *nif = ip_current_input_netif();
     dhcp_socket_sendto(&d->udp, nif, &dhcp_msg, opt - (uint8_t *)&dhcp_msg, 0xffffffff, PORT_DHCP_CLIENT);
 
 ignore_request:
     pbuf_free(p);
+    latency_end(LATENCY_DHCP, t0);
+    stack_probe_exit(stack_token);
 }
 
 void dhcp_server_init(dhcp_server_t *d, ip_addr_t *ip, ip_addr_t *nm) {
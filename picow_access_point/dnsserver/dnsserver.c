@@ -12,6 +12,10 @@
 
 #include "dnsserver.h"
 #include "lwip/udp.h"
+#include "lwip/sys.h"
+#include "latency.h"
+#include "ratelimit.h"
+#include "stack_profile.h"
 
 #define PORT_DNS_SERVER 53
 #define DUMP_DATA 0
@@ -101,12 +105,20 @@ static int dns_socket_sendto(struct udp_pcb **udp, const void *buf, size_t len,
 }
 
 static void dns_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p, const ip_addr_t *src_addr, u16_t src_port) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
     dns_server_t *d = arg;
     DEBUG_printf("dns_server_process %u\n", p->tot_len);
 
     uint8_t dns_msg[MAX_DNS_MSG_SIZE];
     dns_header_t *dns_hdr = (dns_header_t*)dns_msg;
 
+    // Cliente acima do limite: descarta antes de copiar e interpretar
+    uint32_t src = ip4_addr_get_u32(ip_2_ip4(src_addr));
+    if (!rate_limit_allow(RATE_LIMIT_DNS, &src, sizeof(src), sys_now())) {
+        goto ignore_request;
+    }
+
     size_t msg_len = pbuf_copy_partial(p, dns_msg, sizeof(dns_msg), 0);
     if (msg_len < sizeof(dns_header_t)) {
         goto ignore_request;
@@ -215,6 +227,8 @@ static void dns_server_process(void *arg, struct udp_pcb *upcb, struct pbuf *p,
 
 ignore_request:
     pbuf_free(p);
+    latency_end(LATENCY_DNS, t0);
+    stack_probe_exit(stack_token);
 }
 
 void dns_server_init(dns_server_t *d, ip_addr_t *ip) {
@@ -0,0 +1,98 @@
+/**
+ * Heap da aplicação e do lwIP (ver heap.h).
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "heap.h"
+
+#if PICOW_HEAP_TLSF
+#include "hardware/sync.h"
+#include "tlsf.h"
+
+static struct {
+    tlsf_t tlsf;
+    spin_lock_t *lock;
+    _Alignas(TLSF_ALIGN) uint8_t pool[PICOW_HEAP_SIZE];
+} heap;
+
+// Iniciado no primeiro uso, por qualquer entrada; ele acontece no core 0,
+// antes do core 1 existir
+static void heap_init(void) {
+    heap.lock = spin_lock_instance(spin_lock_claim_unused(true));
+    tlsf_init(&heap.tlsf, heap.pool, sizeof(heap.pool));
+}
+
+static uint32_t heap_lock(void) {
+    if (!heap.lock) {
+        heap_init();
+    }
+    return spin_lock_blocking(heap.lock);
+}
+
+void *heap_malloc(size_t size) {
+    uint32_t save = heap_lock();
+    void *p = tlsf_malloc(&heap.tlsf, size);
+    spin_unlock(heap.lock, save);
+    return p;
+}
+
+void *heap_calloc(size_t n, size_t size) {
+    if (size && n > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *p = heap_malloc(n * size);
+    if (p) {
+        memset(p, 0, n * size);
+    }
+    return p;
+}
+
+void heap_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    uint32_t save = heap_lock();
+    tlsf_free(&heap.tlsf, ptr);
+    spin_unlock(heap.lock, save);
+}
+
+bool heap_get_stats(heap_stats_t *out) {
+    tlsf_stats_t s;
+    uint32_t save = heap_lock();
+    tlsf_get_stats(&heap.tlsf, &s);
+    spin_unlock(heap.lock, save);
+    out->size = s.size;
+    out->used = s.used;
+    out->peak = s.peak;
+    out->free_bytes = s.free_bytes;
+    out->largest_free = s.largest_free;
+    out->free_blocks = s.free_blocks;
+    out->failures = s.failures;
+    return true;
+}
+#else
+void *heap_malloc(size_t size) {
+    return malloc(size);
+}
+
+void *heap_calloc(size_t n, size_t size) {
+    return calloc(n, size);
+}
+
+void heap_free(void *ptr) {
+    free(ptr);
+}
+
+bool heap_get_stats(heap_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    return false;
+}
+#endif
+
+uint32_t heap_fragmentation_permille(const heap_stats_t *s) {
+    if (s->free_bytes == 0) {
+        return 0;
+    }
+    return (uint32_t)(1000 - (uint64_t)s->largest_free * 1000 / s->free_bytes);
+}
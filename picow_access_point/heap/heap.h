@@ -0,0 +1,52 @@
+/**
+ * Heap da aplicação e do lwIP, com o alocador escolhido no build.
+ *
+ * No build poll (MEM_LIBC_MALLOC) todo mem_malloc do lwIP (pbufs de RAM,
+ * segmentos copiados por tcp_write), o estado de cada conexão e o buffer do
+ * display vêm do malloc. Com PICOW_HEAP_TLSF=1 essas alocações passam para
+ * um pool TLSF estático de PICOW_HEAP_SIZE bytes (tlsf.h): malloc e free em
+ * tempo constante e fragmentação limitada, medida em /metrics. O lwIP chega
+ * aqui pelos hooks mem_clib_* de lwipopts.h. Com PICOW_HEAP_TLSF=0 as
+ * funções são o malloc da libc.
+ *
+ * O pool é protegido por um spin lock de hardware (com as interrupções
+ * desligadas), porque o display pode rodar no core 1.
+ */
+#ifndef _HEAP_H_
+#define _HEAP_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PICOW_HEAP_TLSF
+#define PICOW_HEAP_TLSF 0
+#endif
+
+// Pool do TLSF; o que sobra da RAM continua com a newlib (printf, SDK)
+#ifndef PICOW_HEAP_SIZE
+#define PICOW_HEAP_SIZE (64 * 1024)
+#endif
+
+typedef struct {
+    size_t size;            // Bytes do pool (0 com a libc)
+    size_t used;
+    size_t peak;
+    size_t free_bytes;
+    size_t largest_free;    // Maior bloco livre: o maior pedido que ainda cabe
+    uint32_t free_blocks;
+    uint32_t failures;
+} heap_stats_t;
+
+void *heap_malloc(size_t size);
+void *heap_calloc(size_t n, size_t size);
+void heap_free(void *ptr);
+
+// false com a libc (sem pool para descrever)
+bool heap_get_stats(heap_stats_t *stats);
+
+// Fragmentação em milésimos: 1000 * (1 - maior bloco livre / bytes livres);
+// 0 com o espaço livre todo num bloco só
+uint32_t heap_fragmentation_permille(const heap_stats_t *stats);
+
+#endif
@@ -0,0 +1,292 @@
+/**
+ * Alocador TLSF (ver tlsf.h).
+ */
+#include <string.h>
+
+#include "tlsf.h"
+
+// O bit 0 do tamanho marca o bloco livre; os tamanhos são múltiplos de
+// TLSF_ALIGN
+#define BLOCK_FREE ((size_t)1)
+#define HEADER offsetof(tlsf_block_t, next_free)
+// Menor bloco: cabe os ponteiros da lista de livres
+#define BLOCK_MIN (sizeof(tlsf_block_t) - HEADER)
+#define BLOCK_MAX (((size_t)1 << TLSF_FL_MAX) - TLSF_ALIGN)
+
+#if TLSF_STEPS
+#define STEPS_RESET(t) ((t)->steps = 0)
+#define STEP(t) ((t)->steps++)
+#else
+#define STEPS_RESET(t) ((void)0)
+#define STEP(t) ((void)(t))
+#endif
+
+struct tlsf_block {
+    tlsf_block_t *prev_phys;    // Vizinho anterior no pool, NULL no primeiro
+    size_t size;                // Bytes de dados | BLOCK_FREE
+    tlsf_block_t *next_free;    // Só nos livres, já na área de dados
+    tlsf_block_t *prev_free;
+};
+
+_Static_assert(sizeof(tlsf_block_t) - offsetof(tlsf_block_t, next_free) == TLSF_ALIGN &&
+               offsetof(tlsf_block_t, next_free) == TLSF_ALIGN, "cabeçalho fora do alinhamento");
+_Static_assert(TLSF_SL_COUNT <= 32 && TLSF_FL_COUNT <= 32, "bitmaps de 32 bits");
+
+// Bit mais alto e mais baixo; no Cortex-M0+ (sem CLZ) o __builtin vira uma
+// função da libgcc por tabela, ainda em tempo constante
+static inline int fls_size(size_t v) {
+    return (int)(sizeof(unsigned long) * 8 - 1) - __builtin_clzl((unsigned long)v);
+}
+
+static inline int ffs_u32(uint32_t v) {
+    return __builtin_ctz(v);
+}
+
+static inline size_t block_size(const tlsf_block_t *b) {
+    return b->size & ~BLOCK_FREE;
+}
+
+static inline bool block_is_free(const tlsf_block_t *b) {
+    return b->size & BLOCK_FREE;
+}
+
+static inline tlsf_block_t *block_next(const tlsf_block_t *b) {
+    return (tlsf_block_t *)((char *)b + HEADER + block_size(b));
+}
+
+static inline void *block_data(tlsf_block_t *b) {
+    return (char *)b + HEADER;
+}
+
+static inline tlsf_block_t *block_from_data(const void *ptr) {
+    return (tlsf_block_t *)((char *)ptr - HEADER);
+}
+
+// Faixa (fl, sl) de um bloco de size bytes
+static void mapping_insert(size_t size, int *fl, int *sl) {
+    if (size < TLSF_SMALL) {
+        *fl = 0;
+        *sl = (int)(size / (TLSF_SMALL / TLSF_SL_COUNT));
+    } else {
+        int bit = fls_size(size);
+        *sl = (int)(size >> (bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *fl = bit - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+// Faixa onde todo bloco serve para size: o pedido arredondado para o início
+// da faixa seguinte
+static void mapping_search(size_t size, int *fl, int *sl) {
+    if (size >= TLSF_SMALL) {
+        size += ((size_t)1 << (fls_size(size) - TLSF_SL_LOG2)) - 1;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+static void free_list_insert(tlsf_t *t, tlsf_block_t *b) {
+    int fl, sl;
+    STEP(t);
+    mapping_insert(block_size(b), &fl, &sl);
+    tlsf_block_t *head = t->free[fl][sl];
+    b->prev_free = NULL;
+    b->next_free = head;
+    if (head) {
+        head->prev_free = b;
+    }
+    t->free[fl][sl] = b;
+    t->fl_bitmap |= 1u << fl;
+    t->sl_bitmap[fl] |= 1u << sl;
+    t->free_bytes += block_size(b);
+    t->free_blocks++;
+}
+
+static void free_list_remove(tlsf_t *t, tlsf_block_t *b) {
+    int fl, sl;
+    STEP(t);
+    mapping_insert(block_size(b), &fl, &sl);
+    if (b->prev_free) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        t->free[fl][sl] = b->next_free;
+        if (!b->next_free) {
+            t->sl_bitmap[fl] &= ~(1u << sl);
+            if (!t->sl_bitmap[fl]) {
+                t->fl_bitmap &= ~(1u << fl);
+            }
+        }
+    }
+    if (b->next_free) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    t->free_bytes -= block_size(b);
+    t->free_blocks--;
+}
+
+// Primeira lista não vazia a partir de (fl, sl)
+static tlsf_block_t *find_suitable(tlsf_t *t, int fl, int sl) {
+    STEP(t);
+    uint32_t sl_map = t->sl_bitmap[fl] & (~0u << sl);
+    if (!sl_map) {
+        STEP(t);
+        uint32_t fl_map = fl + 1 < 32 ? t->fl_bitmap & (~0u << (fl + 1)) : 0;
+        if (!fl_map) {
+            return NULL;
+        }
+        fl = ffs_u32(fl_map);
+        sl_map = t->sl_bitmap[fl];
+    }
+    return t->free[fl][ffs_u32(sl_map)];
+}
+
+bool tlsf_init(tlsf_t *t, void *mem, size_t bytes) {
+    memset(t, 0, sizeof(*t));
+    uintptr_t start = ((uintptr_t)mem + TLSF_ALIGN - 1) & ~(uintptr_t)(TLSF_ALIGN - 1);
+    if (bytes < start - (uintptr_t)mem) {
+        return false;
+    }
+    bytes = (bytes - (start - (uintptr_t)mem)) & ~(TLSF_ALIGN - 1);
+    // Um bloco livre com o pool todo e um sentinela de tamanho 0, sempre
+    // ocupado, no fim: o último bloco real nunca junta com o que vem depois
+    if (bytes < 2 * HEADER + BLOCK_MIN) {
+        return false;
+    }
+    size_t size = bytes - 2 * HEADER;
+    if (size > BLOCK_MAX) {
+        size = BLOCK_MAX;
+    }
+    tlsf_block_t *b = (tlsf_block_t *)start;
+    b->prev_phys = NULL;
+    b->size = size | BLOCK_FREE;
+    tlsf_block_t *sentinel = block_next(b);
+    sentinel->prev_phys = b;
+    sentinel->size = 0;
+    t->first = b;
+    t->size = size;
+    free_list_insert(t, b);
+    return true;
+}
+
+void *tlsf_malloc(tlsf_t *t, size_t size) {
+    STEPS_RESET(t);
+    if (size == 0 || size > BLOCK_MAX - TLSF_ALIGN) {
+        t->failures++;
+        return NULL;
+    }
+    size = (size + TLSF_ALIGN - 1) & ~(TLSF_ALIGN - 1);
+    if (size < BLOCK_MIN) {
+        size = BLOCK_MIN;
+    }
+    int fl, sl;
+    mapping_search(size, &fl, &sl);
+    tlsf_block_t *b = fl < TLSF_FL_COUNT ? find_suitable(t, fl, sl) : NULL;
+    if (!b) {
+        t->failures++;
+        return NULL;
+    }
+    free_list_remove(t, b);
+    size_t have = block_size(b);
+    if (have >= size + HEADER + BLOCK_MIN) {
+        // Sobra o bastante para outro bloco: volta para as listas
+        b->size = size;
+        tlsf_block_t *rest = block_next(b);
+        rest->prev_phys = b;
+        rest->size = (have - size - HEADER) | BLOCK_FREE;
+        block_next(rest)->prev_phys = rest;
+        free_list_insert(t, rest);
+    } else {
+        b->size = have;
+    }
+    t->used += block_size(b);
+    if (t->used > t->peak) {
+        t->peak = t->used;
+    }
+    t->allocs++;
+    return block_data(b);
+}
+
+void tlsf_free(tlsf_t *t, void *ptr) {
+    STEPS_RESET(t);
+    if (!ptr) {
+        return;
+    }
+    tlsf_block_t *b = block_from_data(ptr);
+    t->used -= block_size(b);
+    tlsf_block_t *next = block_next(b);
+    if (block_is_free(next)) {
+        free_list_remove(t, next);
+        b->size = block_size(b) + HEADER + block_size(next);
+        block_next(b)->prev_phys = b;
+    }
+    tlsf_block_t *prev = b->prev_phys;
+    if (prev && block_is_free(prev)) {
+        free_list_remove(t, prev);
+        prev->size = block_size(prev) + HEADER + block_size(b);
+        block_next(prev)->prev_phys = prev;
+        b = prev;
+    }
+    b->size = block_size(b) | BLOCK_FREE;
+    free_list_insert(t, b);
+}
+
+size_t tlsf_block_size(const void *ptr) {
+    return ptr ? block_size(block_from_data(ptr)) : 0;
+}
+
+void tlsf_get_stats(const tlsf_t *t, tlsf_stats_t *s) {
+    s->size = t->size;
+    s->used = t->used;
+    s->peak = t->peak;
+    s->free_bytes = t->free_bytes;
+    s->free_blocks = t->free_blocks;
+    s->allocs = t->allocs;
+    s->failures = t->failures;
+    s->largest_free = 0;
+    if (t->fl_bitmap) {
+        int fl = 31 - __builtin_clz(t->fl_bitmap);
+        int sl = 31 - __builtin_clz(t->sl_bitmap[fl]);
+        for (const tlsf_block_t *b = t->free[fl][sl]; b; b = b->next_free) {
+            if (block_size(b) > s->largest_free) {
+                s->largest_free = block_size(b);
+            }
+        }
+    }
+}
+
+bool tlsf_check(const tlsf_t *t) {
+    size_t used = 0, free_bytes = 0, headers = 0;
+    uint32_t free_blocks = 0;
+    const tlsf_block_t *prev = NULL;
+    const tlsf_block_t *b = t->first;
+    for (; b && block_size(b); prev = b, b = block_next(b)) {
+        if (b->prev_phys != prev || block_size(b) % TLSF_ALIGN || block_size(b) < BLOCK_MIN) {
+            return false;
+        }
+        if (block_is_free(b)) {
+            // Dois livres vizinhos deveriam ter sido juntados
+            if (prev && block_is_free(prev)) {
+                return false;
+            }
+            int fl, sl;
+            mapping_insert(block_size(b), &fl, &sl);
+            const tlsf_block_t *f = t->free[fl][sl];
+            while (f && f != b) {
+                f = f->next_free;
+            }
+            if (!f || !(t->sl_bitmap[fl] & (1u << sl)) || !(t->fl_bitmap & (1u << fl))) {
+                return false;
+            }
+            free_bytes += block_size(b);
+            free_blocks++;
+        } else {
+            used += block_size(b);
+        }
+        headers += prev ? HEADER : 0;
+    }
+    // Sentinela
+    if (!b || b->prev_phys != prev || block_is_free(b)) {
+        return false;
+    }
+    // Dados e cabeçalhos (menos o do primeiro) cobrem o pool inteiro
+    return used == t->used && free_bytes == t->free_bytes && free_blocks == t->free_blocks &&
+           used + free_bytes + headers == t->size;
+}
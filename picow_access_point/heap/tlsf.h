@@ -0,0 +1,105 @@
+/**
+ * Alocador TLSF (Two-Level Segregated Fit, Masmano et al.) sobre um pool
+ * fixo.
+ *
+ * Os blocos livres ficam em listas por faixa de tamanho: o primeiro nível é
+ * a potência de 2 do tamanho e o segundo divide cada potência em
+ * TLSF_SL_COUNT faixas iguais. Dois bitmaps dizem quais listas têm blocos,
+ * então malloc acha uma lista com bloco grande o bastante com duas buscas de
+ * bit (sem percorrer nada) e free junta o bloco aos vizinhos físicos livres
+ * pelos cabeçalhos: as duas operações levam tempo constante, qualquer que
+ * seja o estado do pool. O pedido é arredondado para cima até o início da
+ * faixa seguinte (good fit), o que limita a fragmentação sem busca.
+ *
+ * Cada bloco tem um cabeçalho de TLSF_ALIGN bytes (bloco físico anterior e
+ * tamanho com o bit de livre); os ponteiros da lista de livres ficam nos
+ * dados do bloco livre. Não há trava: quem usa de mais de um contexto
+ * (heap.h) serializa as chamadas.
+ */
+#ifndef _TLSF_H_
+#define _TLSF_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Faixas por potência de 2 (log2); 16 dá no máximo ~6% de arredondamento
+#ifndef TLSF_SL_LOG2
+#define TLSF_SL_LOG2 4
+#endif
+#define TLSF_SL_COUNT (1 << TLSF_SL_LOG2)
+
+// Maior bloco: 2^TLSF_FL_MAX bytes (o pool é limitado a isso)
+#ifndef TLSF_FL_MAX
+#define TLSF_FL_MAX 24
+#endif
+
+// Alinhamento dos dados e tamanho do cabeçalho: dois ponteiros (8 bytes no
+// RP2040, como o malloc da newlib)
+#define TLSF_ALIGN (2 * sizeof(void *))
+#define TLSF_ALIGN_LOG2 (sizeof(void *) == 8 ? 4 : 3)
+
+// Tamanhos abaixo de TLSF_SMALL ficam todos no primeiro nível, em faixas de
+// TLSF_ALIGN bytes
+#define TLSF_FL_SHIFT (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_SMALL ((size_t)1 << TLSF_FL_SHIFT)
+#define TLSF_FL_COUNT (TLSF_FL_MAX - TLSF_FL_SHIFT + 1)
+
+// Com TLSF_STEPS=1 (heap_bench) cada malloc e free conta em steps seus passos:
+// buscas de bitmap e inserções/remoções nas listas de livres. O pior caso
+// fica em operações, que não dependem do relógio nem de preempção: no máximo
+// TLSF_MALLOC_STEPS e TLSF_FREE_STEPS
+#ifndef TLSF_STEPS
+#define TLSF_STEPS 0
+#endif
+#define TLSF_MALLOC_STEPS 4     // Duas buscas, remoção e a sobra de volta
+#define TLSF_FREE_STEPS 3       // Dois vizinhos removidos e a inserção
+
+typedef struct tlsf_block tlsf_block_t;
+
+typedef struct {
+    uint32_t fl_bitmap;                         // Níveis com alguma lista não vazia
+    uint32_t sl_bitmap[TLSF_FL_COUNT];          // Listas não vazias de cada nível
+    tlsf_block_t *free[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    tlsf_block_t *first;                        // Primeiro bloco físico do pool
+    size_t size;                                // Dados do pool inteiro livre
+    size_t used;                                // Dados em blocos alocados
+    size_t peak;
+    size_t free_bytes;                          // Dados em blocos livres
+    uint32_t free_blocks;
+    uint32_t allocs;
+    uint32_t failures;
+#if TLSF_STEPS
+    uint32_t steps;                             // Passos da última operação
+#endif
+} tlsf_t;
+
+typedef struct {
+    size_t size;
+    size_t used;
+    size_t peak;
+    size_t free_bytes;
+    size_t largest_free;    // Maior bloco livre
+    uint32_t free_blocks;
+    uint32_t allocs;
+    uint32_t failures;
+} tlsf_stats_t;
+
+// Prepara o pool em mem (bytes, alinhado ou não); false se for pequeno demais
+bool tlsf_init(tlsf_t *t, void *mem, size_t bytes);
+
+// NULL se não houver bloco livre na faixa do pedido (ou size 0)
+void *tlsf_malloc(tlsf_t *t, size_t size);
+void tlsf_free(tlsf_t *t, void *ptr);
+
+// Bytes utilizáveis do bloco de ptr (o pedido arredondado)
+size_t tlsf_block_size(const void *ptr);
+
+// largest_free percorre uma lista só (a da maior faixa com blocos)
+void tlsf_get_stats(const tlsf_t *t, tlsf_stats_t *stats);
+
+// Percorre o pool e confere cabeçalhos, vizinhos e listas; para testes e o
+// bench, não para o caminho normal
+bool tlsf_check(const tlsf_t *t);
+
+#endif
@@ -0,0 +1,84 @@
+/**
+ * cyw43_arch do build host com FreeRTOS (port POSIX do kernel) e lwIP com
+ * NO_SYS=0, equivalente a pico_cyw43_arch_lwip_sys_freertos. A rede é a
+ * mesma interface tap de cyw43_arch_host.c; uma tarefa faz o papel do driver
+ * do rádio e entrega os quadros à tcpip_thread por tcpip_input.
+ *
+ * As tarefas do port POSIX são threads, mas só uma roda por vez: nada aqui
+ * pode bloquear em chamadas do sistema, por isso a tap é lida sem bloquear a
+ * cada tick.
+ */
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/tcpip.h"
+#include "lwip/netif.h"
+#include "hal_host.h"
+#include "host_display.h"
+#include "host_stats.h"
+#include "latency.h"
+#include "tap_netif.h"
+#include "rtos_tasks.h"
+
+#define TAP_TASK_STACK configMINIMAL_STACK_SIZE
+
+static struct netif ap_netif;
+static TaskHandle_t tap_handle;
+
+static void tcpip_ready(void *arg) {
+    xSemaphoreGive((SemaphoreHandle_t)arg);
+}
+
+// "Driver do rádio": mesma prioridade da tcpip_thread
+static void tap_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        tap_netif_input(&ap_netif);
+        vTaskDelay(1);
+    }
+}
+
+int cyw43_arch_init(void) {
+    host_display_init();
+    SemaphoreHandle_t done = xSemaphoreCreateBinary();
+    if (!done) {
+        return -1;
+    }
+    tcpip_init(tcpip_ready, done);
+    xSemaphoreTake(done, portMAX_DELAY);
+    vSemaphoreDelete(done);
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    if (tap_handle) {
+        vTaskDelete(tap_handle);
+        tap_handle = NULL;
+    }
+    host_display_report();
+    latency_print();
+    rtos_tasks_print();
+    host_stats_print_json(stdout);
+    tap_netif_close(&ap_netif);
+}
+
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth) {
+    (void)password;
+    (void)auth;
+    LOCK_TCPIP_CORE();
+    bool opened = tap_netif_open(&ap_netif, tcpip_input, ssid);
+    UNLOCK_TCPIP_CORE();
+    if (opened) {
+        xTaskCreate(tap_task, "tap", TAP_TASK_STACK, NULL, TCPIP_THREAD_PRIO, &tap_handle);
+    }
+}
+
+// Chamado com a trava (cyw43_arch_lwip_begin)
+void cyw43_arch_disable_ap_mode(void) {
+    netif_set_link_down(&ap_netif);
+    netif_set_down(&ap_netif);
+    netif_remove(&ap_netif);
+}
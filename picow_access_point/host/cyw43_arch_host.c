@@ -0,0 +1,76 @@
+/**
+ * cyw43_arch para o build host: o lwIP roda sobre uma interface tap do Linux
+ * no lugar do rádio. Crie a interface antes de executar, por exemplo:
+ *
+ *   sudo ip tuntap add dev tap0 mode tap user $USER
+ *   sudo ip link set tap0 up
+ *
+ * e obtenha um endereço pelo próprio servidor DHCP do firmware
+ * (ex.: sudo dhclient tap0). A variável de ambiente PICOW_TAP escolhe
+ * outra interface.
+ */
+#include <stdio.h>
+#include <poll.h>
+
+#include "pico/cyw43_arch.h"
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "netif/ethernet.h"
+#include "hal_host.h"
+#include "host_display.h"
+#include "host_stats.h"
+#include "latency.h"
+#include "loop_profile.h"
+#include "tap_netif.h"
+
+static struct netif ap_netif;
+
+int cyw43_arch_init(void) {
+    host_display_init();
+    lwip_init();
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    host_display_report();
+    latency_print();
+    loop_profile_print();
+    host_stats_print_json(stdout);
+    tap_netif_close(&ap_netif);
+}
+
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth) {
+    (void)password;
+    (void)auth;
+    tap_netif_open(&ap_netif, ethernet_input, ssid);
+}
+
+void cyw43_arch_disable_ap_mode(void) {
+    netif_set_link_down(&ap_netif);
+    netif_set_down(&ap_netif);
+    netif_remove(&ap_netif);
+}
+
+void cyw43_arch_poll(void) {
+    tap_netif_input(&ap_netif);
+    sys_check_timeouts();
+    hal_host_stdin_poll();
+}
+
+void cyw43_arch_wait_for_work_until(absolute_time_t until) {
+    int64_t wait_us = absolute_time_diff_us(get_absolute_time(), until);
+    if (wait_us <= 0) {
+        return;
+    }
+    uint32_t timers_ms = sys_timeouts_sleeptime();
+    int timeout_ms = (int)((wait_us + 999) / 1000);
+    if (timers_ms < (uint32_t)timeout_ms) {
+        timeout_ms = (int)timers_ms;
+    }
+    struct pollfd pfd[2] = {
+        { .fd = tap_netif_fd(), .events = POLLIN },
+        { .fd = hal_host_stdin_fd(), .events = POLLIN },
+    };
+    poll(pfd, 2, timeout_ms);
+}
@@ -0,0 +1,59 @@
+/**
+ * cyw43_arch do simulador: sem rádio nem tap. O servidor escuta em todas as
+ * interfaces e os clientes simulados (sim.c) falam com ele pela interface de
+ * loopback do lwIP, tudo em tempo virtual. Cada espera do laço principal
+ * avança o relógio até o próximo prazo (fim da espera, evento simulado ou
+ * timer do lwIP), de modo que horas de operação rodam em segundos.
+ */
+#include <stdio.h>
+
+#include "pico/cyw43_arch.h"
+#include "lwip/init.h"
+#include "lwip/netif.h"
+#include "lwip/timeouts.h"
+#include "hal_host.h"
+#include "host_display.h"
+#include "vclock.h"
+#include "sim.h"
+
+int cyw43_arch_init(void) {
+    vclock_set_virtual(0);
+    host_display_init();
+    lwip_init();
+    netif_set_default(netif_find("lo0"));
+    return 0;
+}
+
+void cyw43_arch_deinit(void) {
+    sim_report();
+}
+
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth) {
+    (void)password;
+    (void)auth;
+    printf("sim: AP '%s' on loopback\n", ssid);
+    sim_start();
+}
+
+void cyw43_arch_disable_ap_mode(void) {
+}
+
+void cyw43_arch_poll(void) {
+    // Repete até estabilizar: um evento pode gerar tráfego que gera outro evento
+    do {
+        netif_poll_all();
+        sys_check_timeouts();
+    } while (vclock_run_due() > 0);
+}
+
+void cyw43_arch_wait_for_work_until(absolute_time_t until) {
+    uint64_t next = vclock_next_event_us();
+    uint64_t timers = vclock_now_us() + sys_timeouts_sleeptime() * 1000ull;
+    if (next > until) {
+        next = until;
+    }
+    if (next > timers) {
+        next = timers;
+    }
+    vclock_advance_to(next);
+}
@@ -0,0 +1,372 @@
+/**
+ * HAL simulada do build host: tempo, GPIO, PWM, I2C e stdio.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+#include "hardware/i2c.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "cyw43_config.h"
+#include "lwip/sys.h"
+#include "hal_host.h"
+#include "vclock.h"
+#include "latency.h"
+
+#define HAL_HOST_MAX_I2C_DEVICES 4
+
+typedef struct {
+    uint8_t addr;
+    hal_host_i2c_write_fn write;
+    void *arg;
+} hal_host_i2c_dev_t;
+
+static struct {
+    bool gpio_out[HAL_HOST_NUM_GPIOS];
+    uint16_t pwm_level[HAL_HOST_NUM_GPIOS];
+    hal_host_event_t log[HAL_HOST_EVENT_LOG_LEN];
+    size_t log_next;
+    size_t log_count;
+    hal_host_counters_t counters;
+    hal_host_event_fn event_cb;
+    void *event_arg;
+    hal_host_i2c_dev_t i2c_dev[HAL_HOST_MAX_I2C_DEVICES];
+    void (*chars_cb)(void *);
+    void *chars_param;
+    bool stdin_eof;
+    int injected_char;
+} hal = { .injected_char = -1 };
+
+i2c_inst_t i2c0_inst = { .index = 0 };
+i2c_inst_t i2c1_inst = { .index = 1 };
+
+static void hal_record(hal_host_ev_type_t type, uint16_t id, uint32_t value) {
+    hal_host_event_t *ev = &hal.log[hal.log_next];
+    ev->time_us = time_us_64();
+    ev->type = type;
+    ev->id = id;
+    ev->value = value;
+    hal.log_next = (hal.log_next + 1) % HAL_HOST_EVENT_LOG_LEN;
+    if (hal.log_count < HAL_HOST_EVENT_LOG_LEN) {
+        hal.log_count++;
+    }
+    if (hal.event_cb) {
+        hal.event_cb(ev, hal.event_arg);
+    }
+}
+
+void hal_host_set_event_callback(hal_host_event_fn fn, void *arg) {
+    hal.event_cb = fn;
+    hal.event_arg = arg;
+}
+
+void hal_host_i2c_attach(uint8_t addr, hal_host_i2c_write_fn fn, void *arg) {
+    for (int i = 0; i < HAL_HOST_MAX_I2C_DEVICES; i++) {
+        if (hal.i2c_dev[i].write == NULL || hal.i2c_dev[i].addr == addr) {
+            hal.i2c_dev[i].addr = addr;
+            hal.i2c_dev[i].write = fn;
+            hal.i2c_dev[i].arg = arg;
+            return;
+        }
+    }
+    printf("hal_host: too many i2c devices\n");
+}
+
+size_t hal_host_events(hal_host_event_t *out, size_t max) {
+    size_t n = hal.log_count < max ? hal.log_count : max;
+    size_t first = (hal.log_next + HAL_HOST_EVENT_LOG_LEN - n) % HAL_HOST_EVENT_LOG_LEN;
+    for (size_t i = 0; i < n; i++) {
+        out[i] = hal.log[(first + i) % HAL_HOST_EVENT_LOG_LEN];
+    }
+    return n;
+}
+
+void hal_host_get_counters(hal_host_counters_t *c) {
+    *c = hal.counters;
+}
+
+bool hal_host_gpio_level(uint gpio) {
+    return gpio < HAL_HOST_NUM_GPIOS && hal.gpio_out[gpio];
+}
+
+uint16_t hal_host_pwm_level(uint gpio) {
+    return gpio < HAL_HOST_NUM_GPIOS ? hal.pwm_level[gpio] : 0;
+}
+
+// =============================================
+// Tempo
+// =============================================
+
+uint64_t time_us_64(void) {
+    return vclock_now_us();
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+// Relógio das sondas de latency.h
+uint32_t latency_clock_us(void) {
+    return (uint32_t)vclock_cost_us();
+}
+
+void sleep_us(uint64_t us) {
+    if (vclock_is_virtual()) {
+        vclock_advance_us(us);
+        return;
+    }
+    struct timespec ts = { .tv_sec = us / 1000000, .tv_nsec = (us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+void sleep_ms(uint32_t ms) {
+    sleep_us(ms * 1000ull);
+}
+
+void busy_wait_us(uint64_t us) {
+    if (vclock_is_virtual()) {
+        vclock_advance_us(us);
+        return;
+    }
+    uint64_t end = time_us_64() + us;
+    while (time_us_64() < end) {
+    }
+}
+
+// =============================================
+// Núcleos
+// =============================================
+
+static __thread uint core_num;
+static pthread_t core1_thread;
+static bool core1_running;
+static void (*core1_entry)(void);
+
+static void *core1_trampoline(void *arg) {
+    (void)arg;
+    core_num = 1;
+    core1_entry();
+    return NULL;
+}
+
+uint get_core_num(void) {
+    return core_num;
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    core1_entry = entry;
+    if (pthread_create(&core1_thread, NULL, core1_trampoline, NULL) != 0) {
+        perror("pthread_create");
+        return;
+    }
+    core1_running = true;
+}
+
+void multicore_reset_core1(void) {
+    if (core1_running) {
+        pthread_join(core1_thread, NULL);
+        core1_running = false;
+    }
+}
+
+struct host_spin_lock {
+    pthread_mutex_t mutex;
+};
+
+static struct host_spin_lock spin_locks[NUM_SPIN_LOCKS] = {
+    [0 ... NUM_SPIN_LOCKS - 1] = { PTHREAD_MUTEX_INITIALIZER },
+};
+static uint spin_locks_claimed;
+
+// Como no SDK, os locks são reservados no core 0 durante a inicialização
+int spin_lock_claim_unused(bool required) {
+    if (spin_locks_claimed == NUM_SPIN_LOCKS) {
+        if (required) {
+            fprintf(stderr, "no spin locks left\n");
+            abort();
+        }
+        return -1;
+    }
+    return (int)spin_locks_claimed++;
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num) {
+    return &spin_locks[lock_num];
+}
+
+uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    uint32_t save = save_and_disable_interrupts();
+    pthread_mutex_lock(&lock->mutex);
+    return save;
+}
+
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq) {
+    pthread_mutex_unlock(&lock->mutex);
+    restore_interrupts(saved_irq);
+}
+
+uint32_t cyw43_hal_ticks_ms(void) {
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+#if NO_SYS
+// Com NO_SYS=0 quem fornece é o sys_arch do FreeRTOS
+u32_t sys_now(void) {
+    return cyw43_hal_ticks_ms();
+}
+#endif
+
+// =============================================
+// GPIO e PWM
+// =============================================
+
+void gpio_init(uint gpio) {
+    gpio_put(gpio, 0);
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+    (void)gpio;
+    (void)out;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio >= HAL_HOST_NUM_GPIOS) {
+        return;
+    }
+    hal.gpio_out[gpio] = value;
+    hal.counters.gpio_writes++;
+    hal_record(HAL_HOST_EV_GPIO, gpio, value);
+}
+
+bool gpio_get(uint gpio) {
+    return hal_host_gpio_level(gpio);
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+    (void)gpio;
+    (void)fn;
+}
+
+void gpio_pull_up(uint gpio) {
+    (void)gpio;
+}
+
+pwm_config pwm_get_default_config(void) {
+    pwm_config c = { .clkdiv = 1.0f, .top = 0xffff };
+    return c;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div) {
+    c->clkdiv = div;
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) {
+    c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+    (void)slice_num;
+    (void)c;
+    (void)start;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+    if (gpio >= HAL_HOST_NUM_GPIOS) {
+        return;
+    }
+    hal.pwm_level[gpio] = level;
+    hal.counters.pwm_writes++;
+    hal_record(HAL_HOST_EV_PWM, gpio, level);
+}
+
+// =============================================
+// I2C
+// =============================================
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    if (vclock_is_virtual() && i2c->baudrate) {
+        // A CPU fica presa na transferência: 9 bits por byte, mais o byte de endereço
+        vclock_advance_us((len + 1) * 9 * 1000000ull / i2c->baudrate);
+    }
+    hal.counters.i2c_transactions++;
+    hal.counters.i2c_bytes += len;
+    hal_record(HAL_HOST_EV_I2C, addr, len);
+    for (int i = 0; i < HAL_HOST_MAX_I2C_DEVICES; i++) {
+        if (hal.i2c_dev[i].write && hal.i2c_dev[i].addr == addr) {
+            return hal.i2c_dev[i].write(hal.i2c_dev[i].arg, src, len, nostop);
+        }
+    }
+    // Sem modelo conectado: aceita tudo, como um display presente
+    return (int)len;
+}
+
+// =============================================
+// stdio
+// =============================================
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+    if (hal.injected_char >= 0) {
+        int c = hal.injected_char;
+        hal.injected_char = -1;
+        return c;
+    }
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, timeout_us / 1000) <= 0) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    unsigned char c;
+    ssize_t n = read(STDIN_FILENO, &c, 1);
+    if (n == 0) {
+        // stdin fechado (ex.: processo em segundo plano); para de monitorar
+        hal.stdin_eof = true;
+    }
+    if (n != 1) {
+        return PICO_ERROR_TIMEOUT;
+    }
+    return c;
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+    hal.chars_cb = fn;
+    hal.chars_param = param;
+}
+
+void hal_host_inject_char(char c) {
+    hal.injected_char = (unsigned char)c;
+    if (hal.chars_cb) {
+        hal.chars_cb(hal.chars_param);
+    }
+}
+
+int hal_host_stdin_fd(void) {
+    return hal.chars_cb && !hal.stdin_eof ? STDIN_FILENO : -1;
+}
+
+void hal_host_stdin_poll(void) {
+    if (hal_host_stdin_fd() < 0) {
+        return;
+    }
+    struct pollfd pfd = { .fd = STDIN_FILENO, .events = POLLIN };
+    if (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        hal.chars_cb(hal.chars_param);
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * HAL simulada do build host.
+ * Cada escrita em GPIO, PWM e I2C vira um evento com carimbo de tempo, que
+ * fica num buffer circular e pode ser entregue a um callback (benchmarks,
+ * modelos de dispositivo, verificações de temporização).
+ */
+#ifndef _HAL_HOST_H_
+#define _HAL_HOST_H_
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+#define HAL_HOST_NUM_GPIOS 30
+#define HAL_HOST_EVENT_LOG_LEN 256
+
+typedef enum {
+    HAL_HOST_EV_GPIO,   // id = pino, value = nível
+    HAL_HOST_EV_PWM,    // id = pino, value = nível do PWM
+    HAL_HOST_EV_I2C,    // id = endereço, value = número de bytes
+} hal_host_ev_type_t;
+
+typedef struct {
+    uint64_t time_us;
+    hal_host_ev_type_t type;
+    uint16_t id;
+    uint32_t value;
+} hal_host_event_t;
+
+typedef struct {
+    uint32_t gpio_writes;
+    uint32_t pwm_writes;
+    uint32_t i2c_transactions;
+    uint64_t i2c_bytes;
+} hal_host_counters_t;
+
+typedef void (*hal_host_event_fn)(const hal_host_event_t *ev, void *arg);
+
+// Dispositivo I2C simulado; retorna o número de bytes aceitos ou PICO_ERROR_GENERIC (NACK)
+typedef int (*hal_host_i2c_write_fn)(void *arg, const uint8_t *src, size_t len, bool nostop);
+
+void hal_host_set_event_callback(hal_host_event_fn fn, void *arg);
+void hal_host_i2c_attach(uint8_t addr, hal_host_i2c_write_fn fn, void *arg);
+
+// Copia até max eventos, do mais antigo para o mais recente, e retorna quantos copiou
+size_t hal_host_events(hal_host_event_t *out, size_t max);
+void hal_host_get_counters(hal_host_counters_t *c);
+
+// Usados pelo laço de rede (cyw43_arch_host.c) para despachar o callback de
+// caracteres disponíveis; o fd é -1 se não houver callback ou o stdin fechou
+int hal_host_stdin_fd(void);
+void hal_host_stdin_poll(void);
+
+// Entrega c como se tivesse sido digitado no console (usado pelo simulador)
+void hal_host_inject_char(char c);
+
+bool hal_host_gpio_level(uint gpio);
+uint16_t hal_host_pwm_level(uint gpio);
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * Display OLED do build host (ver host_display.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hal_host.h"
+#include "host_display.h"
+
+static struct {
+    ssd1306_model_t model;
+    const char *frame_dir;
+    uint32_t frame_max;
+    uint32_t dumped;
+    uint32_t changed;
+    uint64_t bus_bytes_sum;
+    uint32_t bus_bytes_max;
+    uint8_t last[SSD1306_MODEL_PAGES][SSD1306_MODEL_WIDTH];
+} disp;
+
+static int display_i2c_write(void *arg, const uint8_t *src, size_t len, bool nostop) {
+    (void)nostop;
+    return ssd1306_model_write(arg, src, len);
+}
+
+static void display_on_frame(const ssd1306_model_t *m, void *arg) {
+    (void)arg;
+    disp.bus_bytes_sum += m->stats.frame_bus_bytes;
+    if (m->stats.frame_bus_bytes > disp.bus_bytes_max) {
+        disp.bus_bytes_max = m->stats.frame_bus_bytes;
+    }
+    if (memcmp(disp.last, m->gddram, sizeof(disp.last)) == 0) {
+        return;
+    }
+    memcpy(disp.last, m->gddram, sizeof(disp.last));
+    disp.changed++;
+    if (!disp.frame_dir || disp.dumped >= disp.frame_max) {
+        return;
+    }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%06u.png", disp.frame_dir, disp.dumped);
+    ssd1306_model_write_png(m, path);
+    snprintf(path, sizeof(path), "%s/frame_%06u.pbm", disp.frame_dir, disp.dumped);
+    ssd1306_model_write_pbm(m, path);
+    disp.dumped++;
+}
+
+void host_display_init(void) {
+    ssd1306_model_init(&disp.model);
+    ssd1306_model_set_frame_callback(&disp.model, display_on_frame, NULL);
+    disp.frame_dir = getenv("PICOW_FRAME_DIR");
+    const char *max = getenv("PICOW_FRAME_MAX");
+    disp.frame_max = max ? (uint32_t)strtoul(max, NULL, 0) : 1000;
+    hal_host_i2c_attach(HOST_DISPLAY_I2C_ADDR, display_i2c_write, &disp.model);
+}
+
+const ssd1306_model_t *host_display_model(void) {
+    return &disp.model;
+}
+
+void host_display_report(void) {
+    const ssd1306_model_stats_t *s = &disp.model.stats;
+    printf("display: frames=%u changed=%u transactions=%u bus_bytes=%llu",
+        s->frames, disp.changed, s->transactions, (unsigned long long)s->bus_bytes);
+    if (s->frames) {
+        printf(" bytes/frame avg=%llu max=%u last_frame_transactions=%u",
+            (unsigned long long)(disp.bus_bytes_sum / s->frames), disp.bus_bytes_max,
+            s->frame_transactions);
+    }
+    printf("\n");
+    if (s->unknown_commands || s->writes_while_scrolling) {
+        printf("display: unknown_commands=%u writes_while_scrolling=%u\n",
+            s->unknown_commands, s->writes_while_scrolling);
+    }
+}
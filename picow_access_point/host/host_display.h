@@ -0,0 +1,18 @@
+/**
+ * Display OLED do build host: conecta o modelo do SSD1306 ao barramento I2C
+ * simulado no endereço do display. Com PICOW_FRAME_DIR definido, cada quadro
+ * cujo conteúdo mudou é salvo como frame_NNNNNN.png e .pbm nesse diretório
+ * (até PICOW_FRAME_MAX quadros, padrão 1000).
+ */
+#ifndef _HOST_DISPLAY_H_
+#define _HOST_DISPLAY_H_
+
+#include "ssd1306_model.h"
+
+#define HOST_DISPLAY_I2C_ADDR 0x3C
+
+void host_display_init(void);
+const ssd1306_model_t *host_display_model(void);
+void host_display_report(void);
+
+#endif
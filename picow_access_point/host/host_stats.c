@@ -0,0 +1,100 @@
+/**
+ * Consumo de memória do build host (ver host_stats.h).
+ */
+#include <stdlib.h>
+#include <malloc.h>
+
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "host_stats.h"
+
+static host_heap_stats_t heap;
+
+// O core 1 do build host é uma thread: contadores atualizados atomicamente
+#define HEAP_ADD(field, v) __atomic_add_fetch(&heap.field, (v), __ATOMIC_RELAXED)
+#define HEAP_SUB(field, v) __atomic_sub_fetch(&heap.field, (v), __ATOMIC_RELAXED)
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static void heap_add(void *p) {
+    if (!p) {
+        HEAP_ADD(failures, 1);
+        return;
+    }
+    HEAP_ADD(allocs, 1);
+    size_t current = HEAP_ADD(current, malloc_usable_size(p));
+    size_t peak = __atomic_load_n(&heap.peak, __ATOMIC_RELAXED);
+    while (current > peak &&
+           !__atomic_compare_exchange_n(&heap.peak, &peak, current, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void *__wrap_malloc(size_t size) {
+    void *p = __real_malloc(size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+    void *p = __real_calloc(n, size);
+    heap_add(p);
+    return p;
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    if (ptr) {
+        HEAP_SUB(current, malloc_usable_size(ptr));
+    }
+    void *p = __real_realloc(ptr, size);
+    if (!p && ptr && size) {
+        // realloc falhou e o bloco original continua válido
+        HEAP_ADD(current, malloc_usable_size(ptr));
+        HEAP_ADD(failures, 1);
+        return NULL;
+    }
+    heap_add(p);
+    return p;
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) {
+        HEAP_SUB(current, malloc_usable_size(ptr));
+    }
+    __real_free(ptr);
+}
+
+void host_heap_get_stats(host_heap_stats_t *s) {
+    *s = heap;
+}
+
+void host_stats_print_json(FILE *f) {
+    fprintf(f, "HOST_STATS {\"heap\":{\"current\":%zu,\"peak\":%zu,\"allocs\":%zu,\"failures\":%zu}",
+        heap.current, heap.peak, heap.allocs, heap.failures);
+#if LWIP_STATS && MEM_STATS
+    fprintf(f, ",\"lwip_mem\":{\"used\":%u,\"max\":%u,\"err\":%u}",
+        (unsigned)lwip_stats.mem.used, (unsigned)lwip_stats.mem.max, (unsigned)lwip_stats.mem.err);
+#endif
+#if LWIP_STATS && MEMP_STATS
+    static const struct {
+        const char *name;
+        int id;
+    } pools[] = {
+        { "pbuf_pool", MEMP_PBUF_POOL },
+        { "pbuf", MEMP_PBUF },
+        { "tcp_pcb", MEMP_TCP_PCB },
+        { "tcp_seg", MEMP_TCP_SEG },
+        { "udp_pcb", MEMP_UDP_PCB },
+    };
+    fprintf(f, ",\"memp\":{");
+    for (size_t i = 0; i < sizeof(pools) / sizeof(pools[0]); i++) {
+        const struct stats_mem *m = lwip_stats.memp[pools[i].id];
+        fprintf(f, "%s\"%s\":{\"avail\":%u,\"used\":%u,\"max\":%u,\"err\":%u}", i ? "," : "", pools[i].name,
+            (unsigned)m->avail, (unsigned)m->used, (unsigned)m->max, (unsigned)m->err);
+    }
+    fprintf(f, "}");
+#endif
+    fprintf(f, "}\n");
+}
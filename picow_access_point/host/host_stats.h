@@ -0,0 +1,23 @@
+/**
+ * Consumo de memória do build host: heap (todas as alocações do firmware e
+ * do lwIP passam por malloc, interceptado com --wrap) e pools do lwIP.
+ */
+#ifndef _HOST_STATS_H_
+#define _HOST_STATS_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+typedef struct {
+    size_t current;
+    size_t peak;
+    size_t allocs;
+    size_t failures;
+} host_heap_stats_t;
+
+void host_heap_get_stats(host_heap_stats_t *s);
+
+// Uma linha "HOST_STATS {...}" com heap e pools, lida pelo bench
+void host_stats_print_json(FILE *f);
+
+#endif
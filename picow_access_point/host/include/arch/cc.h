@@ -0,0 +1,22 @@
+/**
+ * Port do lwIP para o build host: só o necessário para NO_SYS=1.
+ * sys_now() é fornecido por hal_host.c.
+ */
+#ifndef _HOST_ARCH_CC_H
+#define _HOST_ARCH_CC_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define LWIP_TIMEVAL_PRIVATE 0
+
+#define LWIP_PLATFORM_DIAG(x) do { printf x; } while (0)
+#define LWIP_PLATFORM_ASSERT(x) do { \
+    printf("Assertion \"%s\" failed at line %d in %s\n", x, __LINE__, __FILE__); \
+    fflush(NULL); \
+    abort(); \
+} while (0)
+
+#define LWIP_RAND() ((u32_t)rand())
+
+#endif
@@ -0,0 +1,8 @@
+#ifndef _HOST_CYW43_CONFIG_H
+#define _HOST_CYW43_CONFIG_H
+
+#include <stdint.h>
+
+uint32_t cyw43_hal_ticks_ms(void);
+
+#endif
@@ -0,0 +1,6 @@
+#ifndef _HOST_HARDWARE_IRQ_H
+#define _HOST_HARDWARE_IRQ_H
+
+#include "pico/stdlib.h"
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef _HOST_HARDWARE_PWM_H
+#define _HOST_HARDWARE_PWM_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    float clkdiv;
+    uint16_t top;
+} pwm_config;
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) {
+    return (gpio >> 1u) & 7u;
+}
+
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv(pwm_config *c, float div);
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef _HOST_HARDWARE_SYNC_H
+#define _HOST_HARDWARE_SYNC_H
+
+#include "pico/stdlib.h"
+
+#if PICO_CYW43_ARCH_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+
+// No dispositivo (um núcleo) mascarar interrupções também impede a troca de
+// tarefa; no port POSIX quem faz isso é a seção crítica do kernel
+static inline uint32_t save_and_disable_interrupts(void) {
+    taskENTER_CRITICAL();
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+    taskEXIT_CRITICAL();
+}
+#else
+// Sem interrupções no build host: lwIP e console rodam na thread principal
+static inline uint32_t save_and_disable_interrupts(void) {
+    return 0;
+}
+
+static inline void restore_interrupts(uint32_t status) {
+    (void)status;
+}
+#endif
+
+// Sem WFE no host: o laço espera em poll() (cyw43_arch_wait_for_work_until)
+static inline void __sev(void) {
+}
+
+// Spin locks de hardware viram mutexes (o core 1 é uma thread, ver
+// pico/multicore.h); as interrupções seguem como acima
+#define NUM_SPIN_LOCKS 32u
+
+typedef struct host_spin_lock spin_lock_t;
+
+int spin_lock_claim_unused(bool required);
+spin_lock_t *spin_lock_instance(uint lock_num);
+uint32_t spin_lock_blocking(spin_lock_t *lock);
+void spin_unlock(spin_lock_t *lock, uint32_t saved_irq);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef _HOST_PICO_BINARY_INFO_H
+#define _HOST_PICO_BINARY_INFO_H
+
+#define bi_decl(...)
+#define bi_decl_if_func_used(...)
+
+#endif
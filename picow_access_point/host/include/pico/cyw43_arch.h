@@ -0,0 +1,39 @@
+/**
+ * Substituto de "pico/cyw43_arch.h" para o build host.
+ * O "access point" é uma interface tap do Linux (ver cyw43_arch_host.c);
+ * o comportamento segue o da variante poll (PICO_CYW43_ARCH_POLL) ou, com
+ * PICO_CYW43_ARCH_FREERTOS, o da sys_freertos (cyw43_arch_freertos.c).
+ */
+#ifndef _HOST_PICO_CYW43_ARCH_H
+#define _HOST_PICO_CYW43_ARCH_H
+
+#include "pico/stdlib.h"
+#include "cyw43_config.h"
+
+#define CYW43_AUTH_OPEN 0
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_ap_mode(const char *ssid, const char *password, uint32_t auth);
+void cyw43_arch_disable_ap_mode(void);
+void cyw43_arch_poll(void);
+void cyw43_arch_wait_for_work_until(absolute_time_t until);
+
+#if PICO_CYW43_ARCH_FREERTOS
+#include "lwip/tcpip.h"
+
+// Fora da tcpip_thread a API raw do lwIP só pode ser usada com a trava
+static inline void cyw43_arch_lwip_begin(void) {
+    LOCK_TCPIP_CORE();
+}
+
+static inline void cyw43_arch_lwip_end(void) {
+    UNLOCK_TCPIP_CORE();
+}
+#else
+static inline void cyw43_arch_lwip_begin(void) {}
+static inline void cyw43_arch_lwip_end(void) {}
+#endif
+
+#endif
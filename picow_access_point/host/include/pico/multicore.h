@@ -0,0 +1,13 @@
+/**
+ * Substituto de "pico/multicore.h" para o build host: o core 1 é uma thread.
+ */
+#ifndef _HOST_PICO_MULTICORE_H
+#define _HOST_PICO_MULTICORE_H
+
+#include "pico/stdlib.h"
+
+void multicore_launch_core1(void (*entry)(void));
+// Espera a thread do core 1 terminar (o firmware já pediu que ela saísse)
+void multicore_reset_core1(void);
+
+#endif
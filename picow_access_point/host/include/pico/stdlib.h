@@ -0,0 +1,100 @@
+/**
+ * Substituto de "pico/stdlib.h" para o build host (Linux).
+ * Declara apenas o subconjunto do SDK usado pelo firmware; as implementações
+ * ficam em hal_host.c e registram cada acesso ao hardware.
+ */
+#ifndef _HOST_PICO_STDLIB_H
+#define _HOST_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+typedef unsigned int uint;
+
+#define _u(x) x ## u
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+
+#define PICO_OK 0
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+// =============================================
+// Tempo
+// =============================================
+
+typedef uint64_t absolute_time_t;
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline uint64_t to_us_since_boot(absolute_time_t t) {
+    return t;
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) {
+    return t + us;
+}
+
+static inline absolute_time_t make_timeout_time_us(uint64_t us) {
+    return delayed_by_us(get_absolute_time(), us);
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return delayed_by_us(get_absolute_time(), ms * 1000ull);
+}
+
+// 0 na thread principal, 1 na thread do core 1 (pico/multicore.h)
+uint get_core_num(void);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void busy_wait_us(uint64_t us);
+
+// =============================================
+// GPIO
+// =============================================
+
+enum gpio_function {
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_NULL = 0x1f,
+};
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_put(uint gpio, bool value);
+bool gpio_get(uint gpio);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+
+// =============================================
+// stdio
+// =============================================
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+
+#endif
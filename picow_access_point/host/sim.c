@@ -0,0 +1,859 @@
+/**
+ * Cargas de trabalho e métricas do simulador (ver sim.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+#include "pico/stdlib.h"
+#include "hal_host.h"
+#include "host_display.h"
+#include "host_stats.h"
+#include "latency.h"
+#include "loop_profile.h"
+#include "tcp_states.h"
+#include "ratelimit.h"
+#include "vclock.h"
+#include "sim.h"
+
+// Mesmos valores de picow_access_point.c
+#define SIM_LED_GPIO            13
+#define SIM_PWM_GPIO            21
+#define SIM_TOGGLE_NOMINAL_US   (100 * 1000)
+#define SIM_HTTP_PORT           80
+
+#define SIM_MAX_HTTP_CLIENTS    32
+#define SIM_MAX_DHCP_CLIENTS    64
+#define SIM_MAX_LORIS_CLIENTS   32
+#define SIM_MAX_DHCP_FLOOD_PER_S 10000
+#define SIM_DHCP_TIMEOUT_US     (2 * 1000 * 1000)
+#define SIM_HTTP_HEAD_MAX       256
+
+#define DHCP_SERVER_PORT        67
+#define DHCP_CLIENT_PORT        68
+#define DHCP_MSG_LEN            300
+
+typedef struct {
+    uint32_t seconds;
+    uint32_t seed;
+    uint32_t http_clients;
+    uint32_t http_mean_ms;
+    uint32_t arm_period_ms;
+    uint32_t armed_ms;
+    uint32_t dhcp_arrival_ms;
+    uint32_t dhcp_stay_ms;
+    uint32_t loris_clients;
+    uint32_t loris_byte_ms;
+    uint32_t dhcp_flood_per_s;
+    uint32_t metrics_ms;
+    uint32_t http_fail_every;
+} sim_config_t;
+
+// Corpo em Transfer-Encoding: chunked, decodificado byte a byte
+typedef enum {
+    CHUNK_SIZE,
+    CHUNK_EXT,              // Extensão depois do tamanho (ignorada)
+    CHUNK_DATA,
+    CHUNK_DATA_END,         // CRLF depois dos dados
+    CHUNK_TRAILER,
+    CHUNK_DONE,
+    CHUNK_BAD,
+} sim_chunk_state_t;
+
+typedef struct {
+    uint8_t state;          // sim_chunk_state_t
+    bool line_empty;        // Nos trailers: linha atual ainda vazia
+    uint32_t left;          // Tamanho sendo lido, depois bytes restantes
+    uint32_t chunks;
+    size_t body;            // Bytes de dados decodificados
+} sim_chunked_t;
+
+typedef struct {
+    struct tcp_pcb *pcb;
+    const char *request;
+    uint64_t start_us;
+    size_t rx_len;
+    size_t head_len;        // Fim dos headers, 0 enquanto desconhecido
+    size_t expected;        // Headers + Content-Length, 0 se não houver
+    bool chunked;           // O fim é o chunk vazio
+    sim_chunked_t body;
+    char head[SIM_HTTP_HEAD_MAX];
+    bool busy;
+} sim_http_client_t;
+
+// Atacante slow-loris: headers que nunca terminam, um byte por vez
+typedef struct {
+    struct tcp_pcb *pcb;
+    size_t sent;
+    bool connected;
+} sim_loris_client_t;
+
+typedef struct {
+    uint8_t mac[6];
+    uint32_t xid;
+    uint8_t ip;          // último octeto da concessão, 0 se nenhuma
+    uint64_t sent_us;
+    bool active;
+    bool waiting;
+} sim_dhcp_client_t;
+
+static struct {
+    sim_config_t cfg;
+    uint32_t rng;
+    uint64_t end_us;
+
+    sim_http_client_t http[SIM_MAX_HTTP_CLIENTS];
+    sim_series_t http_latency_us;
+    uint32_t http_ok;
+    uint32_t http_errors;
+    uint32_t http_refused;
+    uint32_t http_server_writes;
+    uint32_t http_write_failures;   // Injetadas (PICOW_SIM_HTTP_FAIL_EVERY)
+
+    // Coletas de /metrics, em chunks: heap do host logo antes de cada uma e
+    // a cada pedaço recebido, para ver que não cresce com o corpo
+    uint32_t metrics_ok;
+    uint32_t metrics_errors;
+    size_t metrics_body_max;
+    uint32_t metrics_chunks_max;
+    size_t heap_idle_min, heap_idle_max;
+    size_t heap_stream_min, heap_stream_max;
+
+    sim_loris_client_t loris[SIM_MAX_LORIS_CLIENTS];
+    uint32_t loris_connects;
+    uint32_t loris_bytes;
+    uint32_t loris_dropped;
+
+    bool led_level;
+    uint64_t led_last_change_us;
+    uint16_t pwm_level;
+    uint64_t pwm_on_us;
+    sim_series_t toggle_interval_us;
+    sim_series_t beep_on_us;
+
+    struct udp_pcb *dhcp_pcb;
+    sim_dhcp_client_t dhcp[SIM_MAX_DHCP_CLIENTS];
+    uint8_t lease_owner[256][6];
+    uint32_t dhcp_arrivals;
+    uint32_t dhcp_departures;
+    uint32_t dhcp_acks;
+    uint32_t dhcp_timeouts;
+    uint32_t dhcp_reassigned;
+    uint32_t dhcp_rejected;
+    sim_series_t dhcp_latency_us;
+    sim_dhcp_client_t dhcp_flooder;     // Fora de dhcp[]: as respostas são ignoradas
+    uint32_t dhcp_flood_sent;
+} sim;
+
+// =============================================
+// Utilitários
+// =============================================
+
+static uint32_t env_u32(const char *name, uint32_t def) {
+    const char *v = getenv(name);
+    return v ? (uint32_t)strtoul(v, NULL, 0) : def;
+}
+
+static uint32_t sim_rand(void) {
+    // xorshift32: determinístico para uma dada semente
+    uint32_t x = sim.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return sim.rng = x;
+}
+
+// Intervalo com distribuição aproximadamente exponencial de média mean_ms
+static uint64_t sim_exp_us(uint32_t mean_ms) {
+    double u = (sim_rand() + 1.0) / 4294967297.0;
+    double ms = -(double)mean_ms * log(u);
+    return (uint64_t)(ms * 1000.0);
+}
+
+void sim_series_add(sim_series_t *s, uint32_t value) {
+    if (s->n == s->cap) {
+        s->cap = s->cap ? s->cap * 2 : 1024;
+        s->v = realloc(s->v, s->cap * sizeof(s->v[0]));
+    }
+    s->v[s->n++] = value;
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+uint32_t sim_series_percentile(sim_series_t *s, double p) {
+    if (s->n == 0) {
+        return 0;
+    }
+    qsort(s->v, s->n, sizeof(s->v[0]), cmp_u32);
+    size_t i = (size_t)(p / 100.0 * (s->n - 1) + 0.5);
+    return s->v[i];
+}
+
+void sim_series_free(sim_series_t *s) {
+    free(s->v);
+    memset(s, 0, sizeof(*s));
+}
+
+// =============================================
+// Saídas do alarme (LED e buzzer)
+// =============================================
+
+static void sim_on_hal_event(const hal_host_event_t *ev, void *arg) {
+    (void)arg;
+    if (ev->type == HAL_HOST_EV_GPIO && ev->id == SIM_LED_GPIO) {
+        // update_alarm() reescreve o nível a cada iteração; só conta transições
+        if (ev->value != sim.led_level) {
+            uint64_t interval = ev->time_us - sim.led_last_change_us;
+            if (sim.led_last_change_us && interval < 10 * SIM_TOGGLE_NOMINAL_US) {
+                sim_series_add(&sim.toggle_interval_us, (uint32_t)interval);
+            }
+            sim.led_level = ev->value;
+            sim.led_last_change_us = ev->time_us;
+        }
+    } else if (ev->type == HAL_HOST_EV_PWM && ev->id == SIM_PWM_GPIO) {
+        if (ev->value && !sim.pwm_level) {
+            sim.pwm_on_us = ev->time_us;
+        } else if (!ev->value && sim.pwm_level) {
+            sim_series_add(&sim.beep_on_us, (uint32_t)(ev->time_us - sim.pwm_on_us));
+        }
+        sim.pwm_level = (uint16_t)ev->value;
+    }
+}
+
+// =============================================
+// Falhas de escrita do servidor HTTP
+// =============================================
+
+err_t __real_tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags);
+
+// Todo tcp_write passa por aqui (--wrap=tcp_write); os dos clientes
+// simulados seguem direto. ERR_CONN, ao contrário de ERR_MEM, não é
+// "tente de novo": o handler marca ctx->failed e termina em HTTP_ERROR, que
+// no build com PICOW_DEFERRED_HTTP=0 acontece dentro do tcp_recv
+err_t __wrap_tcp_write(struct tcp_pcb *pcb, const void *dataptr, u16_t len, u8_t apiflags) {
+    if (sim.cfg.http_fail_every && pcb->local_port == SIM_HTTP_PORT &&
+        ++sim.http_server_writes % sim.cfg.http_fail_every == 0) {
+        sim.http_write_failures++;
+        return ERR_CONN;
+    }
+    return __real_tcp_write(pcb, dataptr, len, apiflags);
+}
+
+// =============================================
+// Clientes HTTP
+// =============================================
+
+// Coletor de /metrics (PICOW_SIM_METRICS_MS), separado do tráfego de fundo
+static sim_http_client_t metrics_client;
+
+static void http_finish(sim_http_client_t *c, bool ok) {
+    if (c->pcb) {
+        tcp_arg(c->pcb, NULL);
+        tcp_recv(c->pcb, NULL);
+        tcp_err(c->pcb, NULL);
+        if (tcp_close(c->pcb) != ERR_OK) {
+            tcp_abort(c->pcb);
+        }
+        c->pcb = NULL;
+    }
+    if (c == &metrics_client) {
+        if (ok) {
+            sim.metrics_ok++;
+            if (c->body.body > sim.metrics_body_max) {
+                sim.metrics_body_max = c->body.body;
+                sim.metrics_chunks_max = c->body.chunks;
+            }
+        } else {
+            sim.metrics_errors++;
+        }
+    } else if (ok) {
+        sim.http_ok++;
+        sim_series_add(&sim.http_latency_us, (uint32_t)(vclock_now_us() - c->start_us));
+    } else {
+        sim.http_errors++;
+    }
+    c->busy = false;
+}
+
+// Fim dos headers em c->head, ou 0 se ainda não chegou; preenche
+// c->expected (Content-Length) e c->chunked
+static size_t http_parse_head(sim_http_client_t *c) {
+    static const char length_header[] = "content-length:";
+    static const char chunked_header[] = "transfer-encoding: chunked";
+    const char *head = c->head;
+    const char *end = NULL;
+    for (const char *p = strchr(head, '\n'); p; p = strchr(p + 1, '\n')) {
+        if (p[1] == '\n' || (p[1] == '\r' && p[2] == '\n')) {
+            end = p + (p[1] == '\n' ? 2 : 3);
+            break;
+        }
+    }
+    if (!end) {
+        return 0;
+    }
+    for (const char *line = head; line < end; line = strchr(line, '\n') + 1) {
+        if (strncasecmp(line, length_header, sizeof(length_header) - 1) == 0) {
+            c->expected = (size_t)(end - head) + strtoul(line + sizeof(length_header) - 1, NULL, 10);
+        } else if (strncasecmp(line, chunked_header, sizeof(chunked_header) - 1) == 0) {
+            c->chunked = true;
+        }
+    }
+    return (size_t)(end - head);
+}
+
+static void chunked_newline(sim_chunked_t *d) {
+    if (d->left == 0) {
+        d->state = CHUNK_TRAILER;
+        d->line_empty = true;
+    } else {
+        d->state = CHUNK_DATA;
+        d->chunks++;
+    }
+}
+
+// Consome um byte; true quando o corpo acabou (chunk vazio e trailers)
+static bool chunked_feed(sim_chunked_t *d, uint8_t b) {
+    switch (d->state) {
+    case CHUNK_SIZE:
+        if (b >= '0' && b <= '9') {
+            d->left = d->left * 16 + (b - '0');
+        } else if ((b | 0x20) >= 'a' && (b | 0x20) <= 'f') {
+            d->left = d->left * 16 + ((b | 0x20) - 'a' + 10);
+        } else if (b == ';') {
+            d->state = CHUNK_EXT;
+        } else if (b == '\n') {
+            chunked_newline(d);
+        } else if (b != '\r') {
+            d->state = CHUNK_BAD;
+        }
+        break;
+    case CHUNK_EXT:
+        if (b == '\n') {
+            chunked_newline(d);
+        }
+        break;
+    case CHUNK_DATA:
+        d->body++;
+        if (--d->left == 0) {
+            d->state = CHUNK_DATA_END;
+        }
+        break;
+    case CHUNK_DATA_END:
+        if (b == '\n') {
+            d->state = CHUNK_SIZE;
+        } else if (b != '\r') {
+            d->state = CHUNK_BAD;
+        }
+        break;
+    case CHUNK_TRAILER:
+        if (b == '\n') {
+            if (d->line_empty) {
+                d->state = CHUNK_DONE;
+            }
+            d->line_empty = true;
+        } else if (b != '\r') {
+            d->line_empty = false;
+        }
+        break;
+    default:
+        break;
+    }
+    return d->state == CHUNK_DONE;
+}
+
+static void heap_sample(size_t *min, size_t *max) {
+    host_heap_stats_t heap;
+    host_heap_get_stats(&heap);
+    if (!*min || heap.current < *min) {
+        *min = heap.current;
+    }
+    if (heap.current > *max) {
+        *max = heap.current;
+    }
+}
+
+static err_t http_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    sim_http_client_t *c = arg;
+    (void)err;
+    if (!p) {
+        // O servidor fechou: resposta sem Content-Length (uma em chunks
+        // precisa ter chegado até o fim)
+        http_finish(c, c->rx_len > 0 && !c->chunked);
+        return ERR_OK;
+    }
+    if (c->rx_len < sizeof(c->head) - 1) {
+        size_t n = pbuf_copy_partial(p, c->head + c->rx_len, sizeof(c->head) - 1 - c->rx_len, 0);
+        c->head[c->rx_len + n] = 0;
+    }
+    size_t before = c->rx_len;
+    c->rx_len += p->tot_len;
+    tcp_recved(pcb, p->tot_len);
+    if (!c->head_len) {
+        c->head_len = http_parse_head(c);
+    }
+    bool done = c->expected && c->rx_len >= c->expected;
+    if (c->chunked) {
+        // Só os bytes depois dos headers
+        size_t skip = c->head_len > before ? c->head_len - before : 0;
+        for (struct pbuf *q = p; q && !done; q = q->next) {
+            for (u16_t i = 0; i < q->len && !done; i++) {
+                if (skip) {
+                    skip--;
+                } else {
+                    done = chunked_feed(&c->body, ((const uint8_t *)q->payload)[i]);
+                }
+            }
+        }
+        if (c == &metrics_client) {
+            heap_sample(&sim.heap_stream_min, &sim.heap_stream_max);
+        }
+    }
+    pbuf_free(p);
+    if (c->body.state == CHUNK_BAD) {
+        http_finish(c, false);
+    } else if (done) {
+        // Como um navegador: resposta completa, o cliente fecha primeiro
+        http_finish(c, true);
+    }
+    return ERR_OK;
+}
+
+static void http_err(void *arg, err_t err) {
+    sim_http_client_t *c = arg;
+    c->pcb = NULL; // já liberado pelo lwIP
+    if (err == ERR_RST) {
+        sim.http_refused++;
+    }
+    http_finish(c, false);
+}
+
+static err_t http_connected(void *arg, struct tcp_pcb *pcb, err_t err) {
+    sim_http_client_t *c = arg;
+    if (err != ERR_OK) {
+        http_finish(c, false);
+        return ERR_OK;
+    }
+    tcp_write(pcb, c->request, strlen(c->request), TCP_WRITE_FLAG_COPY);
+    tcp_output(pcb);
+    return ERR_OK;
+}
+
+static void http_start(sim_http_client_t *c, const char *request) {
+    if (c->busy) {
+        return;
+    }
+    c->busy = true;
+    c->request = request;
+    c->rx_len = 0;
+    c->head_len = 0;
+    c->expected = 0;
+    c->chunked = false;
+    memset(&c->body, 0, sizeof(c->body));
+    c->head[0] = 0;
+    c->start_us = vclock_now_us();
+    c->pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (!c->pcb) {
+        sim.http_refused++;
+        c->busy = false;
+        return;
+    }
+    ip_addr_t server;
+    IP4_ADDR(ip_2_ip4(&server), 127, 0, 0, 1);
+    tcp_arg(c->pcb, c);
+    tcp_recv(c->pcb, http_recv);
+    tcp_err(c->pcb, http_err);
+    if (tcp_connect(c->pcb, &server, SIM_HTTP_PORT, http_connected) != ERR_OK) {
+        http_finish(c, false);
+    }
+}
+
+static void http_client_tick(void *arg) {
+    static const char *const requests[] = {
+        "GET /alarm HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n",
+        "GET /generate_204 HTTP/1.1\r\nHost: connectivitycheck.gstatic.com\r\n\r\n",
+        "GET /hotspot-detect.html HTTP/1.1\r\nHost: captive.apple.com\r\n\r\n",
+    };
+    sim_http_client_t *c = arg;
+    http_start(c, requests[sim_rand() % count_of(requests)]);
+    vclock_schedule_in(sim_exp_us(sim.cfg.http_mean_ms), http_client_tick, c);
+}
+
+// Cliente dedicado ao ciclo armar/desarmar, separado do tráfego de fundo
+static sim_http_client_t arm_client;
+
+static void alarm_disarm(void *arg) {
+    (void)arg;
+    http_start(&arm_client, "GET /alarm?alarm=0 HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+}
+
+static void alarm_arm(void *arg) {
+    (void)arg;
+    http_start(&arm_client, "GET /alarm?alarm=1 HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+    vclock_schedule_in(sim.cfg.armed_ms * 1000ull, alarm_disarm, NULL);
+    vclock_schedule_in(sim.cfg.arm_period_ms * 1000ull, alarm_arm, NULL);
+}
+
+// Coleta periódica, como a do Prometheus
+static void metrics_tick(void *arg) {
+    (void)arg;
+    vclock_schedule_in(sim.cfg.metrics_ms * 1000ull, metrics_tick, NULL);
+    if (!metrics_client.busy) {
+        heap_sample(&sim.heap_idle_min, &sim.heap_idle_max);
+    }
+    http_start(&metrics_client, "GET /metrics HTTP/1.1\r\nHost: 192.168.4.1\r\n\r\n");
+}
+
+// =============================================
+// Ataque slow-loris
+// =============================================
+
+static void loris_drop(sim_loris_client_t *c) {
+    if (c->pcb) {
+        tcp_arg(c->pcb, NULL);
+        tcp_recv(c->pcb, NULL);
+        tcp_err(c->pcb, NULL);
+        tcp_abort(c->pcb);
+        c->pcb = NULL;
+    }
+    c->connected = false;
+    sim.loris_dropped++;
+}
+
+static err_t loris_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    sim_loris_client_t *c = arg;
+    (void)err;
+    if (!p) {
+        // O servidor desistiu da conexão
+        loris_drop(c);
+        return ERR_ABRT;
+    }
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+    return ERR_OK;
+}
+
+static void loris_err(void *arg, err_t err) {
+    sim_loris_client_t *c = arg;
+    (void)err;
+    c->pcb = NULL; // já liberado pelo lwIP (RST do servidor)
+    loris_drop(c);
+}
+
+static err_t loris_connected(void *arg, struct tcp_pcb *pcb, err_t err) {
+    sim_loris_client_t *c = arg;
+    (void)pcb;
+    c->connected = err == ERR_OK;
+    c->sent = 0;
+    return ERR_OK;
+}
+
+static void loris_tick(void *arg) {
+    // Linha de requisição válida seguida de headers sem fim
+    static const char prefix[] = "GET /alarm HTTP/1.1\r\nHost: 192.168.4.1\r\n";
+    static const char filler[] = "X-a: b\r\n";
+    sim_loris_client_t *c = arg;
+    vclock_schedule_in(sim.cfg.loris_byte_ms * 1000ull, loris_tick, c);
+
+    if (c->connected) {
+        char byte = c->sent < sizeof(prefix) - 1 ? prefix[c->sent] :
+                    filler[(c->sent - (sizeof(prefix) - 1)) % (sizeof(filler) - 1)];
+        if (tcp_write(c->pcb, &byte, 1, TCP_WRITE_FLAG_COPY) == ERR_OK) {
+            tcp_output(c->pcb);
+            c->sent++;
+            sim.loris_bytes++;
+        }
+        return;
+    }
+    if (c->pcb) {
+        return; // Conectando
+    }
+    c->pcb = tcp_new_ip_type(IPADDR_TYPE_V4);
+    if (!c->pcb) {
+        return;
+    }
+    ip_addr_t server;
+    IP4_ADDR(ip_2_ip4(&server), 127, 0, 0, 1);
+    tcp_arg(c->pcb, c);
+    tcp_recv(c->pcb, loris_recv);
+    tcp_err(c->pcb, loris_err);
+    sim.loris_connects++;
+    if (tcp_connect(c->pcb, &server, SIM_HTTP_PORT, loris_connected) != ERR_OK) {
+        loris_drop(c);
+    }
+}
+
+// =============================================
+// Clientes DHCP
+// =============================================
+
+static void dhcp_send(sim_dhcp_client_t *c, uint8_t msg_type) {
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, DHCP_MSG_LEN, PBUF_RAM);
+    if (!p) {
+        return;
+    }
+    uint8_t *m = p->payload;
+    memset(m, 0, DHCP_MSG_LEN);
+    m[0] = 1; // BOOTREQUEST
+    m[1] = 1; // Ethernet
+    m[2] = 6;
+    memcpy(&m[4], &c->xid, 4);
+    memcpy(&m[28], c->mac, 6);
+    uint8_t *o = &m[236];
+    *o++ = 99; *o++ = 130; *o++ = 83; *o++ = 99;
+    *o++ = 53; *o++ = 1; *o++ = msg_type;
+    if (msg_type == 3) {
+        *o++ = 50; *o++ = 4; *o++ = 192; *o++ = 168; *o++ = 4; *o++ = c->ip;
+    }
+    *o++ = 55; *o++ = 4; *o++ = 1; *o++ = 3; *o++ = 6; *o++ = 114;
+    *o++ = 255;
+
+    ip_addr_t server;
+    IP4_ADDR(ip_2_ip4(&server), 127, 0, 0, 1);
+    c->sent_us = vclock_now_us();
+    c->waiting = true;
+    udp_sendto(sim.dhcp_pcb, p, &server, DHCP_SERVER_PORT);
+    pbuf_free(p);
+}
+
+static void dhcp_check_timeout(void *arg) {
+    sim_dhcp_client_t *c = arg;
+    if (c->active && c->waiting && vclock_now_us() - c->sent_us >= SIM_DHCP_TIMEOUT_US) {
+        // Sem resposta: normalmente a faixa de endereços está esgotada
+        sim.dhcp_timeouts++;
+        c->waiting = false;
+        c->active = false;
+    }
+}
+
+static void dhcp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port) {
+    (void)arg;
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    uint8_t m[DHCP_MSG_LEN];
+    u16_t len = pbuf_copy_partial(p, m, sizeof(m), 0);
+    pbuf_free(p);
+    if (len < 243 || m[0] != 2) {
+        return;
+    }
+    for (int i = 0; i < SIM_MAX_DHCP_CLIENTS; i++) {
+        sim_dhcp_client_t *c = &sim.dhcp[i];
+        if (!c->active || !c->waiting || memcmp(&m[4], &c->xid, 4) != 0) {
+            continue;
+        }
+        c->waiting = false;
+        uint8_t type = m[240] == 53 ? m[242] : 0;
+        if (type == 2) {
+            c->ip = m[19];
+            dhcp_send(c, 3);
+            vclock_schedule_in(SIM_DHCP_TIMEOUT_US, dhcp_check_timeout, c);
+        } else if (type == 5) {
+            sim.dhcp_acks++;
+            sim_series_add(&sim.dhcp_latency_us, (uint32_t)(vclock_now_us() - c->sent_us));
+            uint8_t *owner = sim.lease_owner[c->ip];
+            if (memcmp(owner, "\0\0\0\0\0\0", 6) != 0 && memcmp(owner, c->mac, 6) != 0) {
+                sim.dhcp_reassigned++;
+            }
+            memcpy(owner, c->mac, 6);
+        } else {
+            sim.dhcp_rejected++;
+            c->active = false;
+        }
+        return;
+    }
+}
+
+static void dhcp_depart(void *arg) {
+    sim_dhcp_client_t *c = arg;
+    // O cliente simplesmente some, como um celular que sai de alcance
+    if (c->active) {
+        sim.dhcp_departures++;
+    }
+    c->active = false;
+}
+
+static void dhcp_arrive(void *arg) {
+    (void)arg;
+    vclock_schedule_in(sim_exp_us(sim.cfg.dhcp_arrival_ms), dhcp_arrive, NULL);
+    for (int i = 0; i < SIM_MAX_DHCP_CLIENTS; i++) {
+        sim_dhcp_client_t *c = &sim.dhcp[i];
+        if (c->active) {
+            continue;
+        }
+        memset(c, 0, sizeof(*c));
+        c->active = true;
+        c->mac[0] = 0x02;
+        for (int j = 1; j < 6; j++) {
+            c->mac[j] = (uint8_t)sim_rand();
+        }
+        c->xid = sim_rand();
+        sim.dhcp_arrivals++;
+        dhcp_send(c, 1);
+        vclock_schedule_in(SIM_DHCP_TIMEOUT_US, dhcp_check_timeout, c);
+        vclock_schedule_in(sim_exp_us(sim.cfg.dhcp_stay_ms), dhcp_depart, c);
+        return;
+    }
+}
+
+// Um MAC só mandando DISCOVER sem parar, como um cliente com defeito
+static void dhcp_flood_tick(void *arg) {
+    (void)arg;
+    vclock_schedule_in(1000000ull / sim.cfg.dhcp_flood_per_s, dhcp_flood_tick, NULL);
+    sim.dhcp_flooder.xid++;
+    sim.dhcp_flood_sent++;
+    dhcp_send(&sim.dhcp_flooder, 1);
+}
+
+// =============================================
+// Início, fim e relatório
+// =============================================
+
+static void sim_end(void *arg) {
+    (void)arg;
+    // Mesma tecla que encerra o firmware pelo console
+    hal_host_inject_char('d');
+}
+
+void sim_start(void) {
+    sim.cfg.seconds = env_u32("PICOW_SIM_SECONDS", 3600);
+    sim.cfg.seed = env_u32("PICOW_SIM_SEED", 1);
+    sim.cfg.http_clients = env_u32("PICOW_SIM_HTTP_CLIENTS", 4);
+    sim.cfg.http_mean_ms = env_u32("PICOW_SIM_HTTP_MEAN_MS", 5000);
+    sim.cfg.arm_period_ms = env_u32("PICOW_SIM_ARM_PERIOD_MS", 60000);
+    sim.cfg.armed_ms = env_u32("PICOW_SIM_ARMED_MS", 20000);
+    sim.cfg.dhcp_arrival_ms = env_u32("PICOW_SIM_DHCP_ARRIVAL_MS", 60000);
+    sim.cfg.dhcp_stay_ms = env_u32("PICOW_SIM_DHCP_STAY_MS", 600000);
+    sim.cfg.loris_clients = env_u32("PICOW_SIM_LORIS_CLIENTS", 0);
+    sim.cfg.loris_byte_ms = env_u32("PICOW_SIM_LORIS_BYTE_MS", 1000);
+    sim.cfg.dhcp_flood_per_s = env_u32("PICOW_SIM_DHCP_FLOOD_PER_S", 0);
+    sim.cfg.metrics_ms = env_u32("PICOW_SIM_METRICS_MS", 0);
+    sim.cfg.http_fail_every = env_u32("PICOW_SIM_HTTP_FAIL_EVERY", 0);
+    if (sim.cfg.http_clients > SIM_MAX_HTTP_CLIENTS) {
+        sim.cfg.http_clients = SIM_MAX_HTTP_CLIENTS;
+    }
+    if (sim.cfg.loris_clients > SIM_MAX_LORIS_CLIENTS) {
+        sim.cfg.loris_clients = SIM_MAX_LORIS_CLIENTS;
+    }
+    if (sim.cfg.dhcp_flood_per_s > SIM_MAX_DHCP_FLOOD_PER_S) {
+        sim.cfg.dhcp_flood_per_s = SIM_MAX_DHCP_FLOOD_PER_S;
+    }
+    sim.rng = sim.cfg.seed ? sim.cfg.seed : 1;
+    sim.end_us = vclock_now_us() + sim.cfg.seconds * 1000000ull;
+
+    hal_host_set_event_callback(sim_on_hal_event, NULL);
+
+    sim.dhcp_pcb = udp_new();
+    udp_bind(sim.dhcp_pcb, IP_ANY_TYPE, DHCP_CLIENT_PORT);
+    udp_recv(sim.dhcp_pcb, dhcp_recv, NULL);
+
+    // Dá tempo ao firmware de abrir o servidor antes do primeiro cliente
+    const uint64_t warmup_us = 1000 * 1000;
+    for (uint32_t i = 0; i < sim.cfg.http_clients; i++) {
+        vclock_schedule_in(warmup_us + sim_exp_us(sim.cfg.http_mean_ms), http_client_tick, &sim.http[i]);
+    }
+    for (uint32_t i = 0; i < sim.cfg.loris_clients; i++) {
+        vclock_schedule_in(warmup_us + sim_rand() % (sim.cfg.loris_byte_ms * 1000ull), loris_tick, &sim.loris[i]);
+    }
+    vclock_schedule_in(warmup_us, alarm_arm, NULL);
+    vclock_schedule_in(warmup_us, dhcp_arrive, NULL);
+    if (sim.cfg.metrics_ms) {
+        vclock_schedule_in(warmup_us + sim.cfg.metrics_ms * 1000ull, metrics_tick, NULL);
+    }
+    if (sim.cfg.dhcp_flood_per_s) {
+        static const uint8_t flooder_mac[6] = { 0x02, 0xff, 0xff, 0xff, 0xff, 0x01 };
+        memcpy(sim.dhcp_flooder.mac, flooder_mac, sizeof(flooder_mac));
+        vclock_schedule_in(warmup_us, dhcp_flood_tick, NULL);
+    }
+    vclock_schedule_at(sim.end_us, sim_end, NULL);
+}
+
+static void report_series(const char *name, sim_series_t *s, int64_t nominal_us) {
+    if (s->n == 0) {
+        printf("  %-22s no samples\n", name);
+        return;
+    }
+    uint32_t p50 = sim_series_percentile(s, 50);
+    uint32_t p99 = sim_series_percentile(s, 99);
+    uint32_t p999 = sim_series_percentile(s, 99.9);
+    uint32_t max = s->v[s->n - 1];
+    printf("  %-22s n=%zu p50=%.1fms p99=%.1fms p99.9=%.1fms max=%.1fms", name, s->n,
+        p50 / 1000.0, p99 / 1000.0, p999 / 1000.0, max / 1000.0);
+    if (nominal_us) {
+        printf(" (jitter p99 %+.1fms)", ((int64_t)p99 - nominal_us) / 1000.0);
+    }
+    printf("\n");
+}
+
+void sim_report(void) {
+    printf("\n=== simulation: %u s virtual, seed %u ===\n", sim.cfg.seconds, sim.cfg.seed);
+    printf("alarm outputs:\n");
+    report_series("led toggle interval", &sim.toggle_interval_us, SIM_TOGGLE_NOMINAL_US);
+    report_series("beep on time", &sim.beep_on_us, SIM_TOGGLE_NOMINAL_US);
+    printf("dhcp:\n");
+    printf("  arrivals=%u departures=%u acks=%u timeouts=%u rejected=%u reassigned=%u\n",
+        sim.dhcp_arrivals, sim.dhcp_departures, sim.dhcp_acks, sim.dhcp_timeouts,
+        sim.dhcp_rejected, sim.dhcp_reassigned);
+    report_series("dhcp request latency", &sim.dhcp_latency_us, 0);
+    if (sim.cfg.dhcp_flood_per_s) {
+        printf("  flood: rate=%u/s sent=%u\n", sim.cfg.dhcp_flood_per_s, sim.dhcp_flood_sent);
+    }
+    printf("http:\n");
+    printf("  ok=%u errors=%u refused=%u\n", sim.http_ok, sim.http_errors, sim.http_refused);
+    report_series("request latency", &sim.http_latency_us, 0);
+    if (sim.cfg.http_fail_every) {
+        printf("  server writes=%u failures injected=%u\n", sim.http_server_writes, sim.http_write_failures);
+    }
+    if (sim.cfg.metrics_ms) {
+        printf("  metrics: ok=%u errors=%u largest body %zu bytes in %u chunks\n", sim.metrics_ok,
+            sim.metrics_errors, sim.metrics_body_max, sim.metrics_chunks_max);
+        printf("  host heap before scrapes %zu..%zu bytes, while streaming %zu..%zu bytes\n",
+            sim.heap_idle_min, sim.heap_idle_max, sim.heap_stream_min, sim.heap_stream_max);
+    }
+    if (sim.cfg.loris_clients) {
+        printf("slow-loris: clients=%u byte_every=%ums connects=%u bytes=%u dropped_by_server=%u\n",
+            sim.cfg.loris_clients, sim.cfg.loris_byte_ms, sim.loris_connects, sim.loris_bytes,
+            sim.loris_dropped);
+    }
+    rate_limit_stats_t rate;
+    rate_limit_get_stats(&rate);
+    printf("rate limit:");
+    for (int i = 0; i < RATE_LIMIT_SERVICE_COUNT; i++) {
+        printf(" %s=%u/%u", rate_limit_service_name(i), (unsigned)rate.dropped[i],
+            (unsigned)(rate.allowed[i] + rate.dropped[i]));
+    }
+    printf(" dropped (evictions=%u)\n", (unsigned)rate.evictions);
+    // Os clientes simulados usam o mesmo lwIP: os picos contam os dois lados
+    const tcp_states_stats_t *tcp = tcp_states_get();
+    printf("tcp:\n  server closes:");
+    for (int k = 0; k < TCP_CLOSE_COUNT; k++) {
+        printf(" %s=%u", tcp_close_kind_name(k), (unsigned)tcp->closes[k]);
+    }
+    printf("\n  pcbs max:");
+    for (int i = 0; i < TCP_STATE_COUNT; i++) {
+        if (tcp->peak[i]) {
+            printf(" %s=%u", tcp_state_label(i), (unsigned)tcp->peak[i]);
+        }
+    }
+    printf("\n");
+
+    hal_host_counters_t hc;
+    hal_host_get_counters(&hc);
+    printf("hal: gpio_writes=%u pwm_writes=%u i2c_transactions=%u i2c_bytes=%llu\n",
+        hc.gpio_writes, hc.pwm_writes, hc.i2c_transactions, (unsigned long long)hc.i2c_bytes);
+    host_display_report();
+    latency_print();
+    loop_profile_print();
+    host_stats_print_json(stdout);
+
+    sim_series_free(&sim.toggle_interval_us);
+    sim_series_free(&sim.beep_on_us);
+    sim_series_free(&sim.dhcp_latency_us);
+    sim_series_free(&sim.http_latency_us);
+}
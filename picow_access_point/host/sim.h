@@ -0,0 +1,48 @@
+/**
+ * Simulador de eventos discretos do build host.
+ *
+ * Roda o firmware inteiro em tempo virtual (ver vclock.h) contra uma
+ * população de clientes simulados na interface de loopback do lwIP:
+ * ciclos de armar/desarmar o alarme, tráfego HTTP e rotatividade de clientes
+ * DHCP. Ao final, imprime o jitter do pisca/bipe, a rotatividade das
+ * concessões DHCP e os percentis de latência das requisições.
+ *
+ * Configuração por variáveis de ambiente (tempos em ms):
+ *   PICOW_SIM_SECONDS        duração simulada (padrão 3600)
+ *   PICOW_SIM_SEED           semente do gerador pseudoaleatório (padrão 1)
+ *   PICOW_SIM_HTTP_CLIENTS   clientes HTTP simultâneos (padrão 4)
+ *   PICOW_SIM_HTTP_MEAN_MS   intervalo médio entre requisições de um cliente (padrão 5000)
+ *   PICOW_SIM_ARM_PERIOD_MS  período do ciclo armar/desarmar (padrão 60000)
+ *   PICOW_SIM_ARMED_MS       tempo armado em cada ciclo (padrão 20000)
+ *   PICOW_SIM_DHCP_ARRIVAL_MS intervalo médio entre chegadas de clientes DHCP (padrão 60000)
+ *   PICOW_SIM_DHCP_STAY_MS   permanência média de um cliente DHCP (padrão 600000)
+ *   PICOW_SIM_LORIS_CLIENTS  atacantes slow-loris simultâneos (padrão 0)
+ *   PICOW_SIM_LORIS_BYTE_MS  intervalo entre os bytes de cada atacante (padrão 1000)
+ *   PICOW_SIM_DHCP_FLOOD_PER_S DISCOVERs por segundo de um cliente DHCP com defeito (padrão 0)
+ *   PICOW_SIM_METRICS_MS     intervalo entre coletas de /metrics (padrão 0, sem coletas)
+ *   PICOW_SIM_HTTP_FAIL_EVERY uma em N escritas do servidor HTTP falha com
+ *                            ERR_CONN, e o handler termina em HTTP_ERROR
+ *                            (padrão 0, nenhuma; o link usa --wrap=tcp_write)
+ */
+#ifndef _SIM_H_
+#define _SIM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Série de amostras para cálculo de percentis
+typedef struct {
+    uint32_t *v;
+    size_t n;
+    size_t cap;
+} sim_series_t;
+
+void sim_series_add(sim_series_t *s, uint32_t value);
+uint32_t sim_series_percentile(sim_series_t *s, double p);
+void sim_series_free(sim_series_t *s);
+
+// Chamados pelo cyw43_arch do simulador
+void sim_start(void);
+void sim_report(void);
+
+#endif
@@ -0,0 +1,331 @@
+/**
+ * Modelo do SSD1306 (ver ssd1306_model.h).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "ssd1306_model.h"
+
+#define CTRL_CO 0x80
+#define CTRL_DC 0x40
+
+void ssd1306_model_init(ssd1306_model_t *m) {
+    memset(m, 0, sizeof(*m));
+    // Valores de reset do datasheet
+    m->addr_mode = SSD1306_ADDR_PAGE;
+    m->col_end = SSD1306_MODEL_WIDTH - 1;
+    m->page_end = SSD1306_MODEL_PAGES - 1;
+    m->contrast = 0x7f;
+}
+
+void ssd1306_model_set_frame_callback(ssd1306_model_t *m, ssd1306_frame_fn fn, void *arg) {
+    m->on_frame = fn;
+    m->on_frame_arg = arg;
+}
+
+void ssd1306_model_end_frame(ssd1306_model_t *m) {
+    m->stats.frames++;
+    m->stats.frame_transactions = m->cur_transactions;
+    m->stats.frame_bus_bytes = m->cur_bus_bytes;
+    m->cur_transactions = 0;
+    m->cur_bus_bytes = 0;
+    if (m->on_frame) {
+        m->on_frame(m, m->on_frame_arg);
+    }
+}
+
+// Número de argumentos que seguem cada comando
+static uint8_t command_args(uint8_t c) {
+    switch (c) {
+        case 0x20: // modo de endereçamento
+        case 0x81: // contraste
+        case 0x8d: // charge pump
+        case 0xa8: // multiplex
+        case 0xd3: // deslocamento
+        case 0xd5: // clock
+        case 0xd9: // pré-carga
+        case 0xda: // pinos COM
+        case 0xdb: // VCOMH
+            return 1;
+        case 0x21: // janela de colunas
+        case 0x22: // janela de páginas
+        case 0xa3: // área de rolagem vertical
+            return 2;
+        case 0x29: // rolagem vertical e horizontal
+        case 0x2a:
+            return 5;
+        case 0x26: // rolagem horizontal
+        case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void execute_command(ssd1306_model_t *m) {
+    const uint8_t *c = m->cmd;
+    switch (c[0]) {
+        case 0x20:
+            m->addr_mode = (ssd1306_addr_mode_t)(c[1] & 0x03);
+            if (m->addr_mode > SSD1306_ADDR_PAGE) {
+                m->addr_mode = SSD1306_ADDR_PAGE; // 0b11 é inválido
+            }
+            return;
+        case 0x21:
+            m->col_start = m->col = c[1] & 0x7f;
+            m->col_end = c[2] & 0x7f;
+            return;
+        case 0x22:
+            m->page_start = m->page = c[1] & 0x07;
+            m->page_end = c[2] & 0x07;
+            return;
+        case 0x26: case 0x27: case 0x29: case 0x2a:
+            m->scroll_cmd = c[0];
+            memcpy(m->scroll_args, &c[1], command_args(c[0]));
+            return;
+        case 0x2e:
+            m->scroll_active = false;
+            return;
+        case 0x2f:
+            m->scroll_active = true;
+            return;
+        case 0x81:
+            m->contrast = c[1];
+            return;
+        case 0xa0: case 0xa1:
+            m->seg_remap = c[0] & 1;
+            return;
+        case 0xa4: case 0xa5:
+            m->entire_on = c[0] & 1;
+            return;
+        case 0xa6: case 0xa7:
+            m->inverse = c[0] & 1;
+            return;
+        case 0xae: case 0xaf:
+            m->display_on = c[0] & 1;
+            return;
+        case 0xc0: case 0xc8:
+            m->com_remap = (c[0] & 0x08) != 0;
+            return;
+        case 0xd3:
+            m->display_offset = c[1] & 0x3f;
+            return;
+        case 0x8d: case 0xa3: case 0xa8: case 0xd5: case 0xd9: case 0xda: case 0xdb: case 0xe3:
+            // Aceitos, sem efeito no conteúdo exibido
+            return;
+    }
+    if (c[0] >= 0x40 && c[0] <= 0x7f) {
+        m->start_line = c[0] & 0x3f;
+    } else if (c[0] <= 0x0f) {
+        m->col = (m->col & 0xf0) | c[0]; // modo página: nibble baixo da coluna
+    } else if (c[0] >= 0x10 && c[0] <= 0x1f) {
+        m->col = (m->col & 0x0f) | (c[0] & 0x07) << 4;
+    } else if (c[0] >= 0xb0 && c[0] <= 0xb7) {
+        m->page = c[0] & 0x07;
+    } else {
+        m->stats.unknown_commands++;
+    }
+}
+
+static void command_byte(ssd1306_model_t *m, uint8_t b) {
+    m->stats.command_bytes++;
+    if (m->cmd_len == 0) {
+        m->cmd_need = command_args(b);
+    }
+    m->cmd[m->cmd_len++] = b;
+    if (m->cmd_len > m->cmd_need) {
+        execute_command(m);
+        m->cmd_len = 0;
+    }
+}
+
+static void data_byte(ssd1306_model_t *m, uint8_t b) {
+    m->stats.data_bytes++;
+    if (m->scroll_active) {
+        m->stats.writes_while_scrolling++;
+    }
+    m->gddram[m->page & 0x07][m->col & 0x7f] = b;
+
+    switch (m->addr_mode) {
+        case SSD1306_ADDR_HORIZONTAL:
+            if (m->col++ == m->col_end) {
+                m->col = m->col_start;
+                if (m->page++ == m->page_end) {
+                    m->page = m->page_start;
+                    ssd1306_model_end_frame(m);
+                }
+            }
+            break;
+        case SSD1306_ADDR_VERTICAL:
+            if (m->page++ == m->page_end) {
+                m->page = m->page_start;
+                if (m->col++ == m->col_end) {
+                    m->col = m->col_start;
+                    ssd1306_model_end_frame(m);
+                }
+            }
+            break;
+        case SSD1306_ADDR_PAGE:
+            // No modo página a coluna volta ao início sem mudar de página
+            m->col = (m->col + 1) & 0x7f;
+            break;
+    }
+}
+
+int ssd1306_model_write(ssd1306_model_t *m, const uint8_t *src, size_t len) {
+    m->stats.transactions++;
+    m->stats.bus_bytes += len + 1;
+    m->cur_transactions++;
+    m->cur_bus_bytes += len + 1;
+
+    size_t i = 0;
+    while (i < len) {
+        uint8_t ctrl = src[i++];
+        bool data = ctrl & CTRL_DC;
+        if (ctrl & CTRL_CO) {
+            // Co = 1: um único byte e depois outro byte de controle
+            if (i < len) {
+                if (data) {
+                    data_byte(m, src[i]);
+                } else {
+                    command_byte(m, src[i]);
+                }
+                i++;
+            }
+        } else {
+            // Co = 0: o resto da transação é todo do mesmo tipo
+            for (; i < len; i++) {
+                if (data) {
+                    data_byte(m, src[i]);
+                } else {
+                    command_byte(m, src[i]);
+                }
+            }
+        }
+    }
+    return (int)len;
+}
+
+bool ssd1306_model_ram_pixel(const ssd1306_model_t *m, int x, int y) {
+    return (m->gddram[y / 8][x] >> (y % 8)) & 1;
+}
+
+bool ssd1306_model_pixel(const ssd1306_model_t *m, int x, int y) {
+    if (!m->display_on) {
+        return false;
+    }
+    if (m->entire_on) {
+        return true;
+    }
+    // Os módulos comuns são montados para que A1/C8 (usados no ssd1306_init)
+    // mostrem a imagem na orientação normal
+    int col = m->seg_remap ? x : SSD1306_MODEL_WIDTH - 1 - x;
+    int row = m->com_remap ? y : SSD1306_MODEL_HEIGHT - 1 - y;
+    row = (row + m->start_line + m->display_offset) % SSD1306_MODEL_HEIGHT;
+    return ssd1306_model_ram_pixel(m, col, row) != m->inverse;
+}
+
+bool ssd1306_model_write_pbm(const ssd1306_model_t *m, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    fprintf(f, "P4\n%d %d\n", SSD1306_MODEL_WIDTH, SSD1306_MODEL_HEIGHT);
+    for (int y = 0; y < SSD1306_MODEL_HEIGHT; y++) {
+        uint8_t row[SSD1306_MODEL_WIDTH / 8] = { 0 };
+        for (int x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            if (ssd1306_model_pixel(m, x, y)) {
+                row[x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+        fwrite(row, 1, sizeof(row), f);
+    }
+    return fclose(f) == 0;
+}
+
+// =============================================
+// PNG sem dependências: deflate com blocos não comprimidos
+// =============================================
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t *buf, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xedb88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void png_chunk(FILE *f, const char *type, const uint8_t *data, uint32_t len) {
+    uint8_t hdr[8];
+    put_u32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    fwrite(hdr, 1, 8, f);
+    fwrite(data, 1, len, f);
+    uint32_t crc = crc32_update(crc32_update(0, (const uint8_t *)type, 4), data, len);
+    uint8_t tail[4];
+    put_u32(tail, crc);
+    fwrite(tail, 1, 4, f);
+}
+
+bool ssd1306_model_write_png(const ssd1306_model_t *m, const char *path) {
+    enum { ROW = 1 + SSD1306_MODEL_WIDTH / 8, RAW = ROW * SSD1306_MODEL_HEIGHT };
+    uint8_t raw[RAW];
+    for (int y = 0; y < SSD1306_MODEL_HEIGHT; y++) {
+        uint8_t *row = &raw[y * ROW];
+        memset(row, 0, ROW); // filtro 0 (nenhum)
+        for (int x = 0; x < SSD1306_MODEL_WIDTH; x++) {
+            if (ssd1306_model_pixel(m, x, y)) {
+                row[1 + x / 8] |= 0x80 >> (x % 8);
+            }
+        }
+    }
+
+    // zlib: cabeçalho, um bloco armazenado (RAW < 65535) e Adler-32
+    uint8_t z[2 + 5 + RAW + 4];
+    size_t n = 0;
+    z[n++] = 0x78;
+    z[n++] = 0x01;
+    z[n++] = 0x01; // BFINAL, não comprimido
+    z[n++] = RAW & 0xff;
+    z[n++] = RAW >> 8;
+    z[n++] = ~RAW & 0xff;
+    z[n++] = (~RAW >> 8) & 0xff;
+    memcpy(&z[n], raw, RAW);
+    n += RAW;
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < RAW; i++) {
+        a = (a + raw[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32(&z[n], b << 16 | a);
+    n += 4;
+
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return false;
+    }
+    static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    fwrite(sig, 1, sizeof(sig), f);
+    uint8_t ihdr[13];
+    put_u32(&ihdr[0], SSD1306_MODEL_WIDTH);
+    put_u32(&ihdr[4], SSD1306_MODEL_HEIGHT);
+    ihdr[8] = 1;  // 1 bit por pixel
+    ihdr[9] = 0;  // tons de cinza
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+    png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+    png_chunk(f, "IDAT", z, (uint32_t)n);
+    png_chunk(f, "IEND", NULL, 0);
+    return fclose(f) == 0;
+}
@@ -0,0 +1,100 @@
+/**
+ * Modelo em software do controlador SSD1306 para o build host.
+ *
+ * Decodifica o fluxo de bytes I2C como o chip faria: bytes de controle
+ * (Co e D/C#), comandos com seus argumentos, modo de endereçamento,
+ * janelas de coluna/página, modo página e comandos de rolagem. Mantém a
+ * GDDRAM (128 colunas x 8 páginas), exporta quadros em PBM/PNG e conta os
+ * bytes e transações do barramento gastos em cada quadro.
+ *
+ * Um quadro termina quando a escrita de dados percorre a janela de
+ * endereços inteira e volta ao início (modos horizontal/vertical), ou
+ * quando ssd1306_model_end_frame() é chamada.
+ */
+#ifndef _SSD1306_MODEL_H_
+#define _SSD1306_MODEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SSD1306_MODEL_WIDTH 128
+#define SSD1306_MODEL_HEIGHT 64
+#define SSD1306_MODEL_PAGES (SSD1306_MODEL_HEIGHT / 8)
+
+typedef enum {
+    SSD1306_ADDR_HORIZONTAL = 0,
+    SSD1306_ADDR_VERTICAL = 1,
+    SSD1306_ADDR_PAGE = 2,
+} ssd1306_addr_mode_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t transactions;      // total desde o início
+    uint64_t bus_bytes;         // inclui o byte de endereço de cada transação
+    uint64_t data_bytes;
+    uint64_t command_bytes;
+    uint32_t frame_transactions; // do último quadro completo
+    uint32_t frame_bus_bytes;
+    uint32_t unknown_commands;
+    uint32_t writes_while_scrolling; // escrever na RAM com rolagem ativa é indefinido no chip
+} ssd1306_model_stats_t;
+
+typedef struct ssd1306_model ssd1306_model_t;
+
+typedef void (*ssd1306_frame_fn)(const ssd1306_model_t *m, void *arg);
+
+struct ssd1306_model {
+    uint8_t gddram[SSD1306_MODEL_PAGES][SSD1306_MODEL_WIDTH];
+
+    // Endereçamento
+    ssd1306_addr_mode_t addr_mode;
+    uint8_t col_start, col_end, col;
+    uint8_t page_start, page_end, page;
+
+    // Estado do painel
+    bool display_on;
+    bool inverse;
+    bool entire_on;
+    bool seg_remap;
+    bool com_remap;
+    uint8_t start_line;
+    uint8_t display_offset;
+    uint8_t contrast;
+
+    // Rolagem
+    bool scroll_active;
+    uint8_t scroll_cmd;
+    uint8_t scroll_args[6];
+
+    // Decodificação de comando em andamento
+    uint8_t cmd[7];
+    uint8_t cmd_len;
+    uint8_t cmd_need;
+
+    // Contagem do quadro em andamento
+    uint32_t cur_transactions;
+    uint32_t cur_bus_bytes;
+
+    ssd1306_model_stats_t stats;
+    ssd1306_frame_fn on_frame;
+    void *on_frame_arg;
+};
+
+void ssd1306_model_init(ssd1306_model_t *m);
+void ssd1306_model_set_frame_callback(ssd1306_model_t *m, ssd1306_frame_fn fn, void *arg);
+
+// Uma transação I2C completa (sem o byte de endereço); retorna len ou -1
+int ssd1306_model_write(ssd1306_model_t *m, const uint8_t *src, size_t len);
+void ssd1306_model_end_frame(ssd1306_model_t *m);
+
+// Pixel da GDDRAM em coordenadas de memória (coluna, página * 8 + bit)
+bool ssd1306_model_ram_pixel(const ssd1306_model_t *m, int x, int y);
+// Pixel como aparece no painel, com remapeamentos, deslocamentos e inversão
+bool ssd1306_model_pixel(const ssd1306_model_t *m, int x, int y);
+
+// Exporta o que aparece no painel; pixel aceso = preto no PBM e branco no PNG
+bool ssd1306_model_write_pbm(const ssd1306_model_t *m, const char *path);
+bool ssd1306_model_write_png(const ssd1306_model_t *m, const char *path);
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * netif do lwIP sobre uma interface tap do Linux (ver tap_netif.h).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+#include "lwip/etharp.h"
+#include "lwip/pbuf.h"
+#include "tap_netif.h"
+#include "cyw43_config.h"
+
+#define TAP_DEFAULT_NAME "tap0"
+#define TAP_FRAME_MAX 1518
+
+static int tap_fd = -1;
+
+static err_t tap_linkoutput(struct netif *netif, struct pbuf *p) {
+    (void)netif;
+    uint8_t frame[TAP_FRAME_MAX];
+    u16_t len = pbuf_copy_partial(p, frame, sizeof(frame), 0);
+    if (write(tap_fd, frame, len) != len) {
+        return ERR_IF;
+    }
+    return ERR_OK;
+}
+
+static err_t tap_netif_init(struct netif *netif) {
+    static const uint8_t mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x43, 0x01 };
+    netif->name[0] = 'a';
+    netif->name[1] = 'p';
+    netif->output = etharp_output;
+    netif->linkoutput = tap_linkoutput;
+    netif->mtu = 1500;
+    netif->hwaddr_len = sizeof(mac);
+    memcpy(netif->hwaddr, mac, sizeof(mac));
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET;
+    return ERR_OK;
+}
+
+static int tap_open(const char *name) {
+    int fd = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        perror("open /dev/net/tun");
+        return -1;
+    }
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+    strncpy(ifr.ifr_name, name, IFNAMSIZ - 1);
+    if (ioctl(fd, TUNSETIFF, &ifr) < 0) {
+        perror("TUNSETIFF");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool tap_netif_open(struct netif *netif, netif_input_fn input, const char *ssid) {
+    const char *name = getenv("PICOW_TAP");
+    tap_fd = tap_open(name ? name : TAP_DEFAULT_NAME);
+    if (tap_fd < 0) {
+        printf("failed to open tap interface\n");
+        return false;
+    }
+
+    ip4_addr_t ip, mask, gw;
+    ip4_addr_set_u32(&ip, PP_HTONL(CYW43_DEFAULT_IP_AP_ADDRESS));
+    ip4_addr_set_u32(&mask, PP_HTONL(LWIP_MAKEU32(255, 255, 255, 0)));
+    ip4_addr_copy(gw, ip);
+    netif_add(netif, &ip, &mask, &gw, NULL, tap_netif_init, input);
+    netif_set_default(netif);
+    netif_set_up(netif);
+    netif_set_link_up(netif);
+    printf("host: AP '%s' on %s, ip %s\n", ssid, name ? name : TAP_DEFAULT_NAME, ip4addr_ntoa(&ip));
+    return true;
+}
+
+void tap_netif_input(struct netif *netif) {
+    uint8_t frame[TAP_FRAME_MAX];
+    ssize_t n;
+    while (tap_fd >= 0 && (n = read(tap_fd, frame, sizeof(frame))) > 0) {
+        struct pbuf *p = pbuf_alloc(PBUF_RAW, (u16_t)n, PBUF_POOL);
+        if (!p) {
+            return;
+        }
+        pbuf_take(p, frame, (u16_t)n);
+        if (netif->input(p, netif) != ERR_OK) {
+            pbuf_free(p);
+        }
+    }
+}
+
+void tap_netif_close(struct netif *netif) {
+    (void)netif;
+    if (tap_fd >= 0) {
+        close(tap_fd);
+        tap_fd = -1;
+    }
+}
+
+int tap_netif_fd(void) {
+    return tap_fd;
+}
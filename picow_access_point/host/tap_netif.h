@@ -0,0 +1,22 @@
+/**
+ * Interface tap do Linux como netif do lwIP, usada pelos builds host em tempo
+ * real (cyw43_arch_host.c e cyw43_arch_freertos.c). Crie a interface antes
+ * de executar (ver cyw43_arch_host.c); a variável de ambiente PICOW_TAP
+ * escolhe outra que não a tap0.
+ */
+#ifndef _TAP_NETIF_H_
+#define _TAP_NETIF_H_
+
+#include <stdbool.h>
+#include "lwip/netif.h"
+
+// Abre a tap e adiciona netif com o endereço do AP; input é ethernet_input
+// (NO_SYS=1) ou tcpip_input (NO_SYS=0). Precisa da trava do lwIP com NO_SYS=0.
+bool tap_netif_open(struct netif *netif, netif_input_fn input, const char *ssid);
+// Entrega ao lwIP os quadros pendentes, sem bloquear
+void tap_netif_input(struct netif *netif);
+void tap_netif_close(struct netif *netif);
+// Descritor para poll(), -1 se a tap não estiver aberta
+int tap_netif_fd(void);
+
+#endif
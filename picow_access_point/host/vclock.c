@@ -0,0 +1,132 @@
+/**
+ * Fonte de tempo real/virtual do build host, com fila de eventos (heap
+ * binário ordenado por tempo e, no empate, por ordem de agendamento).
+ */
+#include <stdio.h>
+#include <time.h>
+
+#include "vclock.h"
+
+typedef struct {
+    uint64_t time_us;
+    uint64_t seq;
+    vclock_event_fn fn;
+    void *arg;
+} vclock_event_t;
+
+static struct {
+    bool virtual_mode;
+    uint64_t start_ns;
+    uint64_t now_us;
+    uint64_t seq;
+    vclock_event_t heap[VCLOCK_MAX_EVENTS];
+    int count;
+} vc;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void vclock_set_virtual(uint64_t start_us) {
+    vc.virtual_mode = true;
+    vc.now_us = start_us;
+}
+
+bool vclock_is_virtual(void) {
+    return vc.virtual_mode;
+}
+
+uint64_t vclock_now_us(void) {
+    if (vc.virtual_mode) {
+        return vc.now_us;
+    }
+    if (vc.start_ns == 0) {
+        vc.start_ns = monotonic_ns();
+    }
+    return (monotonic_ns() - vc.start_ns) / 1000;
+}
+
+uint64_t vclock_cost_us(void) {
+    if (!vc.virtual_mode) {
+        return vclock_now_us();
+    }
+    if (vc.start_ns == 0) {
+        vc.start_ns = monotonic_ns();
+    }
+    return vc.now_us + (monotonic_ns() - vc.start_ns) / 1000;
+}
+
+void vclock_advance_to(uint64_t t_us) {
+    if (vc.virtual_mode && t_us > vc.now_us) {
+        vc.now_us = t_us;
+    }
+}
+
+void vclock_advance_us(uint64_t us) {
+    vclock_advance_to(vc.now_us + us);
+}
+
+static bool event_before(const vclock_event_t *a, const vclock_event_t *b) {
+    return a->time_us < b->time_us || (a->time_us == b->time_us && a->seq < b->seq);
+}
+
+static void heap_swap(int i, int j) {
+    vclock_event_t t = vc.heap[i];
+    vc.heap[i] = vc.heap[j];
+    vc.heap[j] = t;
+}
+
+bool vclock_schedule_at(uint64_t t_us, vclock_event_fn fn, void *arg) {
+    if (vc.count == VCLOCK_MAX_EVENTS) {
+        printf("vclock: event queue full\n");
+        return false;
+    }
+    int i = vc.count++;
+    vc.heap[i] = (vclock_event_t){ .time_us = t_us, .seq = vc.seq++, .fn = fn, .arg = arg };
+    while (i > 0 && event_before(&vc.heap[i], &vc.heap[(i - 1) / 2])) {
+        heap_swap(i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    return true;
+}
+
+bool vclock_schedule_in(uint64_t delay_us, vclock_event_fn fn, void *arg) {
+    return vclock_schedule_at(vclock_now_us() + delay_us, fn, arg);
+}
+
+uint64_t vclock_next_event_us(void) {
+    return vc.count ? vc.heap[0].time_us : VCLOCK_NEVER;
+}
+
+static vclock_event_t heap_pop(void) {
+    vclock_event_t top = vc.heap[0];
+    vc.heap[0] = vc.heap[--vc.count];
+    int i = 0;
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < vc.count && event_before(&vc.heap[l], &vc.heap[m])) {
+            m = l;
+        }
+        if (r < vc.count && event_before(&vc.heap[r], &vc.heap[m])) {
+            m = r;
+        }
+        if (m == i) {
+            break;
+        }
+        heap_swap(i, m);
+        i = m;
+    }
+    return top;
+}
+
+int vclock_run_due(void) {
+    int n = 0;
+    while (vc.count && vc.heap[0].time_us <= vclock_now_us()) {
+        vclock_event_t ev = heap_pop();
+        ev.fn(ev.arg);
+        n++;
+    }
+    return n;
+}
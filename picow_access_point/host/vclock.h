@@ -0,0 +1,47 @@
+/**
+ * Fonte de tempo do build host.
+ *
+ * No modo real o tempo vem do relógio monotônico do Linux. No modo virtual o
+ * tempo só anda quando alguém o avança (simulador, custo simulado do barramento
+ * I2C) e eventos agendados são executados em ordem de tempo, o que torna
+ * reproduzíveis os testes de latência e jitter.
+ *
+ * Todo o firmware enxerga o tempo por aqui: get_absolute_time() e
+ * time_us_64() (update_alarm), cyw43_hal_ticks_ms() (validade das concessões
+ * DHCP) e sys_now() (timers do lwIP, incluindo o tcp_poll).
+ */
+#ifndef _VCLOCK_H_
+#define _VCLOCK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define VCLOCK_MAX_EVENTS 1024
+#define VCLOCK_NEVER UINT64_MAX
+
+typedef void (*vclock_event_fn)(void *arg);
+
+// Passa para o modo virtual; a partir daqui o tempo começa em start_us
+void vclock_set_virtual(uint64_t start_us);
+bool vclock_is_virtual(void);
+
+uint64_t vclock_now_us(void);
+// Para medir custo: no modo virtual soma ao tempo virtual o tempo real
+// decorrido, assim trechos só de CPU não medem zero
+uint64_t vclock_cost_us(void);
+
+// Só têm efeito no modo virtual; o tempo nunca volta
+void vclock_advance_us(uint64_t us);
+void vclock_advance_to(uint64_t t_us);
+
+// Agenda fn(arg) para o instante t_us; retorna false se a fila estiver cheia
+bool vclock_schedule_at(uint64_t t_us, vclock_event_fn fn, void *arg);
+bool vclock_schedule_in(uint64_t delay_us, vclock_event_fn fn, void *arg);
+
+// Instante do próximo evento, ou VCLOCK_NEVER
+uint64_t vclock_next_event_us(void);
+
+// Executa os eventos vencidos (incluindo os agendados por eles) e retorna quantos
+int vclock_run_due(void);
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * Arena de rascunho por requisição HTTP (ver http_arena.h).
+ */
+#include "http_arena.h"
+
+static http_arena_stats_t stats = { .size = HTTP_ARENA_SIZE };
+
+void http_arena_init(http_arena_t *a, void *buf, size_t cap) {
+    a->buf = buf;
+    a->cap = (uint16_t)(cap > UINT16_MAX ? UINT16_MAX : cap);
+    a->used = 0;
+    a->peak = 0;
+    a->open = false;
+}
+
+void http_arena_begin(http_arena_t *a) {
+    a->used = 0;
+    a->peak = 0;
+    a->open = true;
+}
+
+void *http_arena_alloc(http_arena_t *a, size_t size) {
+    size_t need = (size + HTTP_ARENA_ALIGN - 1) & ~(size_t)(HTTP_ARENA_ALIGN - 1);
+    if (!a->open || need > (size_t)(a->cap - a->used)) {
+        stats.failures++;
+        return NULL;
+    }
+    void *p = a->buf + a->used;
+    a->used += (uint16_t)need;
+    if (a->used > a->peak) {
+        a->peak = a->used;
+    }
+    return p;
+}
+
+void http_arena_release(http_arena_t *a) {
+    if (!a->open) {
+        return;
+    }
+    a->open = false;
+    stats.requests++;
+    stats.peak_sum += a->peak;
+    if (a->peak > stats.peak) {
+        stats.peak = a->peak;
+    }
+    int b = a->peak ? (a->peak - 1) / (HTTP_ARENA_SIZE / HTTP_ARENA_BUCKETS) : 0;
+    stats.buckets[b < HTTP_ARENA_BUCKETS ? b : HTTP_ARENA_BUCKETS - 1]++;
+    a->used = 0;
+    a->peak = 0;
+}
+
+void http_arena_get_stats(http_arena_stats_t *out) {
+    *out = stats;
+}
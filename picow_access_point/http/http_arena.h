@@ -0,0 +1,92 @@
+/**
+ * Arena de rascunho por requisição HTTP.
+ *
+ * Os handlers precisam de memória temporária (tokens de JSON, valores
+ * decodificados, cópias de headers) que só vale até o fim da requisição.
+ * No build com MEM_LIBC_MALLOC o malloc é o mesmo heap do lwIP, e blocos
+ * pequenos de vida curta o fragmentam. Cada conexão traz no próprio estado
+ * (alocado uma vez no accept) um buffer de HTTP_ARENA_SIZE bytes, e
+ * http_arena_alloc() só avança um ponteiro: não há free por bloco.
+ *
+ * http_arena_mark() e http_arena_reset() devolvem de uma vez tudo o que foi
+ * alocado depois da marca (o rascunho de uma etapa do handler), e
+ * http_arena_release(), no fim da requisição, zera a arena em O(1) e
+ * registra o pico de uso dela no histograma de http_arena_get_stats(), para
+ * dimensionar HTTP_ARENA_SIZE com o tráfego real (/metrics). Os ponteiros
+ * não sobrevivem a um reset ou ao fim da requisição. Só é usada no contexto
+ * do lwIP, então não há trava.
+ */
+#ifndef _HTTP_ARENA_H_
+#define _HTTP_ARENA_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes por conexão
+#ifndef HTTP_ARENA_SIZE
+#define HTTP_ARENA_SIZE 256
+#endif
+
+// Alinhamento de cada alocação (e do buffer)
+#define HTTP_ARENA_ALIGN 8
+
+// Baldes do histograma do pico por requisição, cada um com
+// HTTP_ARENA_SIZE / HTTP_ARENA_BUCKETS bytes
+#define HTTP_ARENA_BUCKETS 8
+
+_Static_assert(HTTP_ARENA_SIZE % HTTP_ARENA_ALIGN == 0 && HTTP_ARENA_SIZE <= UINT16_MAX,
+               "HTTP_ARENA_SIZE inválido");
+
+typedef struct {
+    uint8_t *buf;
+    uint16_t cap;
+    uint16_t used;
+    uint16_t peak;          // Maior used desde o início da requisição
+    bool open;              // Requisição em andamento (entre begin e release)
+} http_arena_t;
+
+typedef uint16_t http_arena_mark_t;
+
+typedef struct {
+    uint32_t requests;                      // Requisições que passaram pela arena
+    uint32_t failures;                      // Alocações recusadas por falta de espaço
+    uint16_t size;                          // HTTP_ARENA_SIZE
+    uint16_t peak;                          // Maior pico de uma requisição
+    uint32_t peak_sum;                      // Soma dos picos (média = peak_sum / requests)
+    uint32_t buckets[HTTP_ARENA_BUCKETS];   // Requisições por faixa de pico
+} http_arena_stats_t;
+
+// buf precisa estar alinhado a HTTP_ARENA_ALIGN e durar tanto quanto a
+// arena; a arena começa fechada
+void http_arena_init(http_arena_t *a, void *buf, size_t cap);
+
+// Início de uma requisição: arena vazia
+void http_arena_begin(http_arena_t *a);
+
+// size bytes alinhados, NULL (e uma falha contada) se não couberem
+void *http_arena_alloc(http_arena_t *a, size_t size);
+
+static inline http_arena_mark_t http_arena_mark(const http_arena_t *a) {
+    return a->used;
+}
+
+// Libera tudo o que foi alocado depois de mark
+static inline void http_arena_reset(http_arena_t *a, http_arena_mark_t mark) {
+    if (mark < a->used) {
+        a->used = mark;
+    }
+}
+
+// Fim da requisição: registra o pico e esvazia a arena; sem efeito se ela
+// não estiver aberta
+void http_arena_release(http_arena_t *a);
+
+// Limite superior (inclusive) do balde b, em bytes
+static inline uint32_t http_arena_bucket_le(int b) {
+    return (uint32_t)(b + 1) * (HTTP_ARENA_SIZE / HTTP_ARENA_BUCKETS);
+}
+
+void http_arena_get_stats(http_arena_stats_t *stats);
+
+#endif
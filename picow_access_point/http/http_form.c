@@ -0,0 +1,156 @@
+/**
+ * Decodificador de formulários (ver http_form.h).
+ */
+#include <string.h>
+
+#include "http_form.h"
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;  // minúscula
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+void http_form_iter_init(http_form_iter_t *it, char *str) {
+    it->p = str ? str : "";
+}
+
+bool http_form_next(http_form_iter_t *it, http_param_t *param) {
+    char *r = it->p;
+    while (*r == '&') {
+        r++;
+    }
+    if (!*r) {
+        it->p = r;
+        return false;
+    }
+
+    // A escrita (w) nunca passa a leitura (r): decodificar só encurta
+    char *w = r;
+    param->key = w;
+    param->value = NULL;
+    for (char c = *r; c && c != '&'; c = *r) {
+        r++;
+        if (c == '=' && !param->value) {
+            *w++ = 0;
+            param->value = w;
+            continue;
+        }
+        if (c == '+') {
+            c = ' ';
+        } else if (c == '%') {
+            int hi = hex_value(r[0]);
+            int lo = hi < 0 ? -1 : hex_value(r[1]);
+            if (lo >= 0 && (hi | lo)) {
+                c = (char)(hi << 4 | lo);
+                r += 2;
+            }
+        }
+        *w++ = c;
+    }
+    it->p = *r ? r + 1 : r;
+    *w = 0;
+    if (!param->value) {
+        param->value = w;
+    }
+    return true;
+}
+
+size_t http_form_parse(char *str, http_param_t *params, size_t max) {
+    http_form_iter_t it;
+    http_form_iter_init(&it, str);
+    size_t n = 0;
+    while (n < max && http_form_next(&it, &params[n])) {
+        n++;
+    }
+    return n;
+}
+
+bool http_parse_int(const char *s, int32_t min, int32_t max, int32_t *out) {
+    bool negative = *s == '-';
+    if (*s == '-' || *s == '+') {
+        s++;
+    }
+    if (!*s) {
+        return false;
+    }
+    int64_t v = 0;
+    for (; *s; s++) {
+        if (*s < '0' || *s > '9') {
+            return false;
+        }
+        v = v * 10 + (*s - '0');
+        if (v > (int64_t)INT32_MAX + 1) {
+            return false;
+        }
+    }
+    if (negative) {
+        v = -v;
+    }
+    if (v < min || v > max) {
+        return false;
+    }
+    *out = (int32_t)v;
+    return true;
+}
+
+bool http_parse_bool(const char *s, bool *out) {
+    static const char *const truthy[] = { "1", "true", "on", "yes" };
+    static const char *const falsy[] = { "0", "false", "off", "no" };
+    for (size_t i = 0; i < sizeof(truthy) / sizeof(truthy[0]); i++) {
+        if (strcmp(s, truthy[i]) == 0) {
+            *out = true;
+            return true;
+        }
+        if (strcmp(s, falsy[i]) == 0) {
+            *out = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool http_parse_enum(const char *s, const char *const names[], size_t count, int *out) {
+    for (size_t i = 0; i < count; i++) {
+        if (names[i] && strcmp(s, names[i]) == 0) {
+            *out = (int)i;
+            return true;
+        }
+    }
+    int32_t index;
+    if (count && http_parse_int(s, 0, (int32_t)count - 1, &index)) {
+        *out = index;
+        return true;
+    }
+    return false;
+}
+
+const char *http_param_get(const http_param_t *params, size_t n, const char *key) {
+    for (size_t i = 0; i < n; i++) {
+        if (strcmp(params[i].key, key) == 0) {
+            return params[i].value;
+        }
+    }
+    return NULL;
+}
+
+bool http_param_int(const http_param_t *params, size_t n, const char *key, int32_t min, int32_t max, int32_t *out) {
+    const char *value = http_param_get(params, n, key);
+    return value && http_parse_int(value, min, max, out);
+}
+
+bool http_param_bool(const http_param_t *params, size_t n, const char *key, bool *out) {
+    const char *value = http_param_get(params, n, key);
+    return value && http_parse_bool(value, out);
+}
+
+bool http_param_enum(const http_param_t *params, size_t n, const char *key,
+                     const char *const names[], size_t count, int *out) {
+    const char *value = http_param_get(params, n, key);
+    return value && http_parse_enum(value, names, count, out);
+}
@@ -0,0 +1,50 @@
+/**
+ * Decodificador de query string e de corpos application/x-www-form-urlencoded,
+ * sem alocação e sem a família scanf.
+ *
+ * A decodificação é feita no próprio buffer: cada par "chave=valor" vira duas
+ * strings terminadas em zero apontando para dentro dele, com '+' trocado por
+ * espaço e "%XX" decodificado. Um "%" inválido (ou "%00") fica como está.
+ * Pares vazios ("a=1&&b=2") são pulados; uma chave sem '=' tem valor "".
+ */
+#ifndef _HTTP_FORM_H_
+#define _HTTP_FORM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Pares guardados por http_form_parse() nos handlers; o resto é ignorado
+#define HTTP_FORM_MAX_PARAMS 8
+
+typedef struct {
+    char *key;
+    char *value;
+} http_param_t;
+
+typedef struct {
+    char *p;                // Próximo par ainda não decodificado
+} http_form_iter_t;
+
+// str é alterada pela decodificação; NULL equivale a uma query vazia
+void http_form_iter_init(http_form_iter_t *it, char *str);
+bool http_form_next(http_form_iter_t *it, http_param_t *param);
+
+// Decodifica todos os pares de str (até max); retorna quantos foram guardados
+size_t http_form_parse(char *str, http_param_t *params, size_t max);
+
+// Conversões estritas: a string inteira precisa casar
+bool http_parse_int(const char *s, int32_t min, int32_t max, int32_t *out);
+// 1/0, true/false, on/off (checkbox HTML), yes/no
+bool http_parse_bool(const char *s, bool *out);
+// Nome em names[] ou o próprio índice em decimal
+bool http_parse_enum(const char *s, const char *const names[], size_t count, int *out);
+
+// Valor da primeira ocorrência de key, ou NULL
+const char *http_param_get(const http_param_t *params, size_t n, const char *key);
+bool http_param_int(const http_param_t *params, size_t n, const char *key, int32_t min, int32_t max, int32_t *out);
+bool http_param_bool(const http_param_t *params, size_t n, const char *key, bool *out);
+bool http_param_enum(const http_param_t *params, size_t n, const char *key,
+                     const char *const names[], size_t count, int *out);
+
+#endif
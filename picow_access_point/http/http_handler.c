@@ -0,0 +1,120 @@
+/**
+ * Suporte aos handlers HTTP em corrotina (ver http_handler.h).
+ */
+#include <stddef.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "http_handler.h"
+
+void http_ctx_start(http_ctx_t *ctx, struct tcp_pcb *pcb, const char *path, char *params) {
+    memset(ctx, 0, offsetof(http_ctx_t, line));
+    ctx->status = HTTP_RUNNING;
+    ctx->pcb = pcb;
+    ctx->path = path;
+    ctx->params = params;
+    http_arena_begin(&ctx->arena);
+}
+
+uint32_t http_write(http_ctx_t *ctx, const char *data, uint32_t len) {
+    uint32_t room = tcp_sndbuf(ctx->pcb);
+    if (len > room) {
+        len = room;
+    }
+    if (len == 0) {
+        return 0;
+    }
+    err_t err = tcp_write(ctx->pcb, data, (u16_t)len, TCP_WRITE_FLAG_COPY);
+    if (err == ERR_MEM) {
+        // Fila de segmentos cheia: tenta de novo no próximo tcp_sent/tcp_poll
+        return 0;
+    }
+    if (err != ERR_OK) {
+        printf("handler write failed %d\n", err);
+        ctx->failed = true;
+        return 0;
+    }
+    ctx->queued += len;
+    return len;
+}
+
+static size_t http_json_sink(void *arg, const char *data, size_t len) {
+    return http_write((http_ctx_t *)arg, data, (uint32_t)len);
+}
+
+uint32_t http_json_length(http_ctx_t *ctx, http_json_fn fn) {
+    json_writer_t w;
+    json_writer_init(&w, NULL, NULL, 0);
+    fn(ctx, &w);
+    return w.pos;
+}
+
+bool http_json_write(http_ctx_t *ctx, http_json_fn fn) {
+    json_writer_t w;
+    json_writer_init(&w, http_json_sink, ctx, ctx->off);
+    fn(ctx, &w);
+    json_writer_flush(&w);
+    ctx->off = w.sent;
+    return json_writer_done(&w) && !ctx->failed;
+}
+
+uint32_t http_tmpl_length(http_ctx_t *ctx, const http_template_t *t, http_tmpl_args_fn fn) {
+    http_tmpl_arg_t args[HTTP_TEMPLATE_MAX_SLOTS];
+    fn(ctx, args);
+    return http_template_length(t, args);
+}
+
+static uint32_t http_tmpl_sink(void *arg, const char *data, uint32_t len) {
+    http_ctx_t *ctx = arg;
+    uint32_t n = http_write(ctx, data, len);
+    return ctx->failed ? 0 : n;
+}
+
+bool http_tmpl_write(http_ctx_t *ctx, const http_template_t *t, http_tmpl_args_fn fn) {
+    http_tmpl_arg_t args[HTTP_TEMPLATE_MAX_SLOTS];
+    fn(ctx, args);
+    return http_template_emit(t, args, &ctx->off, http_tmpl_sink, ctx) && !ctx->failed;
+}
+
+bool http_chunk_write(http_ctx_t *ctx, const char *data, uint32_t len) {
+    if (len == 0) {
+        return true;
+    }
+    // A linha de tamanho só depende de len: refeita a cada retomada
+    char size_line[12];
+    uint32_t size_len = (uint32_t)snprintf(size_line, sizeof(size_line), "%lx\r\n", (unsigned long)len);
+    const struct {
+        const char *data;
+        uint32_t len;
+    } parts[] = { { size_line, size_len }, { data, len }, { "\r\n", 2 } };
+    uint32_t start = 0;
+    for (size_t i = 0; i < count_of(parts); i++) {
+        uint32_t end = start + parts[i].len;
+        if (ctx->off < end) {
+            uint32_t skip = ctx->off - start;
+            uint32_t n = http_write(ctx, parts[i].data + skip, parts[i].len - skip);
+            ctx->off += n;
+            if (ctx->off < end) {
+                return false;
+            }
+        }
+        start = end;
+    }
+    return true;
+}
+
+uint32_t http_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+const char *http_status_name(http_status_t status) {
+    static const char *const names[] = {
+        [HTTP_RUNNING] = "running",
+        [HTTP_WAIT_WRITABLE] = "wait_writable",
+        [HTTP_WAIT_STATE] = "wait_state",
+        [HTTP_WAIT_TIMER] = "wait_timer",
+        [HTTP_DONE] = "done",
+        [HTTP_ERROR] = "error",
+    };
+    return (unsigned)status < count_of(names) ? names[status] : "?";
+}
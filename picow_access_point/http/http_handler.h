@@ -0,0 +1,179 @@
+/**
+ * Handlers HTTP como corrotinas sem pilha (protothreads).
+ *
+ * Um handler é uma função chamada várias vezes para a mesma requisição: entre
+ * HTTP_BEGIN e HTTP_END ele escreve a resposta aos pedaços e, quando precisa
+ * esperar, retorna o motivo. O servidor o retoma a partir dos callbacks do
+ * lwIP: tcp_sent (o cliente confirmou dados, há espaço para escrever) e
+ * tcp_poll (a cada HTTP_HANDLER_POLL ciclos do timer lento do TCP, ~500 ms,
+ * para reavaliar condições e prazos). Assim um contexto pequeno e fixo
+ * serve respostas de qualquer tamanho sem bloquear o laço.
+ *
+ * A retomada usa um switch sobre a linha do último yield (como o pt.h de
+ * Dunkels), com duas consequências: variáveis locais não sobrevivem a um
+ * yield (use ctx->var e ctx->wake_ms) e não cabem dois macros HTTP_* na mesma
+ * linha nem um switch próprio entre HTTP_BEGIN e HTTP_END.
+ */
+#ifndef _HTTP_HANDLER_H_
+#define _HTTP_HANDLER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "lwip/tcp.h"
+#include "json.h"
+#include "http_template.h"
+#include "http_arena.h"
+
+// Buffer de HTTP_PRINTF; uma linha formatada maior é truncada
+#define HTTP_LINE_MAX 256
+
+// Intervalo do tcp_poll enquanto um handler está ativo (unidades de ~500 ms)
+#define HTTP_HANDLER_POLL 1
+
+typedef enum {
+    HTTP_RUNNING,           // Ainda não executado
+    HTTP_WAIT_WRITABLE,     // Buffer de envio cheio: retoma no tcp_sent
+    HTTP_WAIT_STATE,        // Condição do handler: reavaliada no tcp_poll
+    HTTP_WAIT_TIMER,        // Prazo em ctx->wake_ms: reavaliado no tcp_poll
+    HTTP_DONE,              // Resposta completa: fecha após a confirmação
+    HTTP_ERROR,             // Fecha a conexão já
+} http_status_t;
+
+typedef struct {
+    uint16_t lc;            // Ponto de retomada (linha do último yield)
+    uint8_t status;         // http_status_t do último passo
+    bool failed;            // tcp_write falhou
+    bool framed;            // Content-Length enviado: o cliente pode fechar primeiro
+    struct tcp_pcb *pcb;
+    const char *path;
+    char *params;           // Query string, NULL se não houver (http_form.h
+                            // decodifica no lugar)
+    char *body;             // Corpo da requisição terminado em zero, NULL se
+                            // não houver ou se não coube no buffer
+    uint32_t body_len;      // Content-Length, mesmo com body NULL
+    uint32_t queued;        // Bytes aceitos por tcp_write
+    uint32_t off;           // Progresso do HTTP_SEND/HTTP_JSON em andamento
+    uint32_t wake_ms;       // Prazo de HTTP_SLEEP_MS
+    // Linha de status e headers da resposta, para os slots dos templates
+    // (http_template.h); guardados aqui para valer em todas as retomadas
+    uint16_t code;
+    const char *reason;
+    const char *type;       // Content-Type
+    uint32_t length;        // Content-Length
+    uint32_t var[4];        // Estado do handler que precisa sobreviver a yields
+    int line_len;
+    char line[HTTP_LINE_MAX];
+    // Rascunho da requisição (http_arena.h), com o buffer no estado da
+    // conexão; http_ctx_start o esvazia e ele sobrevive a yields
+    http_arena_t arena;
+} http_ctx_t;
+
+typedef http_status_t (*http_handler_fn)(http_ctx_t *ctx);
+
+// Gerador de um documento JSON (json.h) a partir do estado guardado em ctx;
+// precisa produzir os mesmos bytes a cada chamada
+typedef void (*http_json_fn)(http_ctx_t *ctx, json_writer_t *w);
+
+// Preenche os valores dos slots a partir do estado guardado em ctx; precisa
+// dar os mesmos valores a cada chamada
+typedef void (*http_tmpl_args_fn)(http_ctx_t *ctx, http_tmpl_arg_t *args);
+
+// Prepara ctx para uma nova requisição (ctx->arena já iniciada por
+// http_arena_init, e aqui esvaziada); path e params precisam continuar
+// válidos até o fim da resposta
+void http_ctx_start(http_ctx_t *ctx, struct tcp_pcb *pcb, const char *path, char *params);
+
+// Escreve até len bytes (com cópia), limitado pelo espaço no buffer de envio;
+// retorna quantos foram aceitos
+uint32_t http_write(http_ctx_t *ctx, const char *data, uint32_t len);
+
+// Tamanho do documento de fn, para o Content-Length
+uint32_t http_json_length(http_ctx_t *ctx, http_json_fn fn);
+// Gera o documento de fn de novo, pulando os ctx->off bytes já escritos, e
+// escreve o que couber; true quando ele saiu inteiro
+bool http_json_write(http_ctx_t *ctx, http_json_fn fn);
+
+// Tamanho do template t com os valores de fn, para o Content-Length
+uint32_t http_tmpl_length(http_ctx_t *ctx, const http_template_t *t, http_tmpl_args_fn fn);
+// Escreve t a partir do byte ctx->off; true quando ele saiu inteiro
+bool http_tmpl_write(http_ctx_t *ctx, const http_template_t *t, http_tmpl_args_fn fn);
+
+// Escreve um chunk de Transfer-Encoding: chunked (tamanho em hexa, len bytes
+// de data e CRLF) a partir do byte ctx->off do chunk; true quando ele saiu
+// inteiro. len 0 não escreve nada (o chunk vazio é o fim, HTTP_CHUNK_END)
+bool http_chunk_write(http_ctx_t *ctx, const char *data, uint32_t len);
+
+uint32_t http_now_ms(void);
+const char *http_status_name(http_status_t status);
+
+// Prazo em ctx->wake_ms vencido (comparação com wraparound)
+static inline bool http_deadline_passed(const http_ctx_t *ctx) {
+    return (int32_t)(http_now_ms() - ctx->wake_ms) >= 0;
+}
+
+#define HTTP_BEGIN(ctx) switch ((ctx)->lc) { case 0:
+
+#define HTTP_END(ctx) } (ctx)->lc = 0; return HTTP_DONE
+
+// Cede com o status dado até a próxima retomada
+#define HTTP_YIELD(ctx, why) \
+    do { (ctx)->lc = __LINE__; return (why); case __LINE__:; } while (0)
+
+// Espera até cond ser verdadeira; cond é reavaliada a cada retomada
+#define HTTP_WAIT_UNTIL(ctx, cond, why) \
+    do { (ctx)->lc = __LINE__; case __LINE__: if (!(cond)) return (why); } while (0)
+
+#define HTTP_SLEEP_MS(ctx, ms) \
+    do { (ctx)->wake_ms = http_now_ms() + (ms); (ctx)->lc = __LINE__; case __LINE__: \
+         if (!http_deadline_passed(ctx)) return HTTP_WAIT_TIMER; } while (0)
+
+// Envia len bytes de data, cedendo enquanto o buffer de envio estiver cheio;
+// data precisa continuar válido entre as retomadas
+#define HTTP_SEND(ctx, data, len) \
+    do { (ctx)->off = 0; (ctx)->lc = __LINE__; case __LINE__: \
+         (ctx)->off += http_write((ctx), (const char *)(data) + (ctx)->off, (uint32_t)(len) - (ctx)->off); \
+         if ((ctx)->failed) return HTTP_ERROR; \
+         if ((ctx)->off < (uint32_t)(len)) return HTTP_WAIT_WRITABLE; } while (0)
+
+// Envia o documento JSON de fn direto para o buffer de envio, cedendo
+// enquanto ele estiver cheio
+#define HTTP_JSON(ctx, fn) \
+    do { (ctx)->off = 0; (ctx)->lc = __LINE__; case __LINE__: \
+         if (!http_json_write((ctx), (fn))) { \
+             if ((ctx)->failed) return HTTP_ERROR; \
+             return HTTP_WAIT_WRITABLE; } } while (0)
+
+// Envia o template t (templates/, gerado por tools/gen_templates.py) com os
+// valores de fn, cedendo enquanto o buffer de envio estiver cheio
+#define HTTP_TEMPLATE(ctx, t, fn) \
+    do { (ctx)->off = 0; (ctx)->lc = __LINE__; case __LINE__: \
+         if (!http_tmpl_write((ctx), (t), (fn))) { \
+             if ((ctx)->failed) return HTTP_ERROR; \
+             return HTTP_WAIT_WRITABLE; } } while (0)
+
+// Formata em ctx->line (só na primeira passagem) e envia
+#define HTTP_PRINTF(ctx, ...) \
+    do { (ctx)->line_len = snprintf((ctx)->line, sizeof((ctx)->line), __VA_ARGS__); \
+         if ((ctx)->line_len >= (int)sizeof((ctx)->line)) (ctx)->line_len = sizeof((ctx)->line) - 1; \
+         HTTP_SEND(ctx, (ctx)->line, (ctx)->line_len); } while (0)
+
+// Corpo de tamanho desconhecido: com "Transfer-Encoding: chunked" nos headers
+// cada pedaço vai num chunk e HTTP_CHUNK_END marca o fim, então a resposta
+// pode ter ctx->framed (o cliente fecha primeiro) e qualquer tamanho, gerada
+// aos pedaços em ctx->line. data precisa continuar válido entre as retomadas
+#define HTTP_CHUNK(ctx, data, len) \
+    do { (ctx)->off = 0; (ctx)->lc = __LINE__; case __LINE__: \
+         if (!http_chunk_write((ctx), (const char *)(data), (uint32_t)(len))) { \
+             if ((ctx)->failed) return HTTP_ERROR; \
+             return HTTP_WAIT_WRITABLE; } } while (0)
+
+#define HTTP_CHUNK_PRINTF(ctx, ...) \
+    do { (ctx)->line_len = snprintf((ctx)->line, sizeof((ctx)->line), __VA_ARGS__); \
+         if ((ctx)->line_len >= (int)sizeof((ctx)->line)) (ctx)->line_len = sizeof((ctx)->line) - 1; \
+         HTTP_CHUNK(ctx, (ctx)->line, (ctx)->line_len); } while (0)
+
+// Chunk vazio (sem trailers): fim do corpo
+#define HTTP_CHUNK_END(ctx) HTTP_SEND(ctx, "0\r\n\r\n", 5)
+
+#endif
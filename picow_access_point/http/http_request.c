@@ -0,0 +1,153 @@
+/**
+ * Leitura incremental de requisições HTTP (ver http_request.h).
+ */
+#include <string.h>
+
+#include "http_request.h"
+
+#define CONTENT_LENGTH "content-length:"
+#define IF_NONE_MATCH "if-none-match:"
+#define CL_NO_MATCH 0xFF
+
+static http_request_stats_t stats;
+
+void http_request_init(http_request_t *req, char *buf, size_t cap) {
+    memset(req, 0, sizeof(*req));
+    req->buf = buf;
+    req->cap = (uint16_t)cap;
+    req->phase = HTTP_PHASE_IDLE;
+    req->in_request_line = true;
+    buf[0] = 0;
+}
+
+static void store(http_request_t *req, char c) {
+    if (req->len < req->cap - 1) {
+        req->buf[req->len++] = c;
+        req->buf[req->len] = 0;
+    }
+}
+
+static bool complete(http_request_t *req) {
+    req->phase = HTTP_PHASE_RESPONSE;
+    stats.completed++;
+    return true;
+}
+
+// Avança o casamento (sem diferenciar maiúsculas) do nome de header name;
+// CL_NO_MATCH quando a linha é de outro header
+static uint8_t match_name(uint8_t match, char c, const char *name, size_t len) {
+    if (match >= len) {
+        return match;
+    }
+    char lower = (c >= 'A' && c <= 'Z') ? c | 0x20 : c;
+    return lower == name[match] ? match + 1 : CL_NO_MATCH;
+}
+
+// Um byte do valor do If-None-Match, sem os espaços iniciais
+static void if_none_match_byte(http_request_t *req, char c) {
+    if (c == '\r' || ((c == ' ' || c == '\t') && !req->if_none_match_len)) {
+        return;
+    }
+    if (req->if_none_match_len < sizeof(req->if_none_match) - 1) {
+        req->if_none_match[req->if_none_match_len++] = c;
+        req->if_none_match[req->if_none_match_len] = 0;
+    }
+}
+
+// Um byte da parte de headers, depois da linha de requisição
+static bool header_byte(http_request_t *req, char c) {
+    if (req->line_start) {
+        if (c == '\r') {
+            return false;
+        }
+        if (c == '\n') {
+            // Linha em branco: fim dos headers
+            req->body_off = req->len < req->cap - 1 ? req->len + 1 : req->len;
+            req->len = req->body_off;
+            if (req->content_length == 0) {
+                return complete(req);
+            }
+            req->phase = HTTP_PHASE_BODY;
+            return false;
+        }
+        req->line_start = false;
+        req->cl_match = 0;
+        req->inm_match = 0;
+    }
+    if (c == '\n') {
+        req->line_start = true;
+        return false;
+    }
+    if (req->inm_match == sizeof(IF_NONE_MATCH) - 1) {
+        if_none_match_byte(req, c);
+    } else {
+        req->inm_match = match_name(req->inm_match, c, IF_NONE_MATCH, sizeof(IF_NONE_MATCH) - 1);
+    }
+    if (req->cl_match < sizeof(CONTENT_LENGTH) - 1) {
+        req->cl_match = match_name(req->cl_match, c, CONTENT_LENGTH, sizeof(CONTENT_LENGTH) - 1);
+    } else if (req->cl_match == sizeof(CONTENT_LENGTH) - 1) {
+        if (c >= '0' && c <= '9') {
+            // Satura em vez de estourar; o servidor recusa corpos grandes
+            uint32_t v = req->content_length * 10 + (uint32_t)(c - '0');
+            req->content_length = v / 10 == req->content_length ? v : UINT32_MAX;
+        } else if (c != ' ' && c != '\t' && c != '\r') {
+            req->cl_match = CL_NO_MATCH;
+        }
+    }
+    return false;
+}
+
+bool http_request_feed(http_request_t *req, const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char c = data[i];
+        switch (req->phase) {
+        case HTTP_PHASE_IDLE:
+            req->phase = HTTP_PHASE_HEADER;
+            // fall through
+        case HTTP_PHASE_HEADER:
+            if (req->in_request_line) {
+                if (c == '\n') {
+                    req->in_request_line = false;
+                    req->line_start = true;
+                    if (req->len && req->buf[req->len - 1] == '\r') {
+                        req->buf[--req->len] = 0;
+                    }
+                } else {
+                    store(req, c);
+                }
+            } else if (header_byte(req, c)) {
+                return true;
+            }
+            break;
+        case HTTP_PHASE_BODY:
+            store(req, c);
+            if (++req->body_len >= req->content_length) {
+                return complete(req);
+            }
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+const char *http_phase_name(http_phase_t phase) {
+    static const char *const names[HTTP_PHASE_COUNT] = {
+        [HTTP_PHASE_IDLE] = "idle",
+        [HTTP_PHASE_HEADER] = "header",
+        [HTTP_PHASE_BODY] = "body",
+        [HTTP_PHASE_RESPONSE] = "response",
+    };
+    return (unsigned)phase < HTTP_PHASE_COUNT ? names[phase] : "?";
+}
+
+void http_request_evicted(http_evict_reason_t reason, http_phase_t phase) {
+    if ((unsigned)reason < HTTP_EVICT_COUNT && (unsigned)phase < HTTP_PHASE_COUNT) {
+        stats.evicted[reason][phase]++;
+    }
+}
+
+void http_request_get_stats(http_request_stats_t *out) {
+    *out = stats;
+}
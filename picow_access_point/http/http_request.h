@@ -0,0 +1,83 @@
+/**
+ * Leitura incremental de requisições HTTP e prazos por fase.
+ *
+ * Os bytes chegam em pedaços (um cliente lento pode mandar um por segmento);
+ * http_request_feed() acompanha em que fase a requisição está:
+ *   idle      conexão aceita, nenhum byte ainda
+ *   header    linha de requisição e headers, até a linha em branco
+ *   body      Content-Length bytes de corpo
+ *   response  requisição completa, resposta em andamento
+ * Só a linha de requisição é guardada (terminada em zero, no início de buf);
+ * dos headers só interessam o Content-Length e o If-None-Match (guardado à
+ * parte, até HTTP_REQUEST_ETAG_MAX - 1 bytes). O corpo é guardado logo depois
+ * da linha, até onde couber.
+ *
+ * O servidor dá um prazo a cada fase (e um total) e, enquanto a requisição
+ * não está completa, baixa a prioridade do PCB (tcp_setprio): quando o pool de
+ * PCBs acaba, o próprio lwIP aborta primeiro as conexões de prioridade menor
+ * que a do listener, começando pelas paradas no meio dos headers.
+ */
+#ifndef _HTTP_REQUEST_H_
+#define _HTTP_REQUEST_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Intervalo do tcp_poll enquanto a requisição chega (unidades de ~500 ms),
+// que é a resolução dos prazos
+#define HTTP_REQUEST_POLL 1
+
+// Valor do If-None-Match guardado (os ETags do painel têm 18 bytes, com as
+// aspas); o que passar disso é ignorado
+#ifndef HTTP_REQUEST_ETAG_MAX
+#define HTTP_REQUEST_ETAG_MAX 32
+#endif
+
+typedef enum {
+    HTTP_PHASE_IDLE,
+    HTTP_PHASE_HEADER,
+    HTTP_PHASE_BODY,
+    HTTP_PHASE_RESPONSE,
+    HTTP_PHASE_COUNT,
+} http_phase_t;
+
+typedef enum {
+    HTTP_EVICT_DEADLINE,    // Prazo da fase ou total vencido
+    HTTP_EVICT_PRESSURE,    // Abortada pelo lwIP por falta de PCB
+    HTTP_EVICT_COUNT,
+} http_evict_reason_t;
+
+typedef struct {
+    char *buf;
+    uint16_t cap;
+    uint16_t len;           // Bytes guardados em buf (sem o terminador)
+    uint16_t body_off;      // Início do corpo em buf
+    uint8_t phase;          // http_phase_t
+    bool in_request_line;
+    bool line_start;
+    uint8_t cl_match;       // Progresso de "content-length:" na linha atual
+    uint8_t inm_match;      // Progresso de "if-none-match:"
+    uint8_t if_none_match_len;
+    char if_none_match[HTTP_REQUEST_ETAG_MAX];  // Terminado em zero
+    uint32_t content_length;
+    uint32_t body_len;      // Bytes de corpo recebidos (guardados ou não)
+} http_request_t;
+
+typedef struct {
+    uint32_t completed;
+    uint32_t evicted[HTTP_EVICT_COUNT][HTTP_PHASE_COUNT];
+} http_request_stats_t;
+
+void http_request_init(http_request_t *req, char *buf, size_t cap);
+
+// Consome len bytes; retorna true quando a requisição acaba de ficar completa.
+// Bytes depois disso são ignorados.
+bool http_request_feed(http_request_t *req, const char *data, size_t len);
+
+const char *http_phase_name(http_phase_t phase);
+
+void http_request_evicted(http_evict_reason_t reason, http_phase_t phase);
+void http_request_get_stats(http_request_stats_t *stats);
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * Execução dos templates compilados (ver http_template.h).
+ */
+#include <string.h>
+
+#include "http_template.h"
+
+// Decimal de v no fim de buf[10]; retorna o início
+static const char *uint_digits(uint32_t v, char buf[10], uint32_t *len) {
+    char *p = buf + 10;
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    *len = (uint32_t)(buf + 10 - p);
+    return p;
+}
+
+static uint32_t uint_width(uint32_t v) {
+    uint32_t n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+uint32_t http_template_length(const http_template_t *t, const http_tmpl_arg_t *args) {
+    uint32_t len = t->text_len;
+    for (uint16_t i = 0; i < t->count; i++) {
+        const http_tmpl_op_t *op = &t->ops[i];
+        if (op->kind == HTTP_TMPL_STR) {
+            len += (uint32_t)strlen(args[op->slot].s);
+        } else if (op->kind == HTTP_TMPL_UINT) {
+            len += uint_width(args[op->slot].u);
+        }
+    }
+    return len;
+}
+
+bool http_template_emit(const http_template_t *t, const http_tmpl_arg_t *args, uint32_t *off,
+                        http_tmpl_sink_fn sink, void *arg) {
+    uint32_t start = 0;
+    char digits[10];
+    for (uint16_t i = 0; i < t->count; i++) {
+        const http_tmpl_op_t *op = &t->ops[i];
+        const char *data;
+        uint32_t len;
+        switch (op->kind) {
+        case HTTP_TMPL_STR:
+            data = args[op->slot].s;
+            len = (uint32_t)strlen(data);
+            break;
+        case HTTP_TMPL_UINT:
+            data = uint_digits(args[op->slot].u, digits, &len);
+            break;
+        default:
+            data = op->text;
+            len = op->len;
+            break;
+        }
+        uint32_t end = start + len;
+        if (*off < end) {
+            uint32_t skip = *off - start;
+            *off += sink(arg, data + skip, len - skip);
+            if (*off < end) {
+                return false;
+            }
+        }
+        start = end;
+    }
+    return true;
+}
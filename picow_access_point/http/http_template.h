@@ -0,0 +1,62 @@
+/**
+ * Templates de resposta compilados no build (tools/gen_templates.py).
+ *
+ * Cada arquivo de templates/ vira uma sequência de operações: literais, que
+ * ficam prontos na flash, e slots, preenchidos com um vetor de valores
+ * (http_tmpl_arg_t, indexado pelo enum http_slot_t gerado). Não há string de
+ * formato para interpretar por requisição: o texto sai operação por operação,
+ * e o tamanho (para o Content-Length) é text_len, somado pelo gerador, mais a
+ * largura dos slots. Os slots de string não são escapados; os valores são
+ * textos do próprio programa.
+ *
+ * O texto pode sair aos pedaços: http_template_emit() recomeça do byte *off,
+ * como HTTP_SEND, então os valores precisam ser os mesmos a cada retomada.
+ */
+#ifndef _HTTP_TEMPLATE_H_
+#define _HTTP_TEMPLATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Slots distintos entre todos os templates (o gerador confere)
+#ifndef HTTP_TEMPLATE_MAX_SLOTS
+#define HTTP_TEMPLATE_MAX_SLOTS 16
+#endif
+
+typedef enum {
+    HTTP_TMPL_TEXT,         // Literal (copiado para o buffer de envio)
+    HTTP_TMPL_STR,          // Slot {{nome}}: string terminada em zero
+    HTTP_TMPL_UINT,         // Slot {{nome:u}}: inteiro sem sinal, em decimal
+} http_tmpl_op_kind_t;
+
+typedef struct {
+    uint8_t kind;           // http_tmpl_op_kind_t
+    uint8_t slot;           // Slots: índice no vetor de valores
+    uint16_t len;           // Literais
+    const char *text;
+} http_tmpl_op_t;
+
+typedef struct {
+    const http_tmpl_op_t *ops;
+    uint16_t count;
+    uint16_t text_len;      // Soma dos literais
+} http_template_t;
+
+typedef union {
+    const char *s;
+    uint32_t u;
+} http_tmpl_arg_t;
+
+// Recebe len bytes; retorna quantos aceitou
+typedef uint32_t (*http_tmpl_sink_fn)(void *arg, const char *data, uint32_t len);
+
+// Tamanho do texto com os valores de args
+uint32_t http_template_length(const http_template_t *t, const http_tmpl_arg_t *args);
+
+// Entrega o texto a partir do byte *off, avançando *off até o sink recusar
+// bytes; true quando ele saiu inteiro
+bool http_template_emit(const http_template_t *t, const http_tmpl_arg_t *args, uint32_t *off,
+                        http_tmpl_sink_fn sink, void *arg);
+
+#endif
@@ -0,0 +1,490 @@
+/**
+ * JSON sem alocação (ver json.h).
+ */
+#include <string.h>
+
+#include "json.h"
+
+// =============================================
+// Escritor
+// =============================================
+
+void json_writer_init(json_writer_t *w, json_sink_fn sink, void *arg, uint32_t skip) {
+    memset(w, 0, offsetof(json_writer_t, chunk));
+    w->sink = sink;
+    w->arg = arg;
+    w->skip = skip;
+    w->sent = skip;
+}
+
+void json_writer_flush(json_writer_t *w) {
+    if (w->used && !w->full) {
+        size_t n = w->sink(w->arg, w->chunk, w->used);
+        w->sent += (uint32_t)n;
+        w->full = n < w->used;
+    }
+    w->used = 0;
+}
+
+// Conta len bytes no documento e entrega os que ainda não saíram
+static void json_emit(json_writer_t *w, const char *data, size_t len) {
+    uint32_t pos = w->pos;
+    w->pos += (uint32_t)len;
+    if (!w->sink || w->full || w->pos <= w->skip) {
+        return;
+    }
+    if (pos < w->skip) {
+        data += w->skip - pos;
+        len -= w->skip - pos;
+    }
+    while (len) {
+        size_t n = JSON_WRITER_CHUNK - w->used;
+        if (n > len) {
+            n = len;
+        }
+        memcpy(w->chunk + w->used, data, n);
+        w->used += n;
+        data += n;
+        len -= n;
+        if (w->used == JSON_WRITER_CHUNK) {
+            json_writer_flush(w);
+            if (w->full) {
+                return;
+            }
+        }
+    }
+}
+
+// Vírgula antes de todo valor que não é o primeiro do contêiner nem vem
+// depois de uma chave
+static void json_value_start(json_writer_t *w) {
+    if (w->comma) {
+        json_emit(w, ",", 1);
+    }
+    w->comma = true;
+}
+
+static void json_emit_string(json_writer_t *w, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    json_emit(w, "\"", 1);
+    const char *run = s;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        json_emit(w, run, s - run);
+        run = s + 1;
+        char esc[6] = { '\\', (char)c };
+        size_t esc_len = 2;
+        if (c == '\n') {
+            esc[1] = 'n';
+        } else if (c == '\r') {
+            esc[1] = 'r';
+        } else if (c == '\t') {
+            esc[1] = 't';
+        } else if (c < 0x20) {
+            memcpy(esc + 1, "u00", 3);
+            esc[4] = hex[c >> 4];
+            esc[5] = hex[c & 0xF];
+            esc_len = 6;
+        }
+        json_emit(w, esc, esc_len);
+    }
+    json_emit(w, run, s - run);
+    json_emit(w, "\"", 1);
+}
+
+static void json_emit_uint(json_writer_t *w, uint32_t v) {
+    char digits[10];
+    char *p = digits + sizeof(digits);
+    do {
+        *--p = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    json_emit(w, p, digits + sizeof(digits) - p);
+}
+
+void json_object_begin(json_writer_t *w) {
+    json_value_start(w);
+    json_emit(w, "{", 1);
+    w->comma = false;
+}
+
+void json_object_end(json_writer_t *w) {
+    json_emit(w, "}", 1);
+    w->comma = true;
+}
+
+void json_array_begin(json_writer_t *w) {
+    json_value_start(w);
+    json_emit(w, "[", 1);
+    w->comma = false;
+}
+
+void json_array_end(json_writer_t *w) {
+    json_emit(w, "]", 1);
+    w->comma = true;
+}
+
+void json_key(json_writer_t *w, const char *key) {
+    json_value_start(w);
+    json_emit_string(w, key);
+    json_emit(w, ":", 1);
+    w->comma = false;
+}
+
+void json_key_raw(json_writer_t *w, const char *quoted, size_t len) {
+    json_value_start(w);
+    json_emit(w, quoted, len);
+    w->comma = false;
+}
+
+void json_string(json_writer_t *w, const char *s) {
+    json_value_start(w);
+    json_emit_string(w, s);
+}
+
+void json_int(json_writer_t *w, int32_t v) {
+    json_value_start(w);
+    if (v < 0) {
+        json_emit(w, "-", 1);
+    }
+    json_emit_uint(w, v < 0 ? 0u - (uint32_t)v : (uint32_t)v);
+}
+
+void json_uint(json_writer_t *w, uint32_t v) {
+    json_value_start(w);
+    json_emit_uint(w, v);
+}
+
+void json_bool(json_writer_t *w, bool v) {
+    json_value_start(w);
+    if (v) {
+        json_emit(w, "true", 4);
+    } else {
+        json_emit(w, "false", 5);
+    }
+}
+
+void json_null(json_writer_t *w) {
+    json_value_start(w);
+    json_emit(w, "null", 4);
+}
+
+// =============================================
+// Tokenizador
+// =============================================
+
+typedef enum {
+    EXPECT_VALUE,
+    EXPECT_VALUE_OR_CLOSE,  // Logo depois de '['
+    EXPECT_KEY,
+    EXPECT_KEY_OR_CLOSE,    // Logo depois de '{'
+    EXPECT_COLON,
+    EXPECT_COMMA_OR_CLOSE,
+    EXPECT_END,             // Valor da raiz completo: só espaços
+} json_expect_t;
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool is_hex(char c) {
+    c |= 0x20;  // minúscula
+    return is_digit(c) || (c >= 'a' && c <= 'f');
+}
+
+// Aspa de fechamento da string aberta antes de s[i], ou 0 se inválida
+static size_t scan_string(const char *s, size_t len, size_t i) {
+    for (; i < len; i++) {
+        unsigned char c = (unsigned char)s[i];
+        if (c == '"') {
+            return i;
+        }
+        if (c < 0x20) {
+            return 0;
+        }
+        if (c != '\\') {
+            continue;
+        }
+        if (++i == len) {
+            return 0;
+        }
+        if (s[i] == 'u') {
+            for (int k = 1; k <= 4; k++) {
+                if (i + k >= len || !is_hex(s[i + k])) {
+                    return 0;
+                }
+            }
+            i += 4;
+        } else if (!s[i] || !strchr("\"\\/bfnrt", s[i])) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+static size_t scan_digits(const char *s, size_t len, size_t i) {
+    while (i < len && is_digit(s[i])) {
+        i++;
+    }
+    return i;
+}
+
+// Fim (exclusivo) do número que começa em s[i], ou 0 se inválido; o que vem
+// depois é conferido pela máquina de estados
+static size_t scan_number(const char *s, size_t len, size_t i) {
+    if (s[i] == '-') {
+        i++;
+    }
+    if (i < len && s[i] == '0') {
+        i++;
+    } else if (i < len && is_digit(s[i])) {
+        i = scan_digits(s, len, i);
+    } else {
+        return 0;
+    }
+    if (i < len && s[i] == '.') {
+        size_t end = scan_digits(s, len, i + 1);
+        if (end == i + 1) {
+            return 0;
+        }
+        i = end;
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-')) {
+            i++;
+        }
+        size_t end = scan_digits(s, len, i);
+        if (end == i) {
+            return 0;
+        }
+        i = end;
+    }
+    return i;
+}
+
+static bool scan_literal(const char *s, size_t len, size_t i, const char *lit, size_t lit_len) {
+    return len - i >= lit_len && memcmp(s + i, lit, lit_len) == 0;
+}
+
+int json_parse(const char *s, size_t len, json_token_t *tokens, size_t max) {
+    if (len > UINT16_MAX) {
+        return JSON_ERR_SIZE;
+    }
+    // Contêineres abertos (índices em tokens), no lugar da recursão
+    uint16_t stack[JSON_MAX_DEPTH];
+    int depth = 0;
+    size_t n = 0;
+    json_expect_t expect = EXPECT_VALUE;
+
+    for (size_t i = 0; i < len; i++) {
+        char c = s[i];
+        if (is_space(c)) {
+            continue;
+        }
+        json_token_t *top = depth ? &tokens[stack[depth - 1]] : NULL;
+
+        if ((c == '}' && expect == EXPECT_KEY_OR_CLOSE) || (c == ']' && expect == EXPECT_VALUE_OR_CLOSE) ||
+            ((c == '}' || c == ']') && expect == EXPECT_COMMA_OR_CLOSE)) {
+            if (!top || top->type != (c == '}' ? JSON_OBJECT : JSON_ARRAY)) {
+                return JSON_ERR_SYNTAX;
+            }
+            top->len = (uint16_t)(i + 1 - top->start);
+            top->skip = (uint16_t)(n - stack[--depth]);
+            expect = depth ? EXPECT_COMMA_OR_CLOSE : EXPECT_END;
+            continue;
+        }
+
+        switch (expect) {
+        case EXPECT_COLON:
+            if (c != ':') {
+                return JSON_ERR_SYNTAX;
+            }
+            expect = EXPECT_VALUE;
+            continue;
+        case EXPECT_COMMA_OR_CLOSE:
+            if (c != ',') {
+                return JSON_ERR_SYNTAX;
+            }
+            expect = top->type == JSON_OBJECT ? EXPECT_KEY : EXPECT_VALUE;
+            continue;
+        case EXPECT_KEY:
+        case EXPECT_KEY_OR_CLOSE:
+            if (c != '"') {
+                return JSON_ERR_SYNTAX;
+            }
+            break;
+        case EXPECT_VALUE:
+        case EXPECT_VALUE_OR_CLOSE:
+            break;
+        default:
+            // Texto depois do valor da raiz
+            return JSON_ERR_SYNTAX;
+        }
+
+        // Uma chave ou um valor: um token novo
+        if (n == max) {
+            return JSON_ERR_TOKENS;
+        }
+        json_token_t *t = &tokens[n];
+        t->start = (uint16_t)i;
+        t->size = 0;
+        t->skip = 1;
+        bool key = expect == EXPECT_KEY || expect == EXPECT_KEY_OR_CLOSE;
+        if (key || (top && top->type == JSON_ARRAY)) {
+            top->size++;
+        }
+
+        if (c == '{' || c == '[') {
+            if (depth == JSON_MAX_DEPTH) {
+                return JSON_ERR_DEPTH;
+            }
+            t->type = c == '{' ? JSON_OBJECT : JSON_ARRAY;
+            stack[depth++] = (uint16_t)n++;
+            expect = c == '{' ? EXPECT_KEY_OR_CLOSE : EXPECT_VALUE_OR_CLOSE;
+            continue;
+        }
+
+        size_t end;
+        if (c == '"') {
+            size_t quote = scan_string(s, len, i + 1);
+            if (!quote) {
+                return JSON_ERR_SYNTAX;
+            }
+            t->type = JSON_STRING;
+            t->start = (uint16_t)(i + 1);
+            t->len = (uint16_t)(quote - i - 1);
+            end = quote + 1;
+        } else {
+            if (c == '-' || is_digit(c)) {
+                t->type = JSON_NUMBER;
+                end = scan_number(s, len, i);
+            } else if (scan_literal(s, len, i, "true", 4)) {
+                t->type = JSON_TRUE;
+                end = i + 4;
+            } else if (scan_literal(s, len, i, "false", 5)) {
+                t->type = JSON_FALSE;
+                end = i + 5;
+            } else if (scan_literal(s, len, i, "null", 4)) {
+                t->type = JSON_NULL;
+                end = i + 4;
+            } else {
+                end = 0;
+            }
+            if (!end) {
+                return JSON_ERR_SYNTAX;
+            }
+            t->len = (uint16_t)(end - i);
+        }
+        n++;
+        i = end - 1;
+        expect = key ? EXPECT_COLON : depth ? EXPECT_COMMA_OR_CLOSE : EXPECT_END;
+    }
+    return expect == EXPECT_END ? (int)n : JSON_ERR_SYNTAX;
+}
+
+const char *json_error_name(int err) {
+    switch (err) {
+    case JSON_ERR_SYNTAX:
+        return "syntax";
+    case JSON_ERR_TOKENS:
+        return "too many tokens";
+    case JSON_ERR_DEPTH:
+        return "too deep";
+    case JSON_ERR_SIZE:
+        return "too large";
+    default:
+        return err < 0 ? "?" : "ok";
+    }
+}
+
+int json_find(const char *s, const json_token_t *tokens, int count, int obj, const char *key) {
+    if (obj < 0 || obj >= count || tokens[obj].type != JSON_OBJECT) {
+        return -1;
+    }
+    int i = obj + 1;
+    for (uint16_t pair = 0; pair < tokens[obj].size && i + 1 < count; pair++) {
+        if (json_token_eq(s, &tokens[i], key)) {
+            return i + 1;
+        }
+        i += 1 + tokens[i + 1].skip;
+    }
+    return -1;
+}
+
+bool json_token_eq(const char *s, const json_token_t *t, const char *str) {
+    size_t len = strlen(str);
+    return t->type == JSON_STRING && t->len == len && memcmp(s + t->start, str, len) == 0;
+}
+
+bool json_token_int(const char *s, const json_token_t *t, int32_t min, int32_t max, int32_t *out) {
+    if (t->type != JSON_NUMBER) {
+        return false;
+    }
+    const char *p = s + t->start;
+    const char *end = p + t->len;
+    bool negative = *p == '-';
+    if (negative) {
+        p++;
+    }
+    int64_t v = 0;
+    for (; p < end; p++) {
+        // Fração e expoente não são inteiros
+        if (!is_digit(*p)) {
+            return false;
+        }
+        v = v * 10 + (*p - '0');
+        if (v > (int64_t)INT32_MAX + 1) {
+            return false;
+        }
+    }
+    if (negative) {
+        v = -v;
+    }
+    if (v < min || v > max) {
+        return false;
+    }
+    *out = (int32_t)v;
+    return true;
+}
+
+bool json_token_bool(const json_token_t *t, bool *out) {
+    if (t->type != JSON_TRUE && t->type != JSON_FALSE) {
+        return false;
+    }
+    *out = t->type == JSON_TRUE;
+    return true;
+}
+
+bool json_token_enum(const char *s, const json_token_t *t, const char *const names[], size_t count, int *out) {
+    if (t->type == JSON_STRING) {
+        for (size_t i = 0; i < count; i++) {
+            if (names[i] && json_token_eq(s, t, names[i])) {
+                *out = (int)i;
+                return true;
+            }
+        }
+        return false;
+    }
+    bool b;
+    if (json_token_bool(t, &b)) {
+        if (count < 2) {
+            return false;
+        }
+        *out = b;
+        return true;
+    }
+    int32_t index;
+    if (count && json_token_int(s, t, 0, (int32_t)count - 1, &index)) {
+        *out = index;
+        return true;
+    }
+    return false;
+}
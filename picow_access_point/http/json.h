@@ -0,0 +1,130 @@
+/**
+ * JSON sem alocação: escritor em fluxo para as respostas da API e tokenizador
+ * limitado para os corpos das requisições.
+ *
+ * Escritor: cada valor vai direto para um sink (no servidor, http_write(),
+ * que copia para o buffer de envio do TCP) através de um bloco de
+ * JSON_WRITER_CHUNK bytes que só agrupa as escritas pequenas. Não há
+ * documento montado em memória nem formatação de ponto flutuante: números
+ * são inteiros. Quando o sink recusa bytes (buffer de envio cheio), o resto
+ * da passada é descartado e o gerador roda de novo na retomada com
+ * skip = json_writer_t.sent, pulando o que já saiu; por isso o gerador
+ * precisa produzir o mesmo documento a cada passada (trabalhe sobre um
+ * retrato do estado). Uma passada sem sink só mede o tamanho, que vira o
+ * Content-Length.
+ *
+ * Tokenizador: divide o texto em tokens (no estilo do jsmn) num vetor dado
+ * pelo chamador, sem recursão: a profundidade é limitada por JSON_MAX_DEPTH
+ * e o número de tokens pelo tamanho do vetor. As strings não são
+ * decodificadas; os tokens apontam para o texto original.
+ */
+#ifndef _JSON_H_
+#define _JSON_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bytes agrupados antes de cada chamada ao sink
+#ifndef JSON_WRITER_CHUNK
+#define JSON_WRITER_CHUNK 64
+#endif
+
+// Objetos e listas aninhados aceitos pelo tokenizador
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH 8
+#endif
+
+// =============================================
+// Escritor
+// =============================================
+
+// Entrega len bytes; retorna quantos foram aceitos (menos que len: cheio)
+typedef size_t (*json_sink_fn)(void *arg, const char *data, size_t len);
+
+typedef struct {
+    json_sink_fn sink;      // NULL: só mede
+    void *arg;
+    uint32_t pos;           // Tamanho do documento gerado até aqui
+    uint32_t skip;          // Bytes entregues em passadas anteriores
+    uint32_t sent;          // Bytes entregues, contando skip
+    bool full;              // O sink recusou bytes: o resto da passada é descartado
+    bool comma;             // Há um valor antes no contêiner atual
+    uint16_t used;
+    char chunk[JSON_WRITER_CHUNK];
+} json_writer_t;
+
+void json_writer_init(json_writer_t *w, json_sink_fn sink, void *arg, uint32_t skip);
+
+// Entrega o que está no bloco; chame no fim do documento
+void json_writer_flush(json_writer_t *w);
+
+// Documento inteiro entregue (depois de json_writer_flush)
+static inline bool json_writer_done(const json_writer_t *w) {
+    return w->sent == w->pos;
+}
+
+void json_object_begin(json_writer_t *w);
+void json_object_end(json_writer_t *w);
+void json_array_begin(json_writer_t *w);
+void json_array_end(json_writer_t *w);
+// Chave do próximo valor de um objeto; key e os valores string são escapados
+void json_key(json_writer_t *w, const char *key);
+// Chave literal do programa, já pronta em tempo de compilação ("lit":): sem
+// escape nem strlen
+#define JSON_KEY(w, lit) json_key_raw((w), "\"" lit "\":", sizeof("\"" lit "\":") - 1)
+void json_key_raw(json_writer_t *w, const char *quoted, size_t len);
+void json_string(json_writer_t *w, const char *s);
+void json_int(json_writer_t *w, int32_t v);
+void json_uint(json_writer_t *w, uint32_t v);
+void json_bool(json_writer_t *w, bool v);
+void json_null(json_writer_t *w);
+
+// =============================================
+// Tokenizador
+// =============================================
+
+typedef enum {
+    JSON_OBJECT,
+    JSON_ARRAY,
+    JSON_STRING,            // Sem as aspas, escapes como estão no texto
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+} json_type_t;
+
+typedef enum {
+    JSON_ERR_SYNTAX = -1,
+    JSON_ERR_TOKENS = -2,   // Mais tokens que o vetor
+    JSON_ERR_DEPTH = -3,    // Mais que JSON_MAX_DEPTH níveis
+    JSON_ERR_SIZE = -4,     // Texto maior que UINT16_MAX
+} json_error_t;
+
+typedef struct {
+    uint8_t type;           // json_type_t
+    uint16_t start;         // Offset no texto
+    uint16_t len;
+    uint16_t size;          // Objeto: pares; lista: elementos
+    uint16_t skip;          // Tokens da subárvore, contando este
+} json_token_t;
+
+// Tokeniza len bytes de s (um valor, com espaços em volta); retorna o número
+// de tokens ou um json_error_t. Num objeto, os filhos vêm em pares
+// chave/valor a partir do token seguinte.
+int json_parse(const char *s, size_t len, json_token_t *tokens, size_t max);
+
+const char *json_error_name(int err);
+
+// Índice do valor de key no objeto tokens[obj], ou -1
+int json_find(const char *s, const json_token_t *tokens, int count, int obj, const char *key);
+
+// String igual a str (comparando o texto cru, sem decodificar escapes)
+bool json_token_eq(const char *s, const json_token_t *t, const char *str);
+// Conversões estritas, como as de http_form.h
+bool json_token_int(const char *s, const json_token_t *t, int32_t min, int32_t max, int32_t *out);
+bool json_token_bool(const json_token_t *t, bool *out);
+// String com um nome de names[], inteiro com o índice, ou true/false (1/0)
+bool json_token_enum(const char *s, const json_token_t *t, const char *const names[], size_t count, int *out);
+
+#endif
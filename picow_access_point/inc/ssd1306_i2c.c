@@ -7,6 +7,7 @@
 #include "hardware/i2c.h"
 #include "ssd1306_font.h"
 #include "ssd1306_i2c.h"
+#include "heap.h"
 
 // Calcular quanto do buffer será destinado à área de renderização
 void calculate_render_area_buffer_length(struct render_area *area) {
@@ -28,14 +29,14 @@ void ssd1306_send_command_list(uint8_t *ssd, int number) {
 
 // Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
 void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+    uint8_t *temp_buffer = heap_malloc(buffer_length + 1);
 
     temp_buffer[0] = 0x40;
     memcpy(temp_buffer + 1, ssd, buffer_length);
 
     i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
 
-    free(temp_buffer);
+    heap_free(temp_buffer);
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -133,7 +134,7 @@ void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool se
 }
 
 // Adquire os pixels para um caractere (de acordo com ssd1306_font.h)
-inline int ssd1306_get_font(uint8_t character)
+static inline int ssd1306_get_font(uint8_t character)
 {
   if (character >= 'A' && character <= 'Z') {
     return character - 'A' + 1;
@@ -218,7 +219,7 @@ void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool externa
     ssd->address = address;
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    ssd->ram_buffer = heap_calloc(ssd->bufsize, sizeof(uint8_t));
     ssd->ram_buffer[0] = 0x40;
     ssd->port_buffer[0] = 0x80;
 }
@@ -4,16 +4,28 @@
 // Common settings used in most of the pico_w examples
 // (see https://www.nongnu.org/lwip/2_1_x/group__lwip__opts.html for details)
 
-// allow override in some examples
+// allow override in some examples; the FreeRTOS target (sys_freertos) runs
+// lwIP in its own tcpip_thread
 #ifndef NO_SYS
+#if PICO_CYW43_ARCH_FREERTOS
+#define NO_SYS                      0
+#else
 #define NO_SYS                      1
 #endif
+#endif
 // allow override in some examples
 #ifndef LWIP_SOCKET
 #define LWIP_SOCKET                 0
 #endif
 #if PICO_CYW43_ARCH_POLL
 #define MEM_LIBC_MALLOC             1
+#if PICOW_HEAP_TLSF
+// mem_malloc no pool TLSF da aplicação (heap/heap.h), não na newlib
+#include "heap.h"
+#define mem_clib_malloc             heap_malloc
+#define mem_clib_calloc             heap_calloc
+#define mem_clib_free               heap_free
+#endif
 #else
 // MEM_LIBC_MALLOC is incompatible with non polling versions
 #define MEM_LIBC_MALLOC             0
@@ -35,10 +47,18 @@
 #define LWIP_NETIF_LINK_CALLBACK    1
 #define LWIP_NETIF_HOSTNAME         1
 #define LWIP_NETCONN                0
-#define MEM_STATS                   0
+// heap and pool counters stay on in release builds for /metrics
+#ifndef MEM_STATS
+#define MEM_STATS                   1
+#endif
+#ifndef SYS_STATS
 #define SYS_STATS                   0
-#define MEMP_STATS                  0
+#endif
+#ifndef MEMP_STATS
+#define MEMP_STATS                  1
+#endif
 #define LINK_STATS                  0
+#define LWIP_STATS                  1
 // #define ETH_PAD_SIZE                2
 #define LWIP_CHKSUM_ALGORITHM       3
 #define LWIP_DHCP                   1
@@ -47,13 +67,37 @@
 #define LWIP_UDP                    1
 #define LWIP_DNS                    1
 #define LWIP_TCP_KEEPALIVE          1
+// TIME_WAIT dura 2 * TCP_MSL; o padrão do lwIP (60 s) é para a internet, aqui
+// os clientes estão a um salto, no próprio AP
+#ifndef TCP_MSL
+#define TCP_MSL                     5000UL
+#endif
+// SOF_REUSEADDR no listener: a porta 80 reabre mesmo com PCBs em TIME_WAIT
+#define SO_REUSE                    1
 #define LWIP_NETIF_TX_SINGLE_PBUF   1
 #define DHCP_DOES_ARP_CHECK         0
 #define LWIP_DHCP_DOES_ACD_CHECK    0
 
+#if !NO_SYS
+// tcpip_thread runs every raw API callback (TCP, DHCP and DNS servers); the
+// application tasks in rtos/rtos_tasks.h are prioritised around it
+#ifndef TCPIP_THREAD_STACKSIZE
+#define TCPIP_THREAD_STACKSIZE      1024
+#endif
+#define TCPIP_THREAD_PRIO           3
+#define DEFAULT_THREAD_STACKSIZE    1024
+#define DEFAULT_RAW_RECVMBOX_SIZE   8
+#define DEFAULT_UDP_RECVMBOX_SIZE   8
+#define DEFAULT_TCP_RECVMBOX_SIZE   8
+#define DEFAULT_ACCEPTMBOX_SIZE     8
+#define TCPIP_MBOX_SIZE             8
+#define LWIP_TCPIP_CORE_LOCKING     1
+#define LWIP_TIMEVAL_PRIVATE        0
+#define SYS_LIGHTWEIGHT_PROT        1
+#endif
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define LWIP_STATS_DISPLAY          1
 #endif
 
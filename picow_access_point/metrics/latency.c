@@ -0,0 +1,68 @@
+/**
+ * Histogramas de latência (ver latency.h).
+ */
+#include <stdio.h>
+
+#include "latency.h"
+
+static const char *const probe_names[] = {
+#define LATENCY_NAME(id, label) label,
+    LATENCY_PROBES(LATENCY_NAME)
+#undef LATENCY_NAME
+};
+
+static latency_hist_t hists[LATENCY_PROBE_COUNT];
+
+#if PICOW_LATENCY
+void latency_record(latency_probe_t probe, uint32_t us) {
+    // Balde b cobre (2^(b-1), 2^b]; 0 e 1 us caem no balde 0
+    int b = us <= 1 ? 0 : 32 - __builtin_clz(us - 1);
+    if (b >= LATENCY_BUCKETS) {
+        b = LATENCY_BUCKETS - 1;
+    }
+    latency_hist_t *h = &hists[probe];
+    h->buckets[b]++;
+    h->count++;
+    h->sum_us += us;
+    if (us > h->max_us) {
+        h->max_us = us;
+    }
+}
+#endif
+
+const char *latency_probe_name(latency_probe_t probe) {
+    return probe_names[probe];
+}
+
+const latency_hist_t *latency_get(latency_probe_t probe) {
+    return &hists[probe];
+}
+
+uint32_t latency_quantile(const latency_hist_t *h, double q) {
+    if (!h->count) {
+        return 0;
+    }
+    uint32_t rank = (uint32_t)(q * h->count);
+    uint32_t seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS - 1; b++) {
+        seen += h->buckets[b];
+        if (seen > rank) {
+            uint32_t le = latency_bucket_le(b);
+            return le < h->max_us ? le : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+void latency_print(void) {
+    printf("%-18s %10s %10s %10s %10s %10s\n", "latency (us)", "count", "mean", "p50<=", "p99<=", "max");
+    for (int i = 0; i < LATENCY_PROBE_COUNT; i++) {
+        const latency_hist_t *h = &hists[i];
+        if (!h->count) {
+            continue;
+        }
+        printf("%-18s %10u %10u %10u %10u %10u\n", probe_names[i], (unsigned)h->count,
+            (unsigned)(h->sum_us / h->count), (unsigned)latency_quantile(h, 0.5),
+            (unsigned)latency_quantile(h, 0.99), (unsigned)h->max_us);
+    }
+}
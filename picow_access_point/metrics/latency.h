@@ -0,0 +1,101 @@
+/**
+ * Histogramas de latência por callback e por fase do laço principal.
+ *
+ * Cada sonda acumula um histograma log2 de durações em microssegundos (balde
+ * b conta durações em (2^(b-1), 2^b]), com soma, contagem e máximo. O custo é
+ * uma leitura de time_us_32() na entrada e outra na saída. Com
+ * PICOW_LATENCY=0 as sondas viram código vazio.
+ *
+ * No build host as sondas usam latency_clock_us() (hal_host.c): no tempo
+ * virtual do simulador o tempo só anda quando alguém o avança, então o custo
+ * de CPU de um callback mediria zero; esse relógio soma o tempo real.
+ */
+#ifndef _LATENCY_H_
+#define _LATENCY_H_
+
+#include <stdint.h>
+#include "pico/stdlib.h"
+
+#ifndef PICOW_LATENCY
+#define PICOW_LATENCY 1
+#endif
+
+// Sondas: identificador e rótulo exportado em /metrics
+#define LATENCY_PROBES(X) \
+    X(TCP_ACCEPT, "tcp_accept") \
+    X(TCP_RECV, "tcp_recv") \
+    X(TCP_SENT, "tcp_sent") \
+    X(TCP_POLL, "tcp_poll") \
+    X(DHCP, "dhcp_process") \
+    X(DNS, "dns_process") \
+    X(DISPLAY, "render_on_display") \
+    X(LOOP_ALARM, "loop_alarm") \
+    X(LOOP_DISPLAY, "loop_display") \
+    X(LOOP_POLL, "loop_poll") \
+    X(LOOP_WAIT, "loop_wait") \
+    X(LOOP_ITERATION, "loop_iteration") \
+    X(ALARM_CMD_QUEUE, "alarm_cmd_queue") \
+    X(ALARM_CMD_OUTPUT, "alarm_cmd_output") \
+    X(LOOP_WORK, "loop_work") \
+    X(WORK_QUEUE, "work_queue") \
+    X(HTTP_DEFERRED, "http_deferred")
+
+typedef enum {
+#define LATENCY_ENUM(id, label) LATENCY_##id,
+    LATENCY_PROBES(LATENCY_ENUM)
+#undef LATENCY_ENUM
+    LATENCY_PROBE_COUNT
+} latency_probe_t;
+
+// 2^22 us (~4 s); acima disso vai para o último balde (+Inf)
+#define LATENCY_BUCKETS 24
+
+typedef struct {
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t sum_us;
+} latency_hist_t;
+
+#if PICOW_LATENCY
+#if PICO_ON_DEVICE
+#define latency_clock_us() time_us_32()
+#else
+uint32_t latency_clock_us(void);
+#endif
+static inline uint32_t latency_begin(void) {
+    return latency_clock_us();
+}
+void latency_record(latency_probe_t probe, uint32_t us);
+static inline void latency_end(latency_probe_t probe, uint32_t start) {
+    latency_record(probe, latency_clock_us() - start);
+}
+#else
+static inline uint32_t latency_begin(void) {
+    return 0;
+}
+static inline void latency_record(latency_probe_t probe, uint32_t us) {
+    (void)probe;
+    (void)us;
+}
+static inline void latency_end(latency_probe_t probe, uint32_t start) {
+    (void)probe;
+    (void)start;
+}
+#endif
+
+const char *latency_probe_name(latency_probe_t probe);
+const latency_hist_t *latency_get(latency_probe_t probe);
+
+// Limite superior (us) do balde b; o último balde não tem limite
+static inline uint32_t latency_bucket_le(int b) {
+    return 1u << b;
+}
+
+// Estimativa do quantil q (0..1) pelo limite superior do balde
+uint32_t latency_quantile(const latency_hist_t *h, double q);
+
+// Tabela resumida no console (usada pelo build host ao encerrar)
+void latency_print(void);
+
+#endif
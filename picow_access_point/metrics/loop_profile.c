@@ -0,0 +1,116 @@
+/**
+ * Perfil do laço principal (ver loop_profile.h).
+ */
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "latency.h"
+#include "loop_profile.h"
+
+static const char *const phase_names[LOOP_PHASE_COUNT] = {
+    [LOOP_PHASE_ALARM] = "alarm",
+    [LOOP_PHASE_DISPLAY] = "display",
+    [LOOP_PHASE_POLL] = "poll",
+    [LOOP_PHASE_WORK] = "work",
+    [LOOP_PHASE_WAIT] = "wait",
+};
+
+// Histograma de latência de cada fase
+static const latency_probe_t phase_probes[LOOP_PHASE_COUNT] = {
+    [LOOP_PHASE_ALARM] = LATENCY_LOOP_ALARM,
+    [LOOP_PHASE_DISPLAY] = LATENCY_LOOP_DISPLAY,
+    [LOOP_PHASE_POLL] = LATENCY_LOOP_POLL,
+    [LOOP_PHASE_WORK] = LATENCY_LOOP_WORK,
+    [LOOP_PHASE_WAIT] = LATENCY_LOOP_WAIT,
+};
+
+static struct {
+    loop_profile_stats_t stats;
+    uint32_t iter_start;
+    uint32_t phase_start;
+    int phase;              // -1 fora de uma fase
+    uint32_t phase_us[LOOP_PHASE_COUNT];
+    uint32_t alert_us;
+    loop_alert_fn alert;
+} prof = { .phase = -1, .alert_us = LOOP_ALERT_US };
+
+static void default_alert(loop_phase_t phase, uint32_t us) {
+    printf("loop stall: phase %s took %u us\n", phase_names[phase], (unsigned)us);
+}
+
+static void close_phase(uint32_t now) {
+    if (prof.phase < 0) {
+        return;
+    }
+    uint32_t us = now - prof.phase_start;
+    prof.phase_us[prof.phase] += us;
+    latency_record(phase_probes[prof.phase], us);
+    if (us > prof.stats.phase_max_us[prof.phase]) {
+        prof.stats.phase_max_us[prof.phase] = us;
+    }
+    if (prof.alert_us && us > prof.alert_us) {
+        prof.stats.alerts[prof.phase]++;
+        (prof.alert ? prof.alert : default_alert)(prof.phase, us);
+    }
+    prof.phase = -1;
+}
+
+void loop_profile_begin(void) {
+    prof.iter_start = time_us_32();
+    prof.phase = -1;
+    memset(prof.phase_us, 0, sizeof(prof.phase_us));
+}
+
+void loop_profile_phase(loop_phase_t phase) {
+    uint32_t now = time_us_32();
+    close_phase(now);
+    prof.phase = phase;
+    prof.phase_start = now;
+}
+
+void loop_profile_end(void) {
+    uint32_t now = time_us_32();
+    close_phase(now);
+
+    uint32_t total = now - prof.iter_start;
+    loop_profile_stats_t *s = &prof.stats;
+    s->iterations++;
+    latency_record(LATENCY_LOOP_ITERATION, total);
+    if (total - prof.phase_us[LOOP_PHASE_WAIT] > LOOP_BUDGET_US) {
+        s->overruns++;
+    }
+    if (total > s->longest.total_us) {
+        s->longest.total_us = total;
+        memcpy(s->longest.phase_us, prof.phase_us, sizeof(prof.phase_us));
+        s->longest.at_ms = to_ms_since_boot(get_absolute_time());
+    }
+}
+
+void loop_profile_set_alert(uint32_t threshold_us, loop_alert_fn fn) {
+    prof.alert_us = threshold_us;
+    prof.alert = fn;
+}
+
+const loop_profile_stats_t *loop_profile_get(void) {
+    return &prof.stats;
+}
+
+const char *loop_phase_name(loop_phase_t phase) {
+    return phase_names[phase];
+}
+
+void loop_profile_print(void) {
+    const loop_profile_stats_t *s = &prof.stats;
+    printf("loop: iterations=%u overruns=%u (budget %u us)\n",
+        (unsigned)s->iterations, (unsigned)s->overruns, (unsigned)LOOP_BUDGET_US);
+    printf("loop: longest %u us at %u ms:", (unsigned)s->longest.total_us, (unsigned)s->longest.at_ms);
+    for (int i = 0; i < LOOP_PHASE_COUNT; i++) {
+        printf(" %s=%u", phase_names[i], (unsigned)s->longest.phase_us[i]);
+    }
+    printf("\n");
+    for (int i = 0; i < LOOP_PHASE_COUNT; i++) {
+        printf("loop: phase %-8s max=%u us alerts=%u\n", phase_names[i],
+            (unsigned)s->phase_max_us[i], (unsigned)s->alerts[i]);
+    }
+}
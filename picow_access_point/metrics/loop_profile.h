@@ -0,0 +1,64 @@
+/**
+ * Perfil do laço principal e detector de travamentos.
+ *
+ * O laço marca o início de cada iteração e de cada fase; o perfil mede a
+ * duração da iteração (histograma LOOP_ITERATION em latency.h), conta as
+ * iterações cujo trabalho (tudo menos a fase de espera) estourou o orçamento
+ * de LOOP_BUDGET_US e guarda a iteração mais longa com o tempo de cada fase.
+ * Opcionalmente avisa quando uma única fase passa de um limite.
+ */
+#ifndef _LOOP_PROFILE_H_
+#define _LOOP_PROFILE_H_
+
+#include <stdint.h>
+
+// Orçamento de uma iteração (o laço espera até 10 ms por trabalho)
+#ifndef LOOP_BUDGET_US
+#define LOOP_BUDGET_US 10000
+#endif
+
+// Limite do alerta por fase; 0 desliga
+#ifndef LOOP_ALERT_US
+#define LOOP_ALERT_US 50000
+#endif
+
+typedef enum {
+    LOOP_PHASE_ALARM,       // LED e buzzer
+    LOOP_PHASE_DISPLAY,     // Desenho e envio I2C do display
+    LOOP_PHASE_POLL,        // cyw43_arch_poll (lwIP, DHCP, DNS, HTTP)
+    LOOP_PHASE_WORK,        // Trabalho adiado pelos callbacks (work_queue.h)
+    LOOP_PHASE_WAIT,        // Espera por trabalho / sleep
+    LOOP_PHASE_COUNT
+} loop_phase_t;
+
+typedef struct {
+    uint32_t total_us;
+    uint32_t phase_us[LOOP_PHASE_COUNT];
+    uint32_t at_ms;         // Instante em que a iteração terminou
+} loop_stall_t;
+
+typedef struct {
+    uint32_t iterations;
+    uint32_t overruns;
+    uint32_t alerts[LOOP_PHASE_COUNT];
+    uint32_t phase_max_us[LOOP_PHASE_COUNT];
+    loop_stall_t longest;
+} loop_profile_stats_t;
+
+typedef void (*loop_alert_fn)(loop_phase_t phase, uint32_t us);
+
+// Abre uma iteração; a fase inicial é a primeira marcada
+void loop_profile_begin(void);
+// Fecha a fase atual e abre a próxima
+void loop_profile_phase(loop_phase_t phase);
+// Fecha a última fase e a iteração
+void loop_profile_end(void);
+
+// Troca o limite e o callback do alerta (NULL volta ao printf padrão)
+void loop_profile_set_alert(uint32_t threshold_us, loop_alert_fn fn);
+
+const loop_profile_stats_t *loop_profile_get(void);
+const char *loop_phase_name(loop_phase_t phase);
+void loop_profile_print(void);
+
+#endif
@@ -0,0 +1,311 @@
+/**
+ * Telemetria de memória em tempo de execução (ver metrics.h).
+ */
+#include <stdio.h>
+#include <stdarg.h>
+#include <malloc.h>
+
+#include "pico/stdlib.h"
+#include "lwip/stats.h"
+#include "lwip/memp.h"
+#include "metrics.h"
+#include "latency.h"
+#include "loop_profile.h"
+#include "stack_profile.h"
+#include "alarm.h"
+#include "work_queue.h"
+#include "http_request.h"
+#include "http_arena.h"
+#include "tcp_states.h"
+#include "ratelimit.h"
+#include "heap.h"
+
+// Nomes dos pools na mesma ordem do enum memp_t
+static const char *const memp_names[] = {
+#define LWIP_MEMPOOL(name, num, size, desc) #name,
+#include "lwip/priv/memp_std.h"
+};
+
+static struct {
+    size_t heap_used;
+    size_t heap_max;
+    uint32_t heap_alloc_failures;
+} app_heap;
+
+void metrics_heap_sample(void) {
+#if PICOW_HEAP_TLSF
+    // O pool TLSF guarda o uso exato; o malloc da newlib quase não é usado
+    heap_stats_t hs;
+    heap_get_stats(&hs);
+    size_t used = hs.used;
+#elif defined(__GLIBC__)
+    size_t used = mallinfo2().uordblks;
+#else
+    size_t used = mallinfo().uordblks;
+#endif
+    app_heap.heap_used = used;
+    if (used > app_heap.heap_max) {
+        app_heap.heap_max = used;
+    }
+}
+
+void metrics_heap_alloc_failed(void) {
+    app_heap.heap_alloc_failures++;
+}
+
+// Cada out_printf é um registro: uma amostra ou o par HELP/TYPE de uma
+// família. Uma passada gera todos e copia para buf os registros inteiros a
+// partir de first, até o primeiro que não couber
+typedef struct {
+    char *buf;
+    size_t len;
+    size_t pos;
+    uint32_t record;        // Registros gerados nesta passada
+    uint32_t first;
+    uint32_t next;          // Primeiro registro não copiado
+    bool full;
+} metrics_out_t;
+
+static void out_printf(metrics_out_t *o, const char *fmt, ...) {
+    uint32_t record = o->record++;
+    if (record < o->first || o->full) {
+        return;
+    }
+    size_t room = o->len - o->pos;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(o->buf + o->pos, room, fmt, ap);
+    va_end(ap);
+    if (n < 0) {
+        n = 0;
+    }
+    if ((size_t)n >= room) {
+        if (o->pos > 0) {
+            // Fica para a próxima chamada
+            o->buf[o->pos] = 0;
+            o->full = true;
+            return;
+        }
+        // Maior que buf inteiro: vai truncado, ainda terminado em '\n'
+        printf("metrics record %u truncated (%d bytes)\n", (unsigned)record, n);
+        n = (int)room - 1;
+        o->buf[n - 1] = '\n';
+    }
+    o->pos += n;
+    o->next = record + 1;
+}
+
+static void out_header(metrics_out_t *o, const char *name, const char *type, const char *help) {
+    out_printf(o, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+size_t metrics_render(uint32_t *next, char *buf, size_t len) {
+    metrics_out_t o = { .buf = buf, .len = len, .first = *next, .next = *next };
+    if (len < 2) {
+        return 0;
+    }
+    buf[0] = 0;
+
+    metrics_heap_sample();
+    out_header(&o, "picow_uptime_seconds", "counter", "Time since boot");
+    out_printf(&o, "picow_uptime_seconds %u\n", (unsigned)(to_ms_since_boot(get_absolute_time()) / 1000));
+
+    out_header(&o, "picow_heap_used_bytes", "gauge", "Application heap in use (sampled)");
+    out_printf(&o, "picow_heap_used_bytes %u\n", (unsigned)app_heap.heap_used);
+    out_header(&o, "picow_heap_max_bytes", "gauge", "Application heap high-water mark (sampled)");
+    out_printf(&o, "picow_heap_max_bytes %u\n", (unsigned)app_heap.heap_max);
+    out_header(&o, "picow_heap_alloc_failures_total", "counter", "Failed application allocations");
+    out_printf(&o, "picow_heap_alloc_failures_total %u\n", (unsigned)app_heap.heap_alloc_failures);
+
+#if PICOW_HEAP_TLSF
+    heap_stats_t heap;
+    heap_get_stats(&heap);
+    out_header(&o, "picow_heap_size_bytes", "gauge", "TLSF heap pool size");
+    out_printf(&o, "picow_heap_size_bytes %u\n", (unsigned)heap.size);
+    out_header(&o, "picow_heap_free_bytes", "gauge", "Free bytes in the TLSF heap");
+    out_printf(&o, "picow_heap_free_bytes %u\n", (unsigned)heap.free_bytes);
+    out_header(&o, "picow_heap_largest_free_bytes", "gauge", "Largest free block in the TLSF heap");
+    out_printf(&o, "picow_heap_largest_free_bytes %u\n", (unsigned)heap.largest_free);
+    out_header(&o, "picow_heap_free_blocks", "gauge", "Free blocks in the TLSF heap");
+    out_printf(&o, "picow_heap_free_blocks %u\n", (unsigned)heap.free_blocks);
+    out_header(&o, "picow_heap_fragmentation_ratio", "gauge", "1 - largest free block / free bytes");
+    out_printf(&o, "picow_heap_fragmentation_ratio %u.%03u\n", (unsigned)heap_fragmentation_permille(&heap) / 1000,
+               (unsigned)heap_fragmentation_permille(&heap) % 1000);
+    out_header(&o, "picow_heap_tlsf_failures_total", "counter", "TLSF allocations with no block large enough (lwIP included)");
+    out_printf(&o, "picow_heap_tlsf_failures_total %u\n", (unsigned)heap.failures);
+#endif
+
+#if LWIP_STATS && MEM_STATS
+    out_header(&o, "picow_lwip_mem_avail_bytes", "gauge", "lwIP heap size (MEM_SIZE)");
+    out_printf(&o, "picow_lwip_mem_avail_bytes %u\n", (unsigned)lwip_stats.mem.avail);
+    out_header(&o, "picow_lwip_mem_used_bytes", "gauge", "lwIP heap in use");
+    out_printf(&o, "picow_lwip_mem_used_bytes %u\n", (unsigned)lwip_stats.mem.used);
+    out_header(&o, "picow_lwip_mem_max_bytes", "gauge", "lwIP heap high-water mark");
+    out_printf(&o, "picow_lwip_mem_max_bytes %u\n", (unsigned)lwip_stats.mem.max);
+    out_header(&o, "picow_lwip_mem_err_total", "counter", "lwIP heap allocation failures");
+    out_printf(&o, "picow_lwip_mem_err_total %u\n", (unsigned)lwip_stats.mem.err);
+#endif
+
+#if LWIP_STATS && MEMP_STATS
+    static const struct {
+        const char *name;
+        const char *type;
+        const char *help;
+    } memp_metrics[] = {
+        { "picow_lwip_memp_avail", "gauge", "Pool size" },
+        { "picow_lwip_memp_used", "gauge", "Pool elements in use" },
+        { "picow_lwip_memp_max", "gauge", "Pool high-water mark" },
+        { "picow_lwip_memp_err_total", "counter", "Pool allocation failures" },
+    };
+    for (size_t m = 0; m < count_of(memp_metrics); m++) {
+        out_header(&o, memp_metrics[m].name, memp_metrics[m].type, memp_metrics[m].help);
+        for (int i = 0; i < MEMP_MAX; i++) {
+            const struct stats_mem *s = lwip_stats.memp[i];
+            unsigned v = m == 0 ? s->avail : m == 1 ? s->used : m == 2 ? s->max : s->err;
+            out_printf(&o, "%s{pool=\"%s\"} %u\n", memp_metrics[m].name, memp_names[i], v);
+        }
+    }
+#endif
+
+    // Histogramas de latência com todos os baldes, mesmo vazios: o número de
+    // registros não pode mudar entre as chamadas de uma mesma resposta
+    out_header(&o, "picow_latency_us", "histogram", "Callback and main-loop phase duration");
+    for (int i = 0; i < LATENCY_PROBE_COUNT; i++) {
+        const latency_hist_t *h = latency_get(i);
+        const char *probe = latency_probe_name(i);
+        uint32_t cumulative = 0;
+        for (int b = 0; b < LATENCY_BUCKETS - 1; b++) {
+            cumulative += h->buckets[b];
+            out_printf(&o, "picow_latency_us_bucket{probe=\"%s\",le=\"%u\"} %u\n",
+                probe, (unsigned)latency_bucket_le(b), (unsigned)cumulative);
+        }
+        out_printf(&o, "picow_latency_us_bucket{probe=\"%s\",le=\"+Inf\"} %u\n", probe, (unsigned)h->count);
+        out_printf(&o, "picow_latency_us_sum{probe=\"%s\"} %llu\n", probe, (unsigned long long)h->sum_us);
+        out_printf(&o, "picow_latency_us_count{probe=\"%s\"} %u\n", probe, (unsigned)h->count);
+    }
+    out_header(&o, "picow_latency_max_us", "gauge", "Longest duration seen per probe");
+    for (int i = 0; i < LATENCY_PROBE_COUNT; i++) {
+        out_printf(&o, "picow_latency_max_us{probe=\"%s\"} %u\n", latency_probe_name(i), (unsigned)latency_get(i)->max_us);
+    }
+
+    const loop_profile_stats_t *lp = loop_profile_get();
+    out_header(&o, "picow_loop_iterations_total", "counter", "Main-loop iterations");
+    out_printf(&o, "picow_loop_iterations_total %u\n", (unsigned)lp->iterations);
+    out_header(&o, "picow_loop_overruns_total", "counter", "Iterations whose work exceeded the loop budget");
+    out_printf(&o, "picow_loop_overruns_total %u\n", (unsigned)lp->overruns);
+    out_header(&o, "picow_loop_longest_stall_us", "gauge", "Per-phase time of the longest iteration");
+    for (int i = 0; i < LOOP_PHASE_COUNT; i++) {
+        out_printf(&o, "picow_loop_longest_stall_us{phase=\"%s\"} %u\n", loop_phase_name(i), (unsigned)lp->longest.phase_us[i]);
+    }
+    out_header(&o, "picow_loop_phase_alerts_total", "counter", "Phases that exceeded the alert threshold");
+    for (int i = 0; i < LOOP_PHASE_COUNT; i++) {
+        out_printf(&o, "picow_loop_phase_alerts_total{phase=\"%s\"} %u\n", loop_phase_name(i), (unsigned)lp->alerts[i]);
+    }
+
+    alarm_state_t alarm;
+    alarm_get_state(&alarm);
+    out_header(&o, "picow_alarm_commands_total", "counter", "Alarm commands applied by the engine");
+    out_printf(&o, "picow_alarm_commands_total %u\n", (unsigned)alarm.commands);
+    out_header(&o, "picow_alarm_commands_dropped_total", "counter", "Alarm commands lost to a full queue");
+    out_printf(&o, "picow_alarm_commands_dropped_total %u\n", (unsigned)alarm.dropped);
+
+    work_queue_stats_t work;
+    work_queue_get_stats(&work);
+    out_header(&o, "picow_work_posted_total", "counter", "Work items deferred by lwIP callbacks");
+    out_printf(&o, "picow_work_posted_total %u\n", (unsigned)work.posted);
+    out_header(&o, "picow_work_run_total", "counter", "Deferred work items run by the main loop");
+    out_printf(&o, "picow_work_run_total %u\n", (unsigned)work.ran);
+    out_header(&o, "picow_work_full_total", "counter", "Work items done inline because the queue was full");
+    out_printf(&o, "picow_work_full_total %u\n", (unsigned)work.full);
+    out_header(&o, "picow_work_depth_max", "gauge", "Deepest work queue seen");
+    out_printf(&o, "picow_work_depth_max %u\n", (unsigned)work.max_depth);
+
+    static const char *const evict_reasons[HTTP_EVICT_COUNT] = { "deadline", "pressure" };
+    http_request_stats_t http;
+    http_request_get_stats(&http);
+    out_header(&o, "picow_http_requests_total", "counter", "HTTP requests read completely");
+    out_printf(&o, "picow_http_requests_total %u\n", (unsigned)http.completed);
+    out_header(&o, "picow_http_evicted_total", "counter", "Connections dropped before the request was complete");
+    for (int r = 0; r < HTTP_EVICT_COUNT; r++) {
+        for (int ph = 0; ph < HTTP_PHASE_RESPONSE; ph++) {
+            out_printf(&o, "picow_http_evicted_total{reason=\"%s\",phase=\"%s\"} %u\n",
+                       evict_reasons[r], http_phase_name(ph), (unsigned)http.evicted[r][ph]);
+        }
+    }
+
+    // Pico de uso da arena por requisição, para dimensionar HTTP_ARENA_SIZE
+    http_arena_stats_t arena;
+    http_arena_get_stats(&arena);
+    out_header(&o, "picow_http_arena_size_bytes", "gauge", "Per-connection request arena size");
+    out_printf(&o, "picow_http_arena_size_bytes %u\n", (unsigned)arena.size);
+    out_header(&o, "picow_http_arena_peak_bytes", "gauge", "Largest arena use by a single request");
+    out_printf(&o, "picow_http_arena_peak_bytes %u\n", (unsigned)arena.peak);
+    out_header(&o, "picow_http_arena_failures_total", "counter", "Arena allocations refused for lack of space");
+    out_printf(&o, "picow_http_arena_failures_total %u\n", (unsigned)arena.failures);
+    out_header(&o, "picow_http_arena_used_bytes", "histogram", "Arena high-water mark per request");
+    uint32_t arena_cumulative = 0;
+    for (int b = 0; b < HTTP_ARENA_BUCKETS; b++) {
+        arena_cumulative += arena.buckets[b];
+        out_printf(&o, "picow_http_arena_used_bytes_bucket{le=\"%u\"} %u\n", (unsigned)http_arena_bucket_le(b),
+                   (unsigned)arena_cumulative);
+    }
+    out_printf(&o, "picow_http_arena_used_bytes_bucket{le=\"+Inf\"} %u\n", (unsigned)arena.requests);
+    out_printf(&o, "picow_http_arena_used_bytes_sum %u\n", (unsigned)arena.peak_sum);
+    out_printf(&o, "picow_http_arena_used_bytes_count %u\n", (unsigned)arena.requests);
+
+    // Última amostra do servidor (tcp_states.h): as listas do lwIP só podem
+    // ser percorridas no contexto dele
+    const tcp_states_stats_t *tcp = tcp_states_get();
+    out_header(&o, "picow_tcp_pcbs", "gauge", "TCP PCBs per state at the last accept or close");
+    for (int i = 0; i < TCP_STATE_COUNT; i++) {
+        out_printf(&o, "picow_tcp_pcbs{state=\"%s\"} %u\n", tcp_state_label(i), (unsigned)tcp->now[i]);
+    }
+    out_header(&o, "picow_tcp_pcbs_max", "gauge", "Most TCP PCBs seen per state");
+    for (int i = 0; i < TCP_STATE_COUNT; i++) {
+        out_printf(&o, "picow_tcp_pcbs_max{state=\"%s\"} %u\n", tcp_state_label(i), (unsigned)tcp->peak[i]);
+    }
+    out_header(&o, "picow_tcp_closes_total", "counter", "HTTP connections closed, by who closed first");
+    for (int k = 0; k < TCP_CLOSE_COUNT; k++) {
+        out_printf(&o, "picow_tcp_closes_total{by=\"%s\"} %u\n", tcp_close_kind_name(k), (unsigned)tcp->closes[k]);
+    }
+
+    rate_limit_stats_t rate;
+    rate_limit_get_stats(&rate);
+    out_header(&o, "picow_ratelimit_allowed_total", "counter", "Packets or connections within the per-client limit");
+    for (int i = 0; i < RATE_LIMIT_SERVICE_COUNT; i++) {
+        out_printf(&o, "picow_ratelimit_allowed_total{service=\"%s\"} %u\n", rate_limit_service_name(i), (unsigned)rate.allowed[i]);
+    }
+    out_header(&o, "picow_ratelimit_dropped_total", "counter", "Packets or connections dropped by the per-client limit");
+    for (int i = 0; i < RATE_LIMIT_SERVICE_COUNT; i++) {
+        out_printf(&o, "picow_ratelimit_dropped_total{service=\"%s\"} %u\n", rate_limit_service_name(i), (unsigned)rate.dropped[i]);
+    }
+    out_header(&o, "picow_ratelimit_entries", "gauge", "Clients tracked by the rate limiter");
+    out_printf(&o, "picow_ratelimit_entries %u\n", (unsigned)rate.entries);
+    out_header(&o, "picow_ratelimit_limited_entries", "gauge", "Tracked clients that have been limited");
+    out_printf(&o, "picow_ratelimit_limited_entries %u\n", (unsigned)rate.limited);
+    out_header(&o, "picow_ratelimit_evictions_total", "counter", "Rate limiter entries reused because the table was full");
+    out_printf(&o, "picow_ratelimit_evictions_total %u\n", (unsigned)rate.evictions);
+    out_header(&o, "picow_ratelimit_overflow_total", "counter", "Packets charged to the shared bucket because no entry was idle");
+    out_printf(&o, "picow_ratelimit_overflow_total %u\n", (unsigned)rate.overflowed);
+
+#if PICOW_STACK_PROFILE
+    out_header(&o, "picow_stack_size_bytes", "gauge", "Physical stack size per context");
+    for (int i = 0; i < STACK_CTX_COUNT; i++) {
+        out_printf(&o, "picow_stack_size_bytes{context=\"%s\"} %u\n", stack_ctx_name(i), (unsigned)stack_profile_get(i)->size);
+    }
+    out_header(&o, "picow_stack_peak_bytes", "gauge", "Deepest stack use seen per context (painted)");
+    for (int i = 0; i < STACK_CTX_COUNT; i++) {
+        out_printf(&o, "picow_stack_peak_bytes{context=\"%s\"} %u\n", stack_ctx_name(i), (unsigned)stack_profile_get(i)->peak);
+    }
+#endif
+    *next = o.next;
+    return o.pos;
+}
+
+void metrics_print(void) {
+    char buf[METRICS_PRINT_BUF];
+    uint32_t next = 0;
+    while (metrics_render(&next, buf, sizeof(buf)) > 0) {
+        printf("%s", buf);
+    }
+}
@@ -0,0 +1,36 @@
+/**
+ * Telemetria de memória em tempo de execução.
+ *
+ * Contadores do heap do lwIP e de cada pool memp (uso atual, pico e falhas de
+ * alocação), mantidos pelo próprio lwIP (MEM_STATS/MEMP_STATS, ligados em
+ * todos os builds), mais o heap da aplicação. Exportados no formato texto do
+ * Prometheus em /metrics e no console (tecla 'm'), junto com os histogramas
+ * de latência de latency.h.
+ */
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define METRICS_PATH "/metrics"
+#define METRICS_CONTENT_TYPE "text/plain; version=0.0.4"
+
+// Amostra o heap da aplicação; chamar logo após alocações relevantes
+void metrics_heap_sample(void);
+void metrics_heap_alloc_failed(void);
+
+// Buffer de metrics_print, na pilha do console
+#define METRICS_PRINT_BUF 256
+
+// Gera o texto a partir do registro *next (uma amostra ou o par HELP/TYPE de
+// uma família) e copia para buf, terminados em zero, os registros inteiros
+// que couberem; avança *next e retorna os bytes copiados, 0 no fim. Não há
+// buffer do texto inteiro: cada chamada gera tudo de novo, pulando sem
+// formatar os registros anteriores, e o número de registros não depende do
+// estado. Um registro maior que buf sai truncado.
+size_t metrics_render(uint32_t *next, char *buf, size_t len);
+
+void metrics_print(void);
+
+#endif
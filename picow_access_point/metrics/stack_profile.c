@@ -0,0 +1,124 @@
+/**
+ * Pintura de pilha (ver stack_profile.h).
+ */
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "stack_profile.h"
+
+#define STACK_PAINT         0xC5C5C5C5u
+// Folga abaixo do SP atual que não é pintada (quadro do próprio probe)
+#define STACK_PAINT_GUARD   64
+
+static const char *const ctx_names[STACK_CTX_COUNT] = {
+    [STACK_CTX_MAIN] = "main",
+    [STACK_CTX_IRQ] = "irq",
+    [STACK_CTX_CORE1] = "core1",
+};
+
+static stack_ctx_stats_t ctx_stats[STACK_CTX_COUNT];
+
+#if PICOW_STACK_PROFILE
+// Definidos pelo linker script do SDK
+extern uint32_t __StackBottom[], __StackTop[];
+extern uint32_t __StackOneBottom[], __StackOneTop[];
+
+static inline uintptr_t current_sp(void) {
+    uintptr_t sp;
+    __asm volatile ("mov %0, sp" : "=r" (sp));
+    return sp;
+}
+
+static stack_ctx_t current_ctx(void) {
+    if (__get_current_exception()) {
+        return STACK_CTX_IRQ;
+    }
+    return get_core_num() ? STACK_CTX_CORE1 : STACK_CTX_MAIN;
+}
+
+// Main e interrupções do core 0 compartilham a MSP
+static void stack_bounds(stack_ctx_t ctx, uint32_t **bottom, uint32_t **top) {
+    if (ctx == STACK_CTX_CORE1) {
+        *bottom = __StackOneBottom;
+        *top = __StackOneTop;
+    } else {
+        *bottom = __StackBottom;
+        *top = __StackTop;
+    }
+}
+
+static void paint(uint32_t *from, uintptr_t below) {
+    for (uint32_t *w = from; (uintptr_t)w < below; w++) {
+        *w = STACK_PAINT;
+    }
+}
+
+static uint32_t *lowest_used(uint32_t *bottom, uintptr_t limit) {
+    uint32_t *w = bottom;
+    while ((uintptr_t)w < limit && *w == STACK_PAINT) {
+        w++;
+    }
+    return w;
+}
+
+void stack_profile_init(void) {
+    for (int i = 0; i < STACK_CTX_COUNT; i++) {
+        uint32_t *bottom, *top;
+        stack_bounds(i, &bottom, &top);
+        ctx_stats[i].size = (uintptr_t)top - (uintptr_t)bottom;
+    }
+    paint(__StackBottom, current_sp() - STACK_PAINT_GUARD);
+    // O core 1 ainda não foi iniciado: a pilha inteira está livre
+    paint(__StackOneBottom, (uintptr_t)__StackOneTop);
+}
+
+uintptr_t stack_probe_enter(void) {
+    uint32_t *bottom, *top;
+    uintptr_t sp = current_sp();
+    stack_bounds(current_ctx(), &bottom, &top);
+    if (sp - STACK_PAINT_GUARD > (uintptr_t)bottom) {
+        paint(bottom, sp - STACK_PAINT_GUARD);
+    }
+    return sp;
+}
+
+void stack_probe_exit(uintptr_t token) {
+    stack_ctx_t ctx = current_ctx();
+    uint32_t *bottom, *top;
+    stack_bounds(ctx, &bottom, &top);
+    uint32_t *low = lowest_used(bottom, token);
+    stack_ctx_stats_t *s = &ctx_stats[ctx];
+    uint32_t peak = (uintptr_t)top - (uintptr_t)low;
+    uint32_t region = token - (uintptr_t)low;
+    s->samples++;
+    if (peak > s->peak) {
+        s->peak = peak;
+    }
+    if (region > s->region_peak) {
+        s->region_peak = region;
+    }
+    if (low == bottom) {
+        s->overflow = true;
+    }
+}
+#endif
+
+const char *stack_ctx_name(stack_ctx_t ctx) {
+    return ctx_names[ctx];
+}
+
+const stack_ctx_stats_t *stack_profile_get(stack_ctx_t ctx) {
+    return &ctx_stats[ctx];
+}
+
+void stack_profile_print(void) {
+#if PICOW_STACK_PROFILE
+    for (int i = 0; i < STACK_CTX_COUNT; i++) {
+        const stack_ctx_stats_t *s = &ctx_stats[i];
+        printf("stack %-5s peak=%u/%u region=%u samples=%u%s\n", ctx_names[i], (unsigned)s->peak,
+            (unsigned)s->size, (unsigned)s->region_peak, (unsigned)s->samples, s->overflow ? " OVERFLOW" : "");
+    }
+#else
+    printf("stack profile disabled\n");
+#endif
+}
@@ -0,0 +1,61 @@
+/**
+ * Pintura de pilha e high-water mark por contexto de execução.
+ *
+ * No boot as pilhas livres são preenchidas com um padrão. Trechos de código
+ * envolvidos por stack_probe_enter()/stack_probe_exit() repintam a área abaixo
+ * do SP de entrada e, na saída, procuram a palavra mais baixa alterada: a
+ * diferença é o uso do trecho. O contexto é detectado em tempo de execução
+ * (IPSR para interrupção, núcleo para core 1), então os callbacks do lwIP são
+ * atribuídos a "irq" no build background e a "main" no build poll. O pico de
+ * "main" inclui as interrupções que chegaram durante o trecho, pois as duas
+ * usam a mesma pilha (MSP).
+ *
+ * Só existe no dispositivo (PICO_ON_DEVICE); no build host as funções são
+ * vazias. PICOW_STACK_PROFILE=0 também desliga.
+ */
+#ifndef _STACK_PROFILE_H_
+#define _STACK_PROFILE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef PICOW_STACK_PROFILE
+#define PICOW_STACK_PROFILE PICO_ON_DEVICE
+#endif
+
+typedef enum {
+    STACK_CTX_MAIN,
+    STACK_CTX_IRQ,
+    STACK_CTX_CORE1,
+    STACK_CTX_COUNT
+} stack_ctx_t;
+
+typedef struct {
+    uint32_t size;          // Tamanho da pilha física do contexto
+    uint32_t peak;          // Maior profundidade absoluta (topo até o ponto mais baixo)
+    uint32_t region_peak;   // Maior uso de um único trecho medido
+    uint32_t samples;
+    bool overflow;          // O padrão no fundo da pilha foi sobrescrito
+} stack_ctx_stats_t;
+
+#if PICOW_STACK_PROFILE
+// Pinta as pilhas livres; chamar no início de main()
+void stack_profile_init(void);
+uintptr_t stack_probe_enter(void);
+void stack_probe_exit(uintptr_t token);
+#else
+static inline void stack_profile_init(void) {
+}
+static inline uintptr_t stack_probe_enter(void) {
+    return 0;
+}
+static inline void stack_probe_exit(uintptr_t token) {
+    (void)token;
+}
+#endif
+
+const char *stack_ctx_name(stack_ctx_t ctx);
+const stack_ctx_stats_t *stack_profile_get(stack_ctx_t ctx);
+void stack_profile_print(void);
+
+#endif
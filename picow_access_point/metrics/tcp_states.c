@@ -0,0 +1,69 @@
+/**
+ * Estados dos PCBs TCP (ver tcp_states.h).
+ */
+#include "lwip/priv/tcp_priv.h"
+#include "tcp_states.h"
+
+static tcp_states_stats_t stats;
+
+static void count_list(uint16_t *now, struct tcp_pcb *list) {
+    for (struct tcp_pcb *pcb = list; pcb; pcb = pcb->next) {
+        if ((unsigned)pcb->state < TCP_STATE_COUNT) {
+            now[pcb->state]++;
+        }
+    }
+}
+
+void tcp_states_sample(void) {
+    uint16_t now[TCP_STATE_COUNT] = { 0 };
+    count_list(now, tcp_active_pcbs);
+    count_list(now, tcp_tw_pcbs);
+    count_list(now, tcp_bound_pcbs);
+    for (struct tcp_pcb_listen *lpcb = tcp_listen_pcbs.listen_pcbs; lpcb; lpcb = lpcb->next) {
+        now[LISTEN]++;
+    }
+    for (int i = 0; i < TCP_STATE_COUNT; i++) {
+        stats.now[i] = now[i];
+        if (now[i] > stats.peak[i]) {
+            stats.peak[i] = now[i];
+        }
+    }
+    stats.samples++;
+}
+
+void tcp_states_closed(tcp_close_kind_t kind) {
+    if ((unsigned)kind < TCP_CLOSE_COUNT) {
+        stats.closes[kind]++;
+    }
+}
+
+const tcp_states_stats_t *tcp_states_get(void) {
+    return &stats;
+}
+
+const char *tcp_state_label(int state) {
+    static const char *const labels[TCP_STATE_COUNT] = {
+        [CLOSED] = "closed",
+        [LISTEN] = "listen",
+        [SYN_SENT] = "syn_sent",
+        [SYN_RCVD] = "syn_rcvd",
+        [ESTABLISHED] = "established",
+        [FIN_WAIT_1] = "fin_wait_1",
+        [FIN_WAIT_2] = "fin_wait_2",
+        [CLOSE_WAIT] = "close_wait",
+        [CLOSING] = "closing",
+        [LAST_ACK] = "last_ack",
+        [TIME_WAIT] = "time_wait",
+    };
+    return (unsigned)state < TCP_STATE_COUNT ? labels[state] : "?";
+}
+
+const char *tcp_close_kind_name(tcp_close_kind_t kind) {
+    static const char *const names[TCP_CLOSE_COUNT] = {
+        [TCP_CLOSE_BY_CLIENT] = "client",
+        [TCP_CLOSE_BY_SERVER] = "server",
+        [TCP_CLOSE_LINGER_TIMEOUT] = "linger_timeout",
+        [TCP_CLOSE_RESET] = "reset",
+    };
+    return (unsigned)kind < TCP_CLOSE_COUNT ? names[kind] : "?";
+}
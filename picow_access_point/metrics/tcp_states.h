@@ -0,0 +1,47 @@
+/**
+ * Estados dos PCBs TCP e de quem fecha as conexões.
+ *
+ * tcp_states_sample() percorre as listas de PCBs do lwIP (ativos, TIME_WAIT,
+ * listeners) e conta quantos há em cada estado, guardando o pico de cada um.
+ * Precisa do contexto do lwIP (callbacks ou cyw43_arch_lwip_begin), então o
+ * servidor amostra a cada conexão aceita e a cada fechamento; /metrics e o
+ * console mostram a última amostra.
+ *
+ * Quem fecha primeiro fica com o TIME_WAIT (2 * TCP_MSL): o servidor conta
+ * os fechamentos por lado para mostrar se os clientes estão fechando antes.
+ */
+#ifndef _TCP_STATES_H_
+#define _TCP_STATES_H_
+
+#include <stdint.h>
+
+#include "lwip/tcp.h"
+
+// CLOSED .. TIME_WAIT de enum tcp_state
+#define TCP_STATE_COUNT (TIME_WAIT + 1)
+
+typedef enum {
+    TCP_CLOSE_BY_CLIENT,        // FIN do cliente primeiro: aqui só LAST_ACK
+    TCP_CLOSE_BY_SERVER,        // Resposta sem tamanho, erro ou inatividade
+    TCP_CLOSE_LINGER_TIMEOUT,   // Cliente não fechou depois da resposta
+    TCP_CLOSE_RESET,            // RST enviado ou recebido, ou abortada pelo lwIP
+    TCP_CLOSE_COUNT,
+} tcp_close_kind_t;
+
+typedef struct {
+    uint16_t now[TCP_STATE_COUNT];
+    uint16_t peak[TCP_STATE_COUNT];
+    uint32_t samples;
+    uint32_t closes[TCP_CLOSE_COUNT];
+} tcp_states_stats_t;
+
+// Só no contexto do lwIP
+void tcp_states_sample(void);
+
+void tcp_states_closed(tcp_close_kind_t kind);
+
+const tcp_states_stats_t *tcp_states_get(void);
+const char *tcp_state_label(int state);
+const char *tcp_close_kind_name(tcp_close_kind_t kind);
+
+#endif
@@ -7,34 +7,31 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "pico/cyw43_arch.h"
-#include "hardware/pwm.h"
-#include "hardware/irq.h"
-#include "hardware/i2c.h"
 #include "lwip/pbuf.h"
 #include "lwip/tcp.h"
+#include "lwip/sys.h"
 #include "dhcpserver.h"
 #include "dnsserver.h"
-#include "inc/ssd1306.h"
-
-// =============================================
-// Configurações de Hardware
-// =============================================
-
-// Configuração dos GPIOs
-#define RED_LED_GPIO       13      // Pino do LED vermelho do alarme
-#define PWM_GPIO          21      // Pino do buzzer (PWM)
-#define I2C_SDA           14      // Pino I2C SDA para o display
-#define I2C_SCL           15      // Pino I2C SCL para o display
-
-// Configuração do Buzzer PWM
-#define PWM_FREQ_HZ       1000    // Frequência do bipe em Hz (1 kHz)
-#define CLOCK_DIV         2.0f    // Divisor ajustado para evitar overflow
-#define PWM_WRAP          (uint16_t)(125000000 / (PWM_FREQ_HZ * CLOCK_DIV))  // = 62500
-#define BEEP_DURATION_MS  200     // Duração de cada bipe em ms
-#define BEEP_INTERVAL_MS  100     // Intervalo entre bipes em ms
-
-// Configuração do Display OLED
-#define SSD1306_I2C_ADDR  0x3C    // Endereço I2C do display OLED
+#include "metrics.h"
+#include "latency.h"
+#include "loop_profile.h"
+#include "stack_profile.h"
+#include "alarm.h"
+#include "work_queue.h"
+#include "http_handler.h"
+#include "http_routes.h"
+#include "web_assets.h"
+#include "http_templates.h"
+#include "http_form.h"
+#include "http_request.h"
+#include "tcp_states.h"
+#include "ratelimit.h"
+#include "heap.h"
+#if PICO_CYW43_ARCH_FREERTOS
+#include "FreeRTOS.h"
+#include "task.h"
+#include "rtos_tasks.h"
+#endif
 
 // =============================================
 // Configurações de Rede
@@ -50,119 +47,86 @@
 // =============================================
 #define TEMPO_POLLING     5
 #define HTTP_GET          "GET"
-#define HTTP_RESPONSE_HEADERS "HTTP/1.1 %d OK\nContent-Length: %d\nContent-Type: text/html; charset=utf-8\nConnection: close\n\n"
-#define ALARM_CONTROL_BODY "<html><body style=\"text-align:center;margin-top:50px\">" \
-"<h1>Alarme</h1>" \
-"<p>%s</p>" \
-"<a href=\"?alarm=%d\" style=\"background:#4CAF50;color:white;padding:5px 10px;text-decoration:none\">%s</a>" \
-"</body></html>"
-#define ALARM_PARAM       "alarm=%d"
-#define ALARM_CONTROL     "/alarm"
-#define HTTP_RESPONSE_REDIRECT "HTTP/1.1 302 Redirect\nLocation: http://%s" ALARM_CONTROL "\n\n"
+// Headers, página do alarme, redirecionamento e página de erro vêm de
+// templates/ (tools/gen_templates.py)
+#define HTML_CONTENT_TYPE "text/html; charset=utf-8"
+#define ALARM_PARAM       "alarm"
+#define ALARM_PARAM_TEST  2       // ?alarm=2 (ou alarm=test) dispara um bipe de teste
+#define ALARM_CONTROL     "/alarm"  // Controle sem JavaScript
+#define DASHBOARD         "/"       // Painel (web/index.html, ver tools/gen_assets.py)
+#define ALARM_EVENT       "data: {\"active\":%d,\"testing\":%d,\"commands\":%lu}\n\n"
+#define EVENT_STREAM_CONTENT_TYPE "text/event-stream"
+#define ALARM_EVENTS_MAX_MS 60000  // O EventSource do navegador reconecta sozinho
+// API JSON (/api/state, /api/alarm): sempre com Content-Length e com o motivo
+// do status, que aqui também pode ser 4xx/5xx
+#define JSON_CONTENT_TYPE "application/json"
+#define API_JSON_TOKENS   16      // Tokens aceitos num corpo da API (na arena)
+
+// Prazos por fase da requisição (ver http_request.h), verificados no tcp_poll;
+// quem passa de um deles é descartado com RST, devolvendo o PCB na hora
+#ifndef HTTP_IDLE_TIMEOUT_MS
+#define HTTP_IDLE_TIMEOUT_MS     5000   // Da aceitação ao primeiro byte
+#endif
+#ifndef HTTP_HEADER_TIMEOUT_MS
+#define HTTP_HEADER_TIMEOUT_MS   2000   // Do primeiro byte ao fim dos headers
+#endif
+#ifndef HTTP_BODY_TIMEOUT_MS
+#define HTTP_BODY_TIMEOUT_MS     3000   // Do fim dos headers ao fim do corpo
+#endif
+#ifndef HTTP_REQUEST_TIMEOUT_MS
+#define HTTP_REQUEST_TIMEOUT_MS  6000   // Da aceitação à requisição completa
+#endif
+
+// Depois de uma resposta com Content-Length confirmada, quanto esperar o
+// cliente fechar primeiro (o TIME_WAIT fica com ele); 0 fecha na hora, como
+// antes. Vencido o prazo, o servidor fecha
+#ifndef HTTP_LINGER_MS
+#define HTTP_LINGER_MS           2000
+#endif
+
+// Com 1 o callback de recepção só copia a requisição e a resposta é gerada no
+// laço principal (work_queue.h); com 0 tudo roda no callback, como antes
+#ifndef PICOW_DEFERRED_HTTP
+#define PICOW_DEFERRED_HTTP 1
+#endif
 
 // =============================================
 // Estruturas de Dados
 // =============================================
 
-// Área de renderização do display
-struct render_area display_area = {
-    .start_column = 0,
-    .end_column = ssd1306_width - 1,
-    .start_page = 0,
-    .end_page = ssd1306_n_pages - 1
-};
-
-uint8_t ssd1306_buffer[ssd1306_buffer_length]; // Buffer do display
-
 typedef struct TCP_SERVER_T_ {
     struct tcp_pcb *server_pcb;
     bool complete;
     ip_addr_t gw;
-    bool alarm_active;           // Flag para controlar o estado do alarme
-    absolute_time_t next_toggle_time;  // Próximo momento para alternar o LED/buzzer
-    bool beep_active;            // Flag para controlar o estado do bipe
-    absolute_time_t beep_end_time; // Quando o bipe atual deve terminar
 } TCP_SERVER_T;
 
 typedef struct TCP_CONNECT_STATE_T_ {
     struct tcp_pcb *pcb;
     int sent_len;
-    char headers[128];
-    char result[256];
-    int header_len;
-    int result_len;
+    char headers[128];           // Linha de requisição e corpo (req)
+    http_request_t req;
+    uint32_t accepted_ms;
+    uint32_t phase_ms;           // Início da fase atual de req
+    bool lingering;              // Resposta entregue, esperando o FIN do cliente
+    http_handler_fn handler;     // Handler em andamento (ctx), ou NULL
+    http_ctx_t ctx;
+    _Alignas(HTTP_ARENA_ALIGN) uint8_t arena[HTTP_ARENA_SIZE];  // Buffer de ctx.arena
+    bool deferred;               // Requisição na fila de trabalho adiado
     ip_addr_t *gw;
     TCP_SERVER_T *server_state;  // Ponteiro para o estado do servidor
 } TCP_CONNECT_STATE_T;
 
 // =============================================
-// Funções do Display OLED
-// =============================================
-
-void display_message(const char *line1, const char *line2) {
-    ssd1306_clear_display(ssd1306_buffer);
-    
-    if (line1) {
-        int x1 = (ssd1306_width - strlen(line1) * 6) / 2; // 6px por caractere
-        ssd1306_draw_string(ssd1306_buffer, x1, 20, line1); // Y = 20px
-    }
-    
-    if (line2) {
-        int x2 = (ssd1306_width - strlen(line2) * 6) / 2;
-        ssd1306_draw_string(ssd1306_buffer, x2, 30, line2); // Y = 30px
-    }
-    
-    render_on_display(ssd1306_buffer, &display_area);
-}
-
-// =============================================
-// Funções de Controle do Alarme
+// Funções do Servidor TCP/HTTP
 // =============================================
 
-void update_alarm(TCP_SERVER_T *state) {
-    if (state->alarm_active) {
-        // Alarme ativado - piscar o LED e emitir bipes
-        if (absolute_time_diff_us(get_absolute_time(), state->next_toggle_time) <= 0) {
-            static bool led_state = false;
-            led_state = !led_state;
-            gpio_put(RED_LED_GPIO, led_state);
-            
-            // Ativa/desativa o buzzer
-            if (led_state) {
-                pwm_set_gpio_level(PWM_GPIO, PWM_WRAP / 2);  // Duty 50%
-                state->beep_active = true;
-                state->beep_end_time = delayed_by_us(get_absolute_time(), BEEP_DURATION_MS * 1000);
-            } else {
-                pwm_set_gpio_level(PWM_GPIO, 0);  // Silencia buzzer
-                state->beep_active = false;
-            }
-            
-            // Configura o próximo tempo de alternância
-            state->next_toggle_time = delayed_by_us(get_absolute_time(), BEEP_INTERVAL_MS * 1000);
-        }
-        
-        // Desativa o buzzer após o tempo configurado
-        if (state->beep_active && absolute_time_diff_us(get_absolute_time(), state->beep_end_time) <= 0) {
-            pwm_set_gpio_level(PWM_GPIO, 0);
-            state->beep_active = false;
-        }
-        
-        // Atualiza display com mensagem de alarme ativo
-        display_message("ALARME", "EVACUAR");
-    } else {
-        // Alarme desativado - LED apagado e buzzer silenciado
-        gpio_put(RED_LED_GPIO, 0);
-        pwm_set_gpio_level(PWM_GPIO, 0);
-        state->beep_active = false;
-        // Atualiza display com mensagem de repouso
-        display_message("Sistema", "em repouso");
-    }
+// Libera o estado da conexão; a arena fecha a requisição que estiver aberta
+// (handler interrompido), para as estatísticas
+static void tcp_free_client_state(TCP_CONNECT_STATE_T *con_state) {
+    http_arena_release(&con_state->ctx.arena);
+    heap_free(con_state);
 }
 
-// =============================================
-// Funções do Servidor TCP/HTTP
-// =============================================
-
 static err_t tcp_close_client_connection(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *client_pcb, err_t close_err) {
     if (client_pcb) {
         tcp_arg(client_pcb, NULL);
@@ -170,19 +134,66 @@ static err_t tcp_close_client_connection(TCP_CONNECT_STATE_T *con_state, struct
         tcp_sent(client_pcb, NULL);
         tcp_recv(client_pcb, NULL);
         tcp_err(client_pcb, NULL);
+        // Em CLOSE_WAIT o FIN do cliente já chegou: este lado só passa por
+        // LAST_ACK, sem TIME_WAIT
+        tcp_close_kind_t kind = client_pcb->state == CLOSE_WAIT ? TCP_CLOSE_BY_CLIENT :
+                                con_state && con_state->lingering ? TCP_CLOSE_LINGER_TIMEOUT :
+                                TCP_CLOSE_BY_SERVER;
+        // Em FIN_WAIT, LAST_ACK ou CLOSING o PCB não serve mais a ninguém:
+        // com a menor prioridade, o lwIP o recicla antes de recusar um SYN
+        tcp_setprio(client_pcb, TCP_PRIO_MIN);
         err_t err = tcp_close(client_pcb);
         if (err != ERR_OK) {
             printf("close failed %d, calling abort\n", err);
             tcp_abort(client_pcb);
             close_err = ERR_ABRT;
+            kind = TCP_CLOSE_RESET;
         }
+        tcp_states_closed(kind);
+        tcp_states_sample();
         if (con_state) {
-            free(con_state);
+            if (con_state->deferred) {
+                // http_process_deferred libera quando sair da fila
+                con_state->pcb = NULL;
+            } else {
+                tcp_free_client_state(con_state);
+            }
         }
     }
     return close_err;
 }
 
+// Prazo e prioridade do PCB de cada fase; sem PCB livre, o lwIP aborta a
+// conexão de menor prioridade abaixo da do listener (TCP_PRIO_NORMAL), então
+// as paradas no meio dos headers saem primeiro
+static const uint32_t http_phase_timeout_ms[HTTP_PHASE_COUNT] = {
+    [HTTP_PHASE_IDLE] = HTTP_IDLE_TIMEOUT_MS,
+    [HTTP_PHASE_HEADER] = HTTP_HEADER_TIMEOUT_MS,
+    [HTTP_PHASE_BODY] = HTTP_BODY_TIMEOUT_MS,
+};
+static const uint8_t http_phase_prio[HTTP_PHASE_COUNT] = {
+    [HTTP_PHASE_IDLE] = TCP_PRIO_MIN + 1,
+    [HTTP_PHASE_HEADER] = TCP_PRIO_MIN,
+    [HTTP_PHASE_BODY] = TCP_PRIO_MIN + 2,
+    [HTTP_PHASE_RESPONSE] = TCP_PRIO_NORMAL,
+};
+
+// Descarta uma conexão que ainda não completou a requisição: com RST o PCB
+// volta ao pool na hora, sem passar por FIN_WAIT e TIME_WAIT
+static err_t tcp_evict_client_connection(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *client_pcb) {
+    printf("evicting connection in %s\n", http_phase_name(con_state->req.phase));
+    http_request_evicted(HTTP_EVICT_DEADLINE, con_state->req.phase);
+    tcp_states_closed(TCP_CLOSE_RESET);
+    tcp_arg(client_pcb, NULL);
+    tcp_poll(client_pcb, NULL, 0);
+    tcp_sent(client_pcb, NULL);
+    tcp_recv(client_pcb, NULL);
+    tcp_err(client_pcb, NULL);
+    tcp_abort(client_pcb);
+    tcp_free_client_state(con_state);
+    return ERR_ABRT;
+}
+
 static void tcp_server_close(TCP_SERVER_T *state) {
     if (state->server_pcb) {
         tcp_arg(state->server_pcb, NULL);
@@ -191,39 +202,437 @@ static void tcp_server_close(TCP_SERVER_T *state) {
     }
 }
 
+static err_t tcp_server_poll_timed(void *arg, struct tcp_pcb *pcb);
+
+// Resposta toda confirmada pelo cliente. Com Content-Length ele sabe que ela
+// acabou e fecha primeiro; o servidor só espera o FIN (tcp_recv com p NULL)
+// por até HTTP_LINGER_MS. Resposta delimitada pelo fechamento fecha já
+static err_t tcp_server_response_done(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    if (!con_state->ctx.framed || HTTP_LINGER_MS == 0) {
+        printf("all done\n");
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    }
+    if (!con_state->lingering) {
+        printf("all done, waiting for client close\n");
+        con_state->lingering = true;
+        con_state->phase_ms = http_now_ms();
+        // Sem PCB livre, as conexões que só esperam o FIN saem primeiro
+        tcp_setprio(pcb, TCP_PRIO_MIN);
+        tcp_poll(pcb, tcp_server_poll_timed, HTTP_REQUEST_POLL);
+    }
+    return ERR_OK;
+}
+
+// =============================================
+// Handlers HTTP (corrotinas, ver http_handler.h)
+// =============================================
+
+// Valores de ?alarm=, pelo nome ou pelo índice
+static const char *const alarm_param_names[] = { [0] = "off", [1] = "on", [ALARM_PARAM_TEST] = "test" };
+
+// Manda o comando de ?alarm=N (ou "alarm": N na API) ao motor; o motor o
+// aplica depois, então *active já recebe o estado pedido
+static bool alarm_command(int alarm_param, bool *active) {
+    alarm_cmd_type_t cmd = alarm_param == ALARM_PARAM_TEST ? ALARM_CMD_TEST :
+                           alarm_param ? ALARM_CMD_ARM : ALARM_CMD_DISARM;
+    if (!alarm_post(cmd, ALARM_SRC_HTTP)) {
+        printf("alarm queue full\n");
+        return false;
+    }
+    if (cmd != ALARM_CMD_TEST) {
+        *active = alarm_param;
+    }
+    return true;
+}
+
+// Aplica ?alarm=N; retorna o estado armado que a página deve mostrar
+static bool alarm_apply_param(char *params) {
+    // Estado publicado pelo motor do alarme
+    alarm_state_t alarm;
+    alarm_get_state(&alarm);
+    bool active = alarm.active;
+
+    http_param_t form[HTTP_FORM_MAX_PARAMS];
+    size_t n = http_form_parse(params, form, count_of(form));
+    int alarm_param;
+    if (http_param_enum(form, n, ALARM_PARAM, alarm_param_names, count_of(alarm_param_names), &alarm_param)) {
+        alarm_command(alarm_param, &active);
+    }
+    return active;
+}
+
+// Slots da linha de status e dos headers (templates/response.http,
+// chunked.http e error.html), guardados em ctx por http_respond
+static void http_response_args(http_ctx_t *ctx, http_tmpl_arg_t *args) {
+    args[HTTP_SLOT_CODE].u = ctx->code;
+    args[HTTP_SLOT_REASON].s = ctx->reason;
+    args[HTTP_SLOT_TYPE].s = ctx->type;
+    args[HTTP_SLOT_LENGTH].u = ctx->length;
+}
+
+// Status, tipo e Content-Length (só em response.http) da resposta. Toda
+// resposta tem tamanho ou vai em chunks: o cliente fecha primeiro
+static void http_respond(http_ctx_t *ctx, uint16_t code, const char *reason, const char *type, uint32_t length) {
+    ctx->code = code;
+    ctx->reason = reason;
+    ctx->type = type;
+    ctx->length = length;
+    ctx->framed = true;
+}
+
+// templates/alarm.html para o estado armado (ou não) em var[0]
+static void alarm_page_args(http_ctx_t *ctx, http_tmpl_arg_t *args) {
+    bool active = ctx->var[0];
+    args[HTTP_SLOT_STATE].s = active ? "ATIVADO" : "DESATIVADO";
+    args[HTTP_SLOT_NEXT].u = !active;
+    args[HTTP_SLOT_ACTION].s = active ? "Desligar" : "Ligar";
+}
+
+// Página de controle do alarme
+static http_status_t alarm_page_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    ctx->var[0] = alarm_apply_param(ctx->params);
+    http_respond(ctx, 200, "OK", HTML_CONTENT_TYPE, http_tmpl_length(ctx, &http_template_alarm, alarm_page_args));
+    HTTP_TEMPLATE(ctx, &http_template_response, http_response_args);
+    HTTP_TEMPLATE(ctx, &http_template_alarm, alarm_page_args);
+    HTTP_END(ctx);
+}
+
+// Página de erro (templates/error.html) com o status que quem iniciou o
+// handler deixou em ctx->code e ctx->reason
+static http_status_t error_page_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    http_respond(ctx, ctx->code, ctx->reason, HTML_CONTENT_TYPE,
+                 http_tmpl_length(ctx, &http_template_error, http_response_args));
+    HTTP_TEMPLATE(ctx, &http_template_response, http_response_args);
+    HTTP_TEMPLATE(ctx, &http_template_error, http_response_args);
+    HTTP_END(ctx);
+}
+
+// templates/redirect.http: o painel no endereço do servidor (var[0])
+static void redirect_args(http_ctx_t *ctx, http_tmpl_arg_t *args) {
+    ip4_addr_t gw = { .addr = ctx->var[0] };
+    args[HTTP_SLOT_HOST].s = ip4addr_ntoa(&gw);
+    args[HTTP_SLOT_PATH].s = DASHBOARD;
+}
+
+// Redirecionamento das sondas de portal cativo e dos caminhos desconhecidos
+static http_status_t redirect_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    ctx->framed = true;  // Content-Length: 0
+    HTTP_TEMPLATE(ctx, &http_template_redirect, redirect_args);
+    HTTP_END(ctx);
+}
+
+// Um evento por comando aplicado pelo motor, cada um num chunk; encerra após
+// ALARM_EVENTS_MAX_MS com o chunk vazio e o cliente fecha primeiro
+static http_status_t alarm_events_handler(http_ctx_t *ctx) {
+    // Recalculado a cada retomada: variáveis locais não sobrevivem a yields
+    alarm_state_t alarm;
+    alarm_get_state(&alarm);
+
+    HTTP_BEGIN(ctx);
+    ctx->wake_ms = http_now_ms() + ALARM_EVENTS_MAX_MS;
+    http_respond(ctx, 200, "OK", EVENT_STREAM_CONTENT_TYPE, 0);
+    HTTP_TEMPLATE(ctx, &http_template_chunked, http_response_args);
+    while (!http_deadline_passed(ctx)) {
+        ctx->var[0] = alarm.commands;
+        HTTP_CHUNK_PRINTF(ctx, ALARM_EVENT, alarm.active, alarm.testing, (unsigned long)alarm.commands);
+        HTTP_WAIT_UNTIL(ctx, alarm.commands != ctx->var[0] || http_deadline_passed(ctx), HTTP_WAIT_STATE);
+    }
+    HTTP_CHUNK_END(ctx);
+    HTTP_END(ctx);
+}
+
+// Telemetria no formato do Prometheus, de tamanho desconhecido e sem buffer
+// próprio: cada chamada a metrics_render preenche ctx->line com os próximos
+// registros (var[0]), que vão num chunk assim que houver espaço no buffer de
+// envio. Várias coletas podem correr ao mesmo tempo
+static http_status_t metrics_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    http_respond(ctx, 200, "OK", METRICS_CONTENT_TYPE, 0);
+    HTTP_TEMPLATE(ctx, &http_template_chunked, http_response_args);
+    while ((ctx->line_len = (int)metrics_render(&ctx->var[0], ctx->line, sizeof(ctx->line))) > 0) {
+        HTTP_CHUNK(ctx, ctx->line, ctx->line_len);
+    }
+    HTTP_CHUNK_END(ctx);
+    HTTP_END(ctx);
+}
+
+// Retrato do estado do alarme em ctx->var: os geradores JSON rodam de novo a
+// cada retomada e precisam ver o mesmo estado. Os bits altos de var[0] guardam
+// o api_error_t da requisição
+#define API_ACTIVE        (1u << 0)
+#define API_TESTING       (1u << 1)
+#define API_LED_ON        (1u << 2)
+#define API_BEEP_ACTIVE   (1u << 3)
+#define API_ERROR_SHIFT   8
+
+typedef enum {
+    API_OK,
+    API_ERR_BODY,           // Corpo ausente ou JSON inválido
+    API_ERR_TOO_LARGE,      // Corpo não coube no buffer da requisição
+    API_ERR_ALARM,          // Sem "alarm" ou com valor desconhecido
+    API_ERR_BUSY,           // Fila do motor cheia
+    API_ERR_COUNT,
+} api_error_t;
+
+static const struct {
+    uint16_t status;
+    const char *reason;
+    const char *message;
+} api_errors[API_ERR_COUNT] = {
+    [API_OK] = { 202, "Accepted", NULL },
+    [API_ERR_BODY] = { 400, "Bad Request", "invalid JSON body" },
+    [API_ERR_TOO_LARGE] = { 413, "Payload Too Large", "body too large" },
+    [API_ERR_ALARM] = { 400, "Bad Request", "expected {\"alarm\":\"on\"|\"off\"|\"test\"}" },
+    [API_ERR_BUSY] = { 503, "Service Unavailable", "alarm queue full" },
+};
+
+static void api_snapshot(http_ctx_t *ctx) {
+    alarm_state_t alarm;
+    alarm_get_state(&alarm);
+    ctx->var[0] = (alarm.active ? API_ACTIVE : 0) | (alarm.testing ? API_TESTING : 0) |
+                  (alarm.led_on ? API_LED_ON : 0) | (alarm.beep_active ? API_BEEP_ACTIVE : 0);
+    ctx->var[1] = alarm.commands;
+    ctx->var[2] = alarm.dropped;
+    ctx->var[3] = http_now_ms();
+}
+
+static void api_state_json(http_ctx_t *ctx, json_writer_t *w) {
+    json_object_begin(w);
+    JSON_KEY(w, "active");
+    json_bool(w, ctx->var[0] & API_ACTIVE);
+    JSON_KEY(w, "testing");
+    json_bool(w, ctx->var[0] & API_TESTING);
+    JSON_KEY(w, "led_on");
+    json_bool(w, ctx->var[0] & API_LED_ON);
+    JSON_KEY(w, "beep_active");
+    json_bool(w, ctx->var[0] & API_BEEP_ACTIVE);
+    JSON_KEY(w, "commands");
+    json_uint(w, ctx->var[1]);
+    JSON_KEY(w, "dropped");
+    json_uint(w, ctx->var[2]);
+    JSON_KEY(w, "uptime_ms");
+    json_uint(w, ctx->var[3]);
+    json_object_end(w);
+}
+
+// Estado com o comando já aplicado, ou {"error": ...}
+static void api_alarm_json(http_ctx_t *ctx, json_writer_t *w) {
+    api_error_t err = ctx->var[0] >> API_ERROR_SHIFT;
+    if (err == API_OK) {
+        api_state_json(ctx, w);
+        return;
+    }
+    json_object_begin(w);
+    JSON_KEY(w, "error");
+    json_string(w, api_errors[err].message);
+    json_object_end(w);
+}
+
+// Corpo {"alarm": "on"|"off"|"test"} (ou o índice, ou true/false), como ?alarm=
+static api_error_t api_alarm_apply(http_ctx_t *ctx) {
+    if (!ctx->body) {
+        return ctx->body_len ? API_ERR_TOO_LARGE : API_ERR_BODY;
+    }
+    // Os tokens só valem até achar o comando: rascunho na arena, devolvido
+    // antes de aplicá-lo
+    http_arena_mark_t mark = http_arena_mark(&ctx->arena);
+    json_token_t *tokens = http_arena_alloc(&ctx->arena, API_JSON_TOKENS * sizeof(json_token_t));
+    if (!tokens) {
+        return API_ERR_TOO_LARGE;
+    }
+    int n = json_parse(ctx->body, ctx->body_len, tokens, API_JSON_TOKENS);
+    int value = n < 0 ? n : json_find(ctx->body, tokens, n, 0, ALARM_PARAM);
+    int alarm_param;
+    bool found = value >= 0 && json_token_enum(ctx->body, &tokens[value], alarm_param_names,
+                                               count_of(alarm_param_names), &alarm_param);
+    http_arena_reset(&ctx->arena, mark);
+    if (n < 0) {
+        printf("api body rejected: %s\n", json_error_name(n));
+        return API_ERR_BODY;
+    }
+    if (!found) {
+        return API_ERR_ALARM;
+    }
+    bool active = ctx->var[0] & API_ACTIVE;
+    if (!alarm_command(alarm_param, &active)) {
+        return API_ERR_BUSY;
+    }
+    ctx->var[0] = (ctx->var[0] & ~API_ACTIVE) | (active ? API_ACTIVE : 0);
+    return API_OK;
+}
+
+// GET /api/state: o estado do alarme em JSON, para integrações de automação
+static http_status_t api_state_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    api_snapshot(ctx);
+    http_respond(ctx, 200, "OK", JSON_CONTENT_TYPE, http_json_length(ctx, api_state_json));
+    HTTP_TEMPLATE(ctx, &http_template_response, http_response_args);
+    HTTP_JSON(ctx, api_state_json);
+    HTTP_END(ctx);
+}
+
+// POST /api/alarm: aplica o comando do corpo e responde com o estado pedido
+static http_status_t api_alarm_handler(http_ctx_t *ctx) {
+    HTTP_BEGIN(ctx);
+    api_snapshot(ctx);
+    ctx->var[0] |= (uint32_t)api_alarm_apply(ctx) << API_ERROR_SHIFT;
+    http_respond(ctx, api_errors[ctx->var[0] >> API_ERROR_SHIFT].status,
+                 api_errors[ctx->var[0] >> API_ERROR_SHIFT].reason, JSON_CONTENT_TYPE,
+                 http_json_length(ctx, api_alarm_json));
+    HTTP_TEMPLATE(ctx, &http_template_response, http_response_args);
+    HTTP_JSON(ctx, api_alarm_json);
+    HTTP_END(ctx);
+}
+
+// If-None-Match com o ETag do arquivo (numa lista, fraco ou não) ou "*"
+static bool http_etag_match(const char *if_none_match, const char *etag) {
+    return strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL;
+}
+
+// Arquivo do painel (web_assets[var[0]]): headers e conteúdo prontos na
+// flash, copiados para o buffer de envio (LWIP_NETIF_TX_SINGLE_PBUF); var[1]
+// = o cliente já tem esta versão (304)
+static http_status_t web_asset_handler(http_ctx_t *ctx) {
+    const web_asset_t *asset = &web_assets[ctx->var[0]];
+    HTTP_BEGIN(ctx);
+    ctx->framed = true;
+    if (ctx->var[1]) {
+        HTTP_SEND(ctx, asset->not_modified, asset->not_modified_len);
+    } else {
+        HTTP_SEND(ctx, asset->headers, asset->headers_len);
+        HTTP_SEND(ctx, asset->data, asset->len);
+    }
+    HTTP_END(ctx);
+}
+
+// Handlers das rotas de http/routes.def; NULL nas servidas em
+// http_process_request
+#define HTTP_ROUTE_HANDLER(name, method, path, handler) [HTTP_ROUTE_##name] = handler,
+static const http_handler_fn http_route_handlers[HTTP_ROUTE_COUNT] = {
+    HTTP_ROUTES(HTTP_ROUTE_HANDLER)
+};
+
+// Retoma o handler da conexão; fecha quando ele termina e o cliente confirma
+// todos os bytes
+static err_t http_handler_run(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    http_ctx_t *ctx = &con_state->ctx;
+    if (ctx->status != HTTP_DONE) {
+        ctx->status = con_state->handler(ctx);
+        tcp_output(pcb);
+    }
+    switch (ctx->status) {
+    case HTTP_ERROR:
+        printf("handler %s failed\n", ctx->path);
+        http_arena_release(&ctx->arena);
+        // ERR_OK depois do tcp_close: vindo do tcp_server_recv o pbuf já foi
+        // liberado, e qualquer outro valor (fora ERR_ABRT, que
+        // tcp_close_client_connection devolve se precisou abortar) faz o lwIP
+        // guardá-lo em refused_data e entregá-lo de novo
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    case HTTP_DONE:
+        // O handler não volta a rodar: o rascunho já pode ser devolvido
+        http_arena_release(&ctx->arena);
+        if (con_state->sent_len >= ctx->queued) {
+            return tcp_server_response_done(con_state, pcb);
+        }
+        // Só falta a confirmação: volta ao prazo normal de inatividade
+        tcp_poll(pcb, tcp_server_poll_timed, TEMPO_POLLING * 2);
+        return ERR_OK;
+    default:
+        // Esperando: o tcp_poll reavalia estado e prazo a cada ~500 ms
+        tcp_poll(pcb, tcp_server_poll_timed, HTTP_HANDLER_POLL);
+        return ERR_OK;
+    }
+}
+
 static err_t tcp_server_sent(void *arg, struct tcp_pcb *pcb, u16_t len) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
     printf("tcp_server_sent %u\n", len);
     con_state->sent_len += len;
-    if (con_state->sent_len >= con_state->header_len + con_state->result_len) {
-        printf("all done\n");
-        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    if (con_state->handler) {
+        return http_handler_run(con_state, pcb);
     }
     return ERR_OK;
 }
 
-static int alarm_control_content(const char *request, const char *params, char *result, size_t max_result_len, TCP_SERVER_T *state) {
-    int len = 0;
-    if (strncmp(request, ALARM_CONTROL, sizeof(ALARM_CONTROL) - 1) == 0) {
-        // Verifica se o usuário alterou o estado do alarme
-        if (params) {
-            int alarm_param;
-            if (sscanf(params, ALARM_PARAM, &alarm_param) == 1) {
-                state->alarm_active = alarm_param;
-                printf("Alarme %s\n", state->alarm_active ? "ativado" : "desativado");
-            }
-        }
-        
-        // Gera a página HTML com o estado atual
-        if (state->alarm_active) {
-            len = snprintf(result, max_result_len, ALARM_CONTROL_BODY, "ATIVADO", 0, "Desligar");
-        } else {
-            len = snprintf(result, max_result_len, ALARM_CONTROL_BODY, "DESATIVADO", 1, "Ligar");
+// Gera e envia a resposta para a requisição em con_state->headers
+static err_t http_process_request(TCP_CONNECT_STATE_T *con_state, struct tcp_pcb *pcb) {
+    // Linha de requisição: "MÉTODO caminho[?params] HTTP/1.1"
+    char *request = strchr(con_state->headers, ' ');
+    if (!request) {
+        return ERR_OK;
+    }
+    request++;
+    char *space = strchr(request, ' ');
+    if (space) {
+        *space = 0;
+    }
+    char *params = strchr(request, '?');
+    if (params) {
+        *params++ = 0;
+    }
+
+    // A chave da tabela de rotas é "MÉTODO caminho", já contígua em headers
+    const char *path_end = params ? params - 1 : space ? space : request + strlen(request);
+    http_route_id_t route = http_route_lookup(con_state->headers, path_end - con_state->headers);
+    bool get = strncmp(HTTP_GET " ", con_state->headers, sizeof(HTTP_GET)) == 0;
+    printf("Request: %s?%s\n", request, params ? params : "");
+
+    // Toda resposta sai por um handler; path e params apontam para headers,
+    // que não muda mais nesta conexão
+    http_ctx_t *ctx = &con_state->ctx;
+    con_state->sent_len = 0;
+    http_ctx_start(ctx, pcb, request, params);
+    const web_asset_t *asset = route == HTTP_ROUTE_NONE && get ?
+                               web_asset_lookup(con_state->headers, path_end - con_state->headers) : NULL;
+    if (asset) {
+        con_state->handler = web_asset_handler;
+        ctx->var[0] = asset - web_assets;
+        ctx->var[1] = http_etag_match(con_state->req.if_none_match, asset->etag);
+    } else if (route != HTTP_ROUTE_NONE && http_route_handlers[route]) {
+        con_state->handler = http_route_handlers[route];
+        http_request_t *req = &con_state->req;
+        ctx->body_len = req->content_length;
+        if (req->content_length && req->len - req->body_off >= req->content_length) {
+            // Corpo inteiro no buffer, logo depois da linha de requisição
+            ctx->body = con_state->headers + req->body_off;
         }
+    } else if (get) {
+        // Sondas de portal cativo e caminhos desconhecidos vão para o painel
+        con_state->handler = redirect_handler;
+        ctx->var[0] = ip4_addr_get_u32(ip_2_ip4(con_state->gw));
+    } else {
+        con_state->handler = error_page_handler;
+        ctx->code = 404;
+        ctx->reason = "Not Found";
     }
-    return len;
+    return http_handler_run(con_state, pcb);
 }
 
+#if PICOW_DEFERRED_HTTP
+// Contexto de thread (laço principal): processa a requisição adiada por
+// tcp_server_recv
+static void http_process_deferred(void *arg) {
+    TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
+    cyw43_arch_lwip_begin();
+    con_state->deferred = false;
+    if (con_state->pcb) {
+        http_process_request(con_state, con_state->pcb);
+    } else {
+        // A conexão caiu enquanto a requisição esperava na fila
+        tcp_free_client_state(con_state);
+    }
+    cyw43_arch_lwip_end();
+    latency_end(LATENCY_HTTP_DEFERRED, t0);
+    stack_probe_exit(stack_token);
+}
+#endif
+
 err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
     
@@ -232,122 +641,173 @@ err_t tcp_server_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
         return tcp_close_client_connection(con_state, pcb, ERR_OK);
     }
     
-    if (p->tot_len > 0) {
-        printf("tcp_server_recv %d err %d\n", p->tot_len, err);
-        
-        // Copia a requisição para o buffer
-        pbuf_copy_partial(p, con_state->headers, 
-                        p->tot_len > sizeof(con_state->headers) - 1 ? sizeof(con_state->headers) - 1 : p->tot_len, 0);
-
-        // Processa requisição GET
-        if (strncmp(HTTP_GET, con_state->headers, sizeof(HTTP_GET) - 1) == 0) {
-            char *request = con_state->headers + sizeof(HTTP_GET); // + espaço
-            char *params = strchr(request, '?');
-            
-            if (params) {
-                if (*params) {
-                    char *space = strchr(request, ' ');
-                    *params++ = 0;
-                    if (space) {
-                        *space = 0;
-                    }
-                } else {
-                    params = NULL;
-                }
-            }
-
-            // Gera conteúdo da página
-            con_state->result_len = alarm_control_content(request, params, con_state->result, 
-                                                        sizeof(con_state->result), con_state->server_state);
-            printf("Request: %s?%s\n", request, params);
-            printf("Result: %d\n", con_state->result_len);
-
-            // Verifica se houve espaço suficiente no buffer
-            if (con_state->result_len > sizeof(con_state->result) - 1) {
-                printf("Too much result data %d\n", con_state->result_len);
-                return tcp_close_client_connection(con_state, pcb, ERR_CLSD);
-            }
-
-            // Gera a página web
-            if (con_state->result_len > 0) {
-                con_state->header_len = snprintf(con_state->headers, sizeof(con_state->headers), 
-                                               HTTP_RESPONSE_HEADERS, 200, con_state->result_len);
-                if (con_state->header_len > sizeof(con_state->headers) - 1) {
-                    printf("Too much header data %d\n", con_state->header_len);
-                    return tcp_close_client_connection(con_state, pcb, ERR_CLSD);
-                }
-            } else {
-                // Redireciona para a página de controle
-                con_state->header_len = snprintf(con_state->headers, sizeof(con_state->headers), 
-                                               HTTP_RESPONSE_REDIRECT, ipaddr_ntoa(con_state->gw));
-                printf("Sending redirect %s", con_state->headers);
-            }
-
-            // Envia os headers para o cliente
-            con_state->sent_len = 0;
-            err_t err = tcp_write(pcb, con_state->headers, con_state->header_len, 0);
-            if (err != ERR_OK) {
-                printf("failed to write header data %d\n", err);
-                return tcp_close_client_connection(con_state, pcb, err);
-            }
-
-            // Envia o corpo da página para o cliente
-            if (con_state->result_len) {
-                err = tcp_write(pcb, con_state->result, con_state->result_len, 0);
-                if (err != ERR_OK) {
-                    printf("failed to write result data %d\n", err);
-                    return tcp_close_client_connection(con_state, pcb, err);
-                }
-            }
+    if (p->tot_len == 0 || con_state->req.phase == HTTP_PHASE_RESPONSE) {
+        // Nada a fazer, ou a requisição já está completa (na fila ou sendo
+        // respondida)
+        if (p->tot_len > 0) {
+            tcp_recved(pcb, p->tot_len);
         }
-        tcp_recved(pcb, p->tot_len);
+        pbuf_free(p);
+        return ERR_OK;
+    }
+
+    // Aqui só acumula a requisição no buffer; o resto fica para depois
+    http_phase_t phase = con_state->req.phase;
+    bool done = false;
+    for (struct pbuf *q = p; q && !done; q = q->next) {
+        done = http_request_feed(&con_state->req, q->payload, q->len);
     }
+    tcp_recved(pcb, p->tot_len);
     pbuf_free(p);
-    return ERR_OK;
+    if (con_state->req.phase != phase) {
+        con_state->phase_ms = http_now_ms();
+        tcp_setprio(pcb, http_phase_prio[con_state->req.phase]);
+    }
+    if (!done) {
+        // Faltam headers ou corpo: os prazos ficam com o tcp_poll
+        return ERR_OK;
+    }
+    // Completa: a resposta volta ao prazo normal de inatividade
+    tcp_poll(pcb, tcp_server_poll_timed, TEMPO_POLLING * 2);
+
+#if PICOW_DEFERRED_HTTP
+    con_state->deferred = true;
+    if (work_post(http_process_deferred, con_state)) {
+        return ERR_OK;
+    }
+    // Fila cheia: processa na hora
+    con_state->deferred = false;
+#endif
+    return http_process_request(con_state, pcb);
 }
 
 static err_t tcp_server_poll(void *arg, struct tcp_pcb *pcb) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
+    if (con_state && con_state->req.phase != HTTP_PHASE_RESPONSE) {
+        // Requisição incompleta: prazo da fase atual e prazo total
+        uint32_t now = http_now_ms();
+        if (now - con_state->phase_ms >= http_phase_timeout_ms[con_state->req.phase] ||
+            now - con_state->accepted_ms >= HTTP_REQUEST_TIMEOUT_MS) {
+            return tcp_evict_client_connection(con_state, pcb);
+        }
+        return ERR_OK;
+    }
+    if (con_state && con_state->handler && con_state->ctx.status != HTTP_DONE) {
+        // Handler esperando estado, prazo ou espaço no buffer de envio
+        return http_handler_run(con_state, pcb);
+    }
+    if (con_state && con_state->lingering) {
+        // Resposta entregue: o cliente tem HTTP_LINGER_MS para fechar primeiro
+        if (http_now_ms() - con_state->phase_ms < HTTP_LINGER_MS) {
+            return ERR_OK;
+        }
+        printf("client did not close\n");
+        return tcp_close_client_connection(con_state, pcb, ERR_OK);
+    }
     printf("tcp_server_poll_fn\n");
     return tcp_close_client_connection(con_state, pcb, ERR_OK);
 }
 
 static void tcp_server_err(void *arg, err_t err) {
     TCP_CONNECT_STATE_T *con_state = (TCP_CONNECT_STATE_T*)arg;
-    if (err != ERR_ABRT) {
-        printf("tcp_client_err_fn %d\n", err);
-        tcp_close_client_connection(con_state, con_state->pcb, err);
+    if (!con_state) {
+        return;
+    }
+    // O lwIP já liberou o pcb (RST do cliente ou abortado pela pilha)
+    printf("tcp_client_err_fn %d\n", err);
+    if (err == ERR_ABRT && con_state->req.phase != HTTP_PHASE_RESPONSE) {
+        // Sem PCB livre, o lwIP abortou esta por ter a menor prioridade
+        http_request_evicted(HTTP_EVICT_PRESSURE, con_state->req.phase);
+    }
+    tcp_states_closed(TCP_CLOSE_RESET);
+    if (con_state->deferred) {
+        // O item na fila libera o estado
+        con_state->pcb = NULL;
+    } else {
+        tcp_free_client_state(con_state);
     }
 }
 
+// Callbacks registrados no lwIP, medidos pelos histogramas de latência
+static err_t tcp_server_sent_timed(void *arg, struct tcp_pcb *pcb, u16_t len) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
+    err_t ret = tcp_server_sent(arg, pcb, len);
+    latency_end(LATENCY_TCP_SENT, t0);
+    stack_probe_exit(stack_token);
+    return ret;
+}
+
+static err_t tcp_server_recv_timed(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
+    err_t ret = tcp_server_recv(arg, pcb, p, err);
+    latency_end(LATENCY_TCP_RECV, t0);
+    stack_probe_exit(stack_token);
+    return ret;
+}
+
+static err_t tcp_server_poll_timed(void *arg, struct tcp_pcb *pcb) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
+    err_t ret = tcp_server_poll(arg, pcb);
+    latency_end(LATENCY_TCP_POLL, t0);
+    stack_probe_exit(stack_token);
+    return ret;
+}
+
 static err_t tcp_server_accept(void *arg, struct tcp_pcb *client_pcb, err_t err) {
     TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
     if (err != ERR_OK || client_pcb == NULL) {
         printf("failure in accept\n");
         return ERR_VAL;
     }
+    // Cliente acima do limite (sondas de portal em laço): RST antes de
+    // alocar qualquer estado
+    uint32_t src = ip4_addr_get_u32(ip_2_ip4(&client_pcb->remote_ip));
+    if (!rate_limit_allow(RATE_LIMIT_HTTP, &src, sizeof(src), sys_now())) {
+        tcp_abort(client_pcb);
+        return ERR_ABRT;
+    }
     printf("client connected\n");
 
     // Create the state for the connection
-    TCP_CONNECT_STATE_T *con_state = calloc(1, sizeof(TCP_CONNECT_STATE_T));
+    TCP_CONNECT_STATE_T *con_state = heap_calloc(1, sizeof(TCP_CONNECT_STATE_T));
     if (!con_state) {
         printf("failed to allocate connect state\n");
+        metrics_heap_alloc_failed();
         return ERR_MEM;
     }
+    metrics_heap_sample();
     con_state->pcb = client_pcb;
     con_state->gw = &state->gw;
     con_state->server_state = state;
-
-    // setup connection to client
+    http_request_init(&con_state->req, con_state->headers, sizeof(con_state->headers));
+    http_arena_init(&con_state->ctx.arena, con_state->arena, sizeof(con_state->arena));
+    con_state->accepted_ms = con_state->phase_ms = http_now_ms();
+    tcp_states_sample();
+
+    // setup connection to client; até a requisição completar, prioridade
+    // baixa e tcp_poll curto para os prazos
+    tcp_setprio(client_pcb, http_phase_prio[HTTP_PHASE_IDLE]);
     tcp_arg(client_pcb, con_state);
-    tcp_sent(client_pcb, tcp_server_sent);
-    tcp_recv(client_pcb, tcp_server_recv);
-    tcp_poll(client_pcb, tcp_server_poll, TEMPO_POLLING * 2);
+    tcp_sent(client_pcb, tcp_server_sent_timed);
+    tcp_recv(client_pcb, tcp_server_recv_timed);
+    tcp_poll(client_pcb, tcp_server_poll_timed, HTTP_REQUEST_POLL);
     tcp_err(client_pcb, tcp_server_err);
 
     return ERR_OK;
 }
 
+static err_t tcp_server_accept_timed(void *arg, struct tcp_pcb *client_pcb, err_t err) {
+    uintptr_t stack_token = stack_probe_enter();
+    uint32_t t0 = latency_begin();
+    err_t ret = tcp_server_accept(arg, client_pcb, err);
+    latency_end(LATENCY_TCP_ACCEPT, t0);
+    stack_probe_exit(stack_token);
+    return ret;
+}
+
 static bool tcp_server_open(void *arg) {
     TCP_SERVER_T *state = (TCP_SERVER_T*)arg;
     printf("starting server on port %d\n", PORTA_TCP);
@@ -358,6 +818,8 @@ static bool tcp_server_open(void *arg) {
         return false;
     }
 
+    // Reabrir a porta não espera os PCBs que ainda estão em TIME_WAIT nela
+    ip_set_option(pcb, SOF_REUSEADDR);
     err_t err = tcp_bind(pcb, IP_ANY_TYPE, PORTA_TCP);
     if (err) {
         printf("failed to bind to port %d\n", PORTA_TCP);
@@ -374,7 +836,7 @@ static bool tcp_server_open(void *arg) {
     }
 
     tcp_arg(state->server_pcb, state);
-    tcp_accept(state->server_pcb, tcp_server_accept);
+    tcp_accept(state->server_pcb, tcp_server_accept_timed);
 
     printf("Access Point criado: '%s'\n", WIFI_SSID);
     printf("Conecte-se e acesse: http://%s\n", IP_GW);
@@ -390,6 +852,17 @@ void key_pressed_func(void *param) {
         cyw43_arch_disable_ap_mode();
         cyw43_arch_lwip_end();
         state->complete = true;
+    } else if (key == 'm' || key == 'M') {
+        metrics_print();
+    } else if (key == 'l' || key == 'L') {
+        loop_profile_print();
+    } else if (key == 's' || key == 'S') {
+        stack_profile_print();
+#if PICO_CYW43_ARCH_FREERTOS
+        rtos_tasks_print();
+#endif
+    } else if (key == 't' || key == 'T') {
+        alarm_post(ALARM_CMD_TEST, ALARM_SRC_CONSOLE);
     }
 }
 
@@ -397,10 +870,9 @@ void key_pressed_func(void *param) {
 // Função Principal
 // =============================================
 
-int main() {
-    stdio_init_all();
-
-    TCP_SERVER_T *state = calloc(1, sizeof(TCP_SERVER_T));
+// Rede, servidores e laço (ou tarefas, no build FreeRTOS) até a tecla 'd'
+static int app_main(void) {
+    TCP_SERVER_T *state = heap_calloc(1, sizeof(TCP_SERVER_T));
     if (!state) {
         printf("failed to allocate state\n");
         return 1;
@@ -411,39 +883,18 @@ int main() {
         return 1;
     }
 
-    // Configuração do hardware
-    gpio_init(RED_LED_GPIO);
-    gpio_set_dir(RED_LED_GPIO, GPIO_OUT);
-    gpio_put(RED_LED_GPIO, 0);
-
-    // Configuração do Buzzer PWM
-    gpio_set_function(PWM_GPIO, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(PWM_GPIO);
-    pwm_config cfg = pwm_get_default_config();
-    pwm_config_set_clkdiv(&cfg, CLOCK_DIV);
-    pwm_config_set_wrap(&cfg, PWM_WRAP);
-    pwm_init(slice, &cfg, true);
-    pwm_set_gpio_level(PWM_GPIO, 0);
-
-    // Inicialização do display OLED
-    i2c_init(i2c1, 400 * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
-    
-    // Inicialização do display
-    calculate_render_area_buffer_length(&display_area);
-    ssd1306_init();
-    display_message("Iniciando", "sistema...");
+    // Respostas HTTP geradas fora dos callbacks do lwIP
+    work_queue_init();
 
-    // Inicializa estado do alarme
-    state->alarm_active = false;
-    state->beep_active = false;
-    state->next_toggle_time = get_absolute_time();
+    // LED, buzzer e display; com PICOW_DUAL_CORE o motor passa para o core 1
+    alarm_init();
+    alarm_start();
 
-    // Configura callback para tecla pressionada
+#if !PICO_CYW43_ARCH_FREERTOS
+    // Configura callback para tecla pressionada; no FreeRTOS o console é
+    // lido pela tarefa main, fora da interrupção
     stdio_set_chars_available_callback(key_pressed_func, state);
+#endif
 
     // Configuração do Access Point
     cyw43_arch_enable_ap_mode(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK);
@@ -453,6 +904,10 @@ int main() {
     IP4_ADDR(&state->gw, 192, 168, 4, 1);
     IP4_ADDR(&mask, 255, 255, 255, 0);
 
+    // Os servidores usam a API raw do lwIP; fora do modo poll (interrupção ou
+    // tcpip_thread) ela só pode ser chamada com a trava
+    cyw43_arch_lwip_begin();
+
     // Inicia servidor DHCP
     dhcp_server_t dhcp_server;
     dhcp_server_init(&dhcp_server, &state->gw, &mask);
@@ -461,35 +916,90 @@ int main() {
     dns_server_t dns_server;
     dns_server_init(&dns_server, &state->gw);
 
-    if (!tcp_server_open(state)) {
+    bool opened = tcp_server_open(state);
+    cyw43_arch_lwip_end();
+    if (!opened) {
         printf("failed to open server\n");
         return 1;
     }
 
     state->complete = false;
+#if PICO_CYW43_ARCH_FREERTOS
+    // Alarme, HTTP e display em tarefas próprias; esta fica com o console
+    rtos_tasks_start();
+    while (!state->complete) {
+        key_pressed_func(state);
+        vTaskDelay(pdMS_TO_TICKS(RTOS_CONSOLE_PERIOD_MS));
+    }
+    rtos_tasks_stop();
+#else
     while(!state->complete) {
-        // Atualiza o estado do alarme (LED e buzzer)
-        update_alarm(state);
+        uintptr_t stack_token = stack_probe_enter();
+        loop_profile_begin();
+
+#if !PICOW_DUAL_CORE
+        // Atualiza o estado do alarme (LED e buzzer) e o display
+        loop_profile_phase(LOOP_PHASE_ALARM);
+        alarm_update();
+        loop_profile_phase(LOOP_PHASE_DISPLAY);
+        alarm_render();
+#endif
         
 #if PICO_CYW43_ARCH_POLL
+        loop_profile_phase(LOOP_PHASE_POLL);
         cyw43_arch_poll();
-        cyw43_arch_wait_for_work_until(make_timeout_time_ms(10));
+#endif
+        // Respostas adiadas pelos callbacks
+        loop_profile_phase(LOOP_PHASE_WORK);
+        work_run(WORK_QUEUE_SIZE);
+
+        loop_profile_phase(LOOP_PHASE_WAIT);
+#if PICO_CYW43_ARCH_POLL
+        if (!work_pending()) {
+            cyw43_arch_wait_for_work_until(make_timeout_time_ms(10));
+        }
 #else
-        sleep_ms(10);
+        // work_post() dá __sev(), então uma requisição nova acorda o laço
+        if (!work_pending()) {
+            best_effort_wfe_or_timeout(make_timeout_time_ms(10));
+        }
 #endif
+        loop_profile_end();
+        stack_probe_exit(stack_token);
     }
+#endif
 
     // Limpeza final
+    cyw43_arch_lwip_begin();
     tcp_server_close(state);
     dns_server_deinit(&dns_server);
     dhcp_server_deinit(&dhcp_server);
-    
-    // Desliga buzzer e LED antes de encerrar
-    gpio_put(RED_LED_GPIO, 0);
-    pwm_set_gpio_level(PWM_GPIO, 0);
+    cyw43_arch_lwip_end();
+    alarm_stop();
 
     cyw43_arch_deinit();
     
     printf("Sistema de alarme desligado\n");
     return 0;
+}
+
+#if PICO_CYW43_ARCH_FREERTOS
+// cyw43_arch_init() precisa do escalonador rodando
+static void main_task(void *arg) {
+    (void)arg;
+    app_main();
+    rtos_exit();
+}
+#endif
+
+int main() {
+    stack_profile_init();
+    stdio_init_all();
+#if PICO_CYW43_ARCH_FREERTOS
+    xTaskCreate(main_task, "main", RTOS_STACK(RTOS_STACK_MAIN), NULL, RTOS_PRIO_MAIN, NULL);
+    vTaskStartScheduler();
+    return 0;
+#else
+    return app_main();
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,160 @@
+/**
+ * Limite de taxa por cliente (ver ratelimit.h).
+ */
+#include <string.h>
+
+#include "ratelimit.h"
+
+// Fichas em milésimos: per_s fichas por segundo são per_s milésimos por ms
+#define TOKEN 1000u
+
+typedef struct {
+    uint32_t tokens;
+    uint32_t last_ms;
+} rate_bucket_t;
+
+typedef struct {
+    uint8_t service;        // rate_limit_service_t
+    uint8_t key_len;        // 0 = entrada livre
+    uint8_t key[RATE_LIMIT_KEY_MAX];
+    rate_bucket_t bucket;
+    bool limited;
+} rate_entry_t;
+
+typedef struct {
+    uint16_t per_s;
+    uint16_t burst;
+} rate_config_t;
+
+static rate_config_t config[RATE_LIMIT_SERVICE_COUNT] = {
+    [RATE_LIMIT_HTTP] = { RATE_LIMIT_HTTP_PER_S, RATE_LIMIT_HTTP_BURST },
+    [RATE_LIMIT_DNS] = { RATE_LIMIT_DNS_PER_S, RATE_LIMIT_DNS_BURST },
+    [RATE_LIMIT_DHCP] = { RATE_LIMIT_DHCP_PER_S, RATE_LIMIT_DHCP_BURST },
+};
+
+static rate_entry_t table[RATE_LIMIT_ENTRIES];
+static rate_limit_stats_t stats;
+
+// Balde comum por serviço, cobrado das origens que não acharam entrada
+static rate_bucket_t overflow[RATE_LIMIT_SERVICE_COUNT] = {
+    [RATE_LIMIT_HTTP] = { RATE_LIMIT_HTTP_BURST * TOKEN, 0 },
+    [RATE_LIMIT_DNS] = { RATE_LIMIT_DNS_BURST * TOKEN, 0 },
+    [RATE_LIMIT_DHCP] = { RATE_LIMIT_DHCP_BURST * TOKEN, 0 },
+};
+
+void rate_limit_set(rate_limit_service_t service, uint16_t per_s, uint16_t burst) {
+    if ((unsigned)service < RATE_LIMIT_SERVICE_COUNT) {
+        config[service].per_s = per_s;
+        config[service].burst = burst ? burst : 1;
+    }
+}
+
+// Fichas do balde em now_ms, com a reposição desde o último pacote
+static uint32_t bucket_level(const rate_bucket_t *b, const rate_config_t *cfg, uint32_t now_ms) {
+    uint64_t tokens = b->tokens + (uint64_t)(now_ms - b->last_ms) * cfg->per_s;
+    uint32_t cap = cfg->burst * TOKEN;
+    return tokens > cap ? cap : (uint32_t)tokens;
+}
+
+static bool bucket_take(rate_bucket_t *b, const rate_config_t *cfg, uint32_t now_ms) {
+    b->tokens = bucket_level(b, cfg, now_ms);
+    b->last_ms = now_ms;
+    if (b->tokens < TOKEN) {
+        return false;
+    }
+    b->tokens -= TOKEN;
+    return true;
+}
+
+// Uma entrada só sai da tabela com o balde cheio de novo: a origem dela não
+// ganha nada voltando mais tarde com um balde novo
+static bool entry_idle(const rate_entry_t *e, uint32_t now_ms) {
+    const rate_config_t *cfg = &config[e->service];
+    return !e->key_len || cfg->per_s == 0 || bucket_level(&e->bucket, cfg, now_ms) == cfg->burst * TOKEN;
+}
+
+// Entrada de (service, key), ou a livre / ociosa usada há mais tempo,
+// reiniciada; NULL se todas as entradas ainda estão gastando fichas
+static rate_entry_t *rate_entry(rate_limit_service_t service, const uint8_t *key, size_t key_len, uint32_t now_ms) {
+    rate_entry_t *victim = NULL;
+    for (rate_entry_t *e = table; e < table + RATE_LIMIT_ENTRIES; e++) {
+        if (e->key_len == key_len && e->service == service && memcmp(e->key, key, key_len) == 0) {
+            return e;
+        }
+        if (entry_idle(e, now_ms) &&
+            (!victim || (victim->key_len &&
+                         (!e->key_len || now_ms - e->bucket.last_ms > now_ms - victim->bucket.last_ms)))) {
+            victim = e;
+        }
+    }
+    if (!victim) {
+        return NULL;
+    }
+    if (victim->key_len) {
+        stats.evictions++;
+    }
+    victim->service = (uint8_t)service;
+    victim->key_len = (uint8_t)key_len;
+    memcpy(victim->key, key, key_len);
+    victim->bucket.tokens = config[service].burst * TOKEN;
+    victim->bucket.last_ms = now_ms;
+    victim->limited = false;
+    return victim;
+}
+
+bool rate_limit_allow(rate_limit_service_t service, const void *key, size_t key_len, uint32_t now_ms) {
+    if ((unsigned)service >= RATE_LIMIT_SERVICE_COUNT) {
+        return true;
+    }
+    const rate_config_t *cfg = &config[service];
+    if (cfg->per_s == 0 || key_len == 0) {
+        stats.allowed[service]++;
+        return true;
+    }
+    if (key_len > RATE_LIMIT_KEY_MAX) {
+        key_len = RATE_LIMIT_KEY_MAX;
+    }
+
+    rate_entry_t *e = rate_entry(service, key, key_len, now_ms);
+    bool ok;
+    if (e) {
+        ok = bucket_take(&e->bucket, cfg, now_ms);
+        e->limited |= !ok;
+    } else {
+        // Tabela cheia de origens ativas: mais origens não trazem mais fichas
+        stats.overflowed++;
+        ok = bucket_take(&overflow[service], cfg, now_ms);
+    }
+    if (!ok) {
+        stats.dropped[service]++;
+        return false;
+    }
+    stats.allowed[service]++;
+    return true;
+}
+
+const char *rate_limit_service_name(rate_limit_service_t service) {
+    static const char *const names[RATE_LIMIT_SERVICE_COUNT] = {
+        [RATE_LIMIT_HTTP] = "http",
+        [RATE_LIMIT_DNS] = "dns",
+        [RATE_LIMIT_DHCP] = "dhcp",
+    };
+    return (unsigned)service < RATE_LIMIT_SERVICE_COUNT ? names[service] : "?";
+}
+
+void rate_limit_get_stats(rate_limit_stats_t *out) {
+    stats.entries = 0;
+    stats.limited = 0;
+    for (const rate_entry_t *e = table; e < table + RATE_LIMIT_ENTRIES; e++) {
+        stats.entries += e->key_len != 0;
+        stats.limited += e->key_len != 0 && e->limited;
+    }
+    *out = stats;
+}
+
+void rate_limit_reset(void) {
+    memset(table, 0, sizeof(table));
+    for (int i = 0; i < RATE_LIMIT_SERVICE_COUNT; i++) {
+        overflow[i].tokens = config[i].burst * TOKEN;
+    }
+}
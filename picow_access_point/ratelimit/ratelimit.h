@@ -0,0 +1,86 @@
+/**
+ * Limite de taxa por cliente (token bucket) para os servidores HTTP, DNS e
+ * DHCP.
+ *
+ * Um celular com defeito (sondas de portal cativo em laço, um app que
+ * martela o DNS) ocupa a pilha inteira, que é de uma thread só. Cada serviço
+ * consulta rate_limit_allow() com a origem do pacote (IPv4 para HTTP e DNS,
+ * MAC do chaddr para DHCP, que chega de 0.0.0.0) antes de qualquer parsing:
+ * cada origem tem um balde de `burst` fichas, reposto a `per_s` fichas por
+ * segundo, e cada pacote ou conexão gasta uma. Sem ficha o serviço descarta:
+ * o UDP é retransmitido pelo cliente mais tarde, a conexão TCP leva RST.
+ *
+ * A tabela é pequena e compartilhada pelos três serviços; cheia, só é
+ * reaproveitada uma entrada cujo balde já se encheu de novo (a origem dela
+ * não perde nada ao voltar com um balde novo). Se todas ainda estão gastando
+ * fichas, a origem nova é cobrada de um balde comum do serviço, com o mesmo
+ * per_s e burst: girar origens (vários celulares, um cliente DHCP trocando de
+ * chaddr) não rende mais que uma origem a mais. Só é chamada no contexto do
+ * lwIP, então não há trava.
+ */
+#ifndef _RATELIMIT_H_
+#define _RATELIMIT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Entradas (serviço, origem) acompanhadas ao mesmo tempo
+#ifndef RATE_LIMIT_ENTRIES
+#define RATE_LIMIT_ENTRIES 16
+#endif
+
+// Maior chave: um MAC
+#define RATE_LIMIT_KEY_MAX 6
+
+// Padrões por serviço; per_s 0 desliga o limite do serviço
+#ifndef RATE_LIMIT_HTTP_PER_S
+#define RATE_LIMIT_HTTP_PER_S   5   // Conexões aceitas
+#endif
+#ifndef RATE_LIMIT_HTTP_BURST
+#define RATE_LIMIT_HTTP_BURST   15  // Uma página com recursos e sondas juntas
+#endif
+#ifndef RATE_LIMIT_DNS_PER_S
+#define RATE_LIMIT_DNS_PER_S    10  // Consultas
+#endif
+#ifndef RATE_LIMIT_DNS_BURST
+#define RATE_LIMIT_DNS_BURST    30  // Rajada de um celular que acabou de conectar
+#endif
+#ifndef RATE_LIMIT_DHCP_PER_S
+#define RATE_LIMIT_DHCP_PER_S   2   // Mensagens
+#endif
+#ifndef RATE_LIMIT_DHCP_BURST
+#define RATE_LIMIT_DHCP_BURST   6   // DISCOVER e REQUEST com retransmissões
+#endif
+
+typedef enum {
+    RATE_LIMIT_HTTP,
+    RATE_LIMIT_DNS,
+    RATE_LIMIT_DHCP,
+    RATE_LIMIT_SERVICE_COUNT,
+} rate_limit_service_t;
+
+typedef struct {
+    uint32_t allowed[RATE_LIMIT_SERVICE_COUNT];
+    uint32_t dropped[RATE_LIMIT_SERVICE_COUNT];
+    uint32_t evictions;     // Entradas reaproveitadas com a tabela cheia
+    uint32_t overflowed;    // Pacotes cobrados do balde comum (nenhuma entrada ociosa)
+    uint16_t entries;       // Entradas em uso
+    uint16_t limited;       // Entradas que já descartaram algo
+} rate_limit_stats_t;
+
+// Troca o limite de um serviço (per_s 0 desliga); as entradas existentes
+// passam a usar o novo limite
+void rate_limit_set(rate_limit_service_t service, uint16_t per_s, uint16_t burst);
+
+// Gasta uma ficha de (service, key); false se o pacote ou a conexão deve ser
+// descartado. now_ms é o relógio do lwIP (sys_now()).
+bool rate_limit_allow(rate_limit_service_t service, const void *key, size_t key_len, uint32_t now_ms);
+
+const char *rate_limit_service_name(rate_limit_service_t service);
+void rate_limit_get_stats(rate_limit_stats_t *stats);
+
+// Esquece todas as origens (os contadores continuam)
+void rate_limit_reset(void);
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * Tarefas do build FreeRTOS (ver rtos_tasks.h).
+ */
+#include <stdio.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "rtos_tasks.h"
+#include "alarm.h"
+#include "work_queue.h"
+#include "latency.h"
+
+static TaskHandle_t alarm_handle;
+static TaskHandle_t http_handle;
+static TaskHandle_t display_handle;
+
+// =============================================
+// Tarefas
+// =============================================
+
+static void alarm_task(void *arg) {
+    (void)arg;
+    TickType_t wake = xTaskGetTickCount();
+    for (;;) {
+        uint32_t t0 = latency_begin();
+        alarm_update();
+        latency_end(LATENCY_LOOP_ALARM, t0);
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(RTOS_ALARM_PERIOD_MS));
+    }
+}
+
+static void display_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        uint32_t t0 = latency_begin();
+        alarm_render();
+        latency_end(LATENCY_LOOP_DISPLAY, t0);
+        vTaskDelay(pdMS_TO_TICKS(RTOS_DISPLAY_PERIOD_MS));
+    }
+}
+
+// Chamado por work_post() na tcpip_thread
+static void http_wakeup(void) {
+    xTaskNotifyGive(http_handle);
+}
+
+static void http_task(void *arg) {
+    (void)arg;
+    for (;;) {
+        // O tempo limite cobre itens postados antes de a tarefa existir
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        uint32_t t0 = latency_begin();
+        uint32_t n = work_run(WORK_QUEUE_SIZE);
+        if (n) {
+            latency_end(LATENCY_LOOP_WORK, t0);
+        }
+    }
+}
+
+// =============================================
+// Interface
+// =============================================
+
+void rtos_tasks_start(void) {
+    xTaskCreate(alarm_task, "alarm", RTOS_STACK(RTOS_STACK_ALARM), NULL, RTOS_PRIO_ALARM, &alarm_handle);
+    xTaskCreate(http_task, "http", RTOS_STACK(RTOS_STACK_HTTP), NULL, RTOS_PRIO_HTTP, &http_handle);
+    xTaskCreate(display_task, "display", RTOS_STACK(RTOS_STACK_DISPLAY), NULL, RTOS_PRIO_DISPLAY, &display_handle);
+    if (!alarm_handle || !http_handle || !display_handle) {
+        printf("failed to create tasks\n");
+    }
+    if (http_handle) {
+        work_queue_set_wakeup(http_wakeup);
+    }
+}
+
+void rtos_tasks_stop(void) {
+    work_queue_set_wakeup(NULL);
+    TaskHandle_t *handles[] = { &alarm_handle, &http_handle, &display_handle };
+    for (size_t i = 0; i < count_of(handles); i++) {
+        if (*handles[i]) {
+            vTaskDelete(*handles[i]);
+            *handles[i] = NULL;
+        }
+    }
+}
+
+void rtos_tasks_print(void) {
+    TaskHandle_t handles[] = { alarm_handle, http_handle, display_handle, xTaskGetCurrentTaskHandle() };
+    printf("task     prio  stack free\n");
+    for (size_t i = 0; i < count_of(handles); i++) {
+        if (!handles[i]) {
+            continue;
+        }
+        printf("%-8s %4u  %6u bytes\n", pcTaskGetName(handles[i]), (unsigned)uxTaskPriorityGet(handles[i]),
+               (unsigned)(uxTaskGetStackHighWaterMark(handles[i]) * sizeof(StackType_t)));
+    }
+}
+
+void rtos_exit(void) {
+#if PICO_ON_DEVICE
+    // O port do RP2040 não tem para onde voltar
+    vTaskDelete(NULL);
+#else
+    vTaskEndScheduler();
+#endif
+}
+
+// configCHECK_FOR_STACK_OVERFLOW
+void vApplicationStackOverflowHook(TaskHandle_t task, char *name) {
+    (void)task;
+    printf("stack overflow in task %s\n", name);
+    configASSERT(0);
+}
@@ -0,0 +1,50 @@
+/**
+ * Tarefas do build FreeRTOS (pico_cyw43_arch_lwip_sys_freertos, NO_SYS=0).
+ *
+ * No lugar do laço principal, cada serviço roda numa tarefa com prioridade
+ * própria:
+ *   alarm    LED e buzzer (alarm_update), a cada RTOS_ALARM_PERIOD_MS
+ *   tcpip    thread do lwIP: recepção TCP e os servidores DHCP e DNS
+ *   http     respostas HTTP adiadas pela fila de work_queue.h
+ *   display  desenho e envio I2C (alarm_render)
+ *   main     inicialização e console
+ * A API raw do lwIP chama os callbacks UDP sempre na tcpip_thread, então DHCP
+ * e DNS não ganham uma tarefa separada: a prioridade deles é TCPIP_THREAD_PRIO.
+ * Só um núcleo é usado pelo escalonador (configNUMBER_OF_CORES=1), o que
+ * mantém válidas as seções com interrupções mascaradas de alarm_post().
+ */
+#ifndef _RTOS_TASKS_H_
+#define _RTOS_TASKS_H_
+
+#include "lwip/opt.h"
+
+#define RTOS_PRIO_ALARM     (TCPIP_THREAD_PRIO + 1)
+#define RTOS_PRIO_HTTP      (TCPIP_THREAD_PRIO - 1)
+#define RTOS_PRIO_DISPLAY   (TCPIP_THREAD_PRIO - 2)
+#define RTOS_PRIO_MAIN      RTOS_PRIO_DISPLAY
+
+// Pilhas em palavras
+#define RTOS_STACK_ALARM    512
+#define RTOS_STACK_HTTP     1024
+#define RTOS_STACK_DISPLAY  1024
+#define RTOS_STACK_MAIN     1024
+// No port POSIX do host a pilha mínima (uma pthread) é maior que essas
+#define RTOS_STACK(words) ((words) > configMINIMAL_STACK_SIZE ? (words) : configMINIMAL_STACK_SIZE)
+
+#define RTOS_ALARM_PERIOD_MS    5
+#define RTOS_DISPLAY_PERIOD_MS  20
+#define RTOS_CONSOLE_PERIOD_MS  50
+
+// Cria as tarefas alarm, http e display; chamar da tarefa main depois de
+// cyw43_arch_init() e alarm_init()
+void rtos_tasks_start(void);
+// Remove as tarefas criadas por rtos_tasks_start()
+void rtos_tasks_stop(void);
+
+// Folga mínima de pilha de cada tarefa (tecla 's')
+void rtos_tasks_print(void);
+
+// Encerra a tarefa main: no host também para o escalonador
+void rtos_exit(void);
+
+#endif
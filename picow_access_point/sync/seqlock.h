@@ -0,0 +1,52 @@
+/**
+ * Seqlock de cópia dupla ("latch") para publicar um instantâneo de estado.
+ *
+ * Um único escritor atualiza duas cópias em sequência: com a sequência ímpar
+ * os leitores usam a cópia 1 enquanto a 0 é escrita, e com ela par usam a 0
+ * enquanto a 1 é escrita. As duas cópias precisam começar iguais. O leitor nunca
+ * espera o escritor, então pode rodar numa interrupção que interrompeu a
+ * escrita no mesmo núcleo; só repete a leitura se a sequência mudou no meio.
+ */
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef struct {
+    atomic_uint seq;
+    size_t size;
+    void *copy[2];
+} seqlock_t;
+
+static inline void seqlock_init(seqlock_t *l, void *copy0, void *copy1, size_t size) {
+    atomic_init(&l->seq, 0);
+    l->size = size;
+    l->copy[0] = copy0;
+    l->copy[1] = copy1;
+}
+
+// Escritor: cada cópia é atualizada enquanto os leitores apontam para a outra
+static inline void seqlock_write(seqlock_t *l, const void *data) {
+    unsigned seq = atomic_load_explicit(&l->seq, memory_order_relaxed);
+    // release: a cópia 1 da escrita anterior precisa estar completa antes de
+    // os leitores passarem para ela
+    atomic_store_explicit(&l->seq, seq + 1, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(l->copy[0], data, l->size);
+    atomic_store_explicit(&l->seq, seq + 2, memory_order_release);
+    atomic_thread_fence(memory_order_release);
+    memcpy(l->copy[1], data, l->size);
+}
+
+static inline void seqlock_read(seqlock_t *l, void *data) {
+    unsigned seq;
+    do {
+        seq = atomic_load_explicit(&l->seq, memory_order_acquire);
+        memcpy(data, l->copy[seq & 1], l->size);
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&l->seq, memory_order_relaxed) != seq);
+}
+
+#endif
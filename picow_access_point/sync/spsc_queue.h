@@ -0,0 +1,79 @@
+/**
+ * Fila circular sem trava para um produtor e um consumidor.
+ *
+ * O produtor só escreve head e o consumidor só escreve tail; cada lado lê o
+ * índice do outro com acquire e publica o seu com release, então a fila
+ * funciona entre núcleos e também entre uma interrupção e o laço do mesmo
+ * núcleo. Usa apenas load/store atômicos de 32 bits (sem LDREX/STREX, que o
+ * Cortex-M0+ não tem). A capacidade precisa ser potência de 2.
+ */
+#ifndef _SPSC_QUEUE_H_
+#define _SPSC_QUEUE_H_
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct {
+    atomic_uint head;       // Próxima posição a escrever (produtor)
+    atomic_uint tail;       // Próxima posição a ler (consumidor)
+    uint32_t mask;
+    uint32_t elem_size;
+    uint8_t *buf;
+} spsc_queue_t;
+
+static inline void spsc_queue_init(spsc_queue_t *q, void *storage, uint32_t elem_size, uint32_t capacity) {
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    q->mask = capacity - 1;
+    q->elem_size = elem_size;
+    q->buf = storage;
+}
+
+// Produtor: false se a fila estiver cheia
+static inline bool spsc_queue_push(spsc_queue_t *q, const void *elem) {
+    unsigned head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    if (head - tail > q->mask) {
+        return false;
+    }
+    memcpy(q->buf + (head & q->mask) * q->elem_size, elem, q->elem_size);
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return true;
+}
+
+// Consumidor: false se a fila estiver vazia
+static inline bool spsc_queue_pop(spsc_queue_t *q, void *elem) {
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&q->head, memory_order_acquire);
+    if (head == tail) {
+        return false;
+    }
+    memcpy(elem, q->buf + (tail & q->mask) * q->elem_size, q->elem_size);
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return true;
+}
+
+// Consumidor: retira até max elementos de uma vez, publicando tail uma só vez
+static inline uint32_t spsc_queue_pop_batch(spsc_queue_t *q, void *out, uint32_t max) {
+    unsigned tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned head = atomic_load_explicit(&q->head, memory_order_acquire);
+    uint32_t n = head - tail;
+    if (n > max) {
+        n = max;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        memcpy((uint8_t *)out + i * q->elem_size, q->buf + ((tail + i) & q->mask) * q->elem_size, q->elem_size);
+    }
+    if (n) {
+        atomic_store_explicit(&q->tail, tail + n, memory_order_release);
+    }
+    return n;
+}
+
+static inline uint32_t spsc_queue_count(spsc_queue_t *q) {
+    return atomic_load_explicit(&q->head, memory_order_acquire) - atomic_load_explicit(&q->tail, memory_order_acquire);
+}
+
+#endif
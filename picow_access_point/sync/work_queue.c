@@ -0,0 +1,83 @@
+/**
+ * Fila de trabalho adiado sobre a fila SPSC.
+ */
+#include <stdatomic.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "work_queue.h"
+#include "spsc_queue.h"
+#include "latency.h"
+
+typedef struct {
+    work_fn_t fn;
+    void *arg;
+    uint32_t t_us;          // latency_begin() na postagem
+} work_item_t;
+
+static work_item_t work_storage[WORK_QUEUE_SIZE];
+static spsc_queue_t work_queue;
+
+// posted/full/max_depth: só o produtor escreve; ran: só o consumidor
+static atomic_uint work_posted;
+static atomic_uint work_ran;
+static atomic_uint work_full;
+static atomic_uint work_max_depth;
+
+static work_wakeup_fn work_wakeup;
+
+void work_queue_init(void) {
+    spsc_queue_init(&work_queue, work_storage, sizeof(work_item_t), WORK_QUEUE_SIZE);
+}
+
+void work_queue_set_wakeup(work_wakeup_fn fn) {
+    work_wakeup = fn;
+}
+
+bool work_post(work_fn_t fn, void *arg) {
+    work_item_t item = { .fn = fn, .arg = arg, .t_us = latency_begin() };
+    if (!spsc_queue_push(&work_queue, &item)) {
+        atomic_store_explicit(&work_full, atomic_load_explicit(&work_full, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return false;
+    }
+    atomic_store_explicit(&work_posted, atomic_load_explicit(&work_posted, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    uint32_t depth = spsc_queue_count(&work_queue);
+    if (depth > atomic_load_explicit(&work_max_depth, memory_order_relaxed)) {
+        atomic_store_explicit(&work_max_depth, depth, memory_order_relaxed);
+    }
+    if (work_wakeup) {
+        work_wakeup();
+    } else {
+        // Tira o laço principal do WFE (sleep/best_effort_wfe_or_timeout)
+        __sev();
+    }
+    return true;
+}
+
+uint32_t work_run(uint32_t max) {
+    uint32_t n = 0;
+    work_item_t item;
+    while (n < max && spsc_queue_pop(&work_queue, &item)) {
+        latency_end(LATENCY_WORK_QUEUE, item.t_us);
+        item.fn(item.arg);
+        n++;
+    }
+    if (n) {
+        atomic_store_explicit(&work_ran, atomic_load_explicit(&work_ran, memory_order_relaxed) + n,
+                              memory_order_relaxed);
+    }
+    return n;
+}
+
+uint32_t work_pending(void) {
+    return spsc_queue_count(&work_queue);
+}
+
+void work_queue_get_stats(work_queue_stats_t *stats) {
+    stats->posted = atomic_load_explicit(&work_posted, memory_order_relaxed);
+    stats->ran = atomic_load_explicit(&work_ran, memory_order_relaxed);
+    stats->full = atomic_load_explicit(&work_full, memory_order_relaxed);
+    stats->max_depth = atomic_load_explicit(&work_max_depth, memory_order_relaxed);
+}
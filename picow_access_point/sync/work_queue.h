@@ -0,0 +1,48 @@
+/**
+ * Fila de trabalho adiado: os callbacks do lwIP só registram o que precisa
+ * ser feito e o laço principal executa depois, em contexto de thread.
+ *
+ * No build background os callbacks rodam dentro da interrupção do CYW43
+ * (async_context); gerar a resposta HTTP ali (snprintf, printf)
+ * atrasa todos os outros pacotes. O produtor é sempre o contexto do lwIP (um
+ * só) e o consumidor é o laço principal, então basta a fila SPSC. O item
+ * guarda o instante da postagem para medir a espera (LATENCY_WORK_QUEUE).
+ */
+#ifndef _WORK_QUEUE_H_
+#define _WORK_QUEUE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Capacidade da fila (potência de 2); cada conexão TCP tem no máximo um item
+#ifndef WORK_QUEUE_SIZE
+#define WORK_QUEUE_SIZE 8
+#endif
+
+typedef void (*work_fn_t)(void *arg);
+typedef void (*work_wakeup_fn)(void);
+
+typedef struct {
+    uint32_t posted;        // Itens aceitos
+    uint32_t ran;           // Itens executados
+    uint32_t full;          // Postagens recusadas por fila cheia
+    uint32_t max_depth;     // Maior ocupação vista ao postar
+} work_queue_stats_t;
+
+void work_queue_init(void);
+
+// Troca o aviso dado ao consumidor a cada postagem (NULL volta ao __sev(),
+// que acorda o laço principal do WFE); o build FreeRTOS notifica a tarefa http
+void work_queue_set_wakeup(work_wakeup_fn fn);
+
+// Contexto do lwIP: false se a fila estiver cheia (o chamador decide se faz
+// o trabalho na hora). Avisa o consumidor (work_queue_set_wakeup).
+bool work_post(work_fn_t fn, void *arg);
+
+// Laço principal: executa até max itens e retorna quantos executou
+uint32_t work_run(uint32_t max);
+
+uint32_t work_pending(void);
+void work_queue_get_stats(work_queue_stats_t *stats);
+
+#endif
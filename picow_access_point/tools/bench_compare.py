@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Compara resultados do picow_bench (--json) lado a lado.
+
+Cada arquivo é uma execução da mesma carga contra uma variante do firmware
+(background, poll, freertos, ou os executáveis host). O nome da coluna é o
+nome do arquivo sem extensão, ou o rótulo dado como rotulo=arquivo.
+
+Uso:
+    picow_bench --spawn build_host/host/picow_access_point_host --clients 8 \\
+        --duration 30 --json poll.json
+    picow_bench --spawn build_host/host/picow_access_point_freertos_host \\
+        --clients 8 --duration 30 --json freertos.json
+    tools/bench_compare.py poll.json freertos.json
+"""
+import argparse
+import json
+import os
+import sys
+
+ROWS = [
+    ("vazão (req/s)", lambda r: r["throughput_rps"], "%.1f"),
+    ("p50 (ms)", lambda r: r["latency_us"]["p50"] / 1000.0, "%.2f"),
+    ("p99 (ms)", lambda r: r["latency_us"]["p99"] / 1000.0, "%.2f"),
+    ("p99.9 (ms)", lambda r: r["latency_us"]["p999"] / 1000.0, "%.2f"),
+    ("max (ms)", lambda r: r["latency_us"]["max"] / 1000.0, "%.2f"),
+    ("completas", lambda r: r["requests"]["completed"], "%d"),
+    ("recusas", lambda r: r["requests"]["refused"], "%d"),
+    ("timeouts", lambda r: r["requests"]["timeouts"], "%d"),
+    ("erros", lambda r: r["requests"]["errors"], "%d"),
+    ("heap pico (bytes)", lambda r: r["server"]["heap"]["peak"], "%d"),
+]
+
+
+def load(spec):
+    label, sep, path = spec.partition("=")
+    if not sep:
+        path = spec
+        label = os.path.splitext(os.path.basename(spec))[0]
+    with open(path) as f:
+        return label, json.load(f)
+
+
+def cell(fmt, getter, result):
+    try:
+        return fmt % getter(result)
+    except (KeyError, TypeError):
+        return "-"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("results", nargs="+", help="saídas --json do picow_bench ([rotulo=]arquivo)")
+    args = ap.parse_args()
+
+    runs = [load(spec) for spec in args.results]
+    configs = {json.dumps(r["config"], sort_keys=True) for _, r in runs}
+    if len(configs) > 1:
+        print("aviso: as execuções não usaram a mesma carga (config difere)", file=sys.stderr)
+
+    width = max(12, max(len(label) for label, _ in runs))
+    print("%-20s" % "" + "".join("%*s" % (width + 2, label) for label, _ in runs))
+    for name, getter, fmt in ROWS:
+        print("%-20s" % name + "".join("%*s" % (width + 2, cell(fmt, getter, r)) for _, r in runs))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,219 @@
+#!/usr/bin/env python3
+"""Gera a imagem dos arquivos estáticos do painel (web/) para a flash.
+
+Cada arquivo é minificado (de forma conservadora, por tipo: comentários,
+indentação e linhas em branco), comprimido com gzip e gravado como um vetor
+const, que no dispositivo fica na flash (XIP). Junto vão, já prontos, o ETag (hash do conteúdo comprimido) e os
+blocos de headers da resposta 200 (com Content-Length, Content-Encoding e
+Cache-Control) e da 304: o servidor não formata nada por requisição.
+
+Os arquivos são servidos só em gzip, que todo navegador aceita; um
+index.html também responde pelo diretório ("/"). A busca é o mesmo hash
+perfeito sobre "GET caminho" de gen_routes.py.
+
+Saída: web_assets.h (web_asset_t e o protótipo de web_asset_lookup) e
+web_assets.c (dados, tabela e busca).
+
+Uso:
+    gen_assets.py web --out build/generated
+"""
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+sys.dont_write_bytecode = True  # Nada de __pycache__ em tools/ durante o build
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from gen_routes import MASK, c_char_expr, choose_positions, find_seed, mix  # noqa: E402
+
+CONTENT_TYPES = {
+    ".html": "text/html; charset=utf-8",
+    ".css": "text/css",
+    ".js": "text/javascript",
+    ".json": "application/json",
+    ".svg": "image/svg+xml",
+    ".ico": "image/x-icon",
+    ".png": "image/png",
+    ".txt": "text/plain; charset=utf-8",
+}
+# Sem fingerprint no nome, o navegador revalida sempre; com o ETag, a
+# revalidação custa uma resposta 304 sem corpo
+CACHE_CONTROL = "no-cache"
+INDEX = "index.html"
+
+
+def minify_html(text):
+    text = re.sub(r"<!--.*?-->", "", text, flags=re.S)
+    lines = [line.strip() for line in text.splitlines()]
+    text = "\n".join(line for line in lines if line)
+    return re.sub(r">\s+<", "><", text)
+
+
+def minify_css(text):
+    text = re.sub(r"/\*.*?\*/", "", text, flags=re.S)
+    text = re.sub(r"\s+", " ", text)
+    text = re.sub(r"\s*([{}:;,>])\s*", r"\1", text)
+    return text.replace(";}", "}").strip()
+
+
+def minify_js(text):
+    # Só linhas inteiras de comentário e espaços nas pontas: as quebras de
+    # linha ficam, então a inserção automática de ';' não muda
+    lines = [line.strip() for line in text.splitlines()]
+    return "\n".join(line for line in lines if line and not line.startswith("//"))
+
+
+MINIFIERS = {".html": minify_html, ".css": minify_css, ".js": minify_js}
+
+
+def load(web_dir):
+    assets = []
+    for root, dirs, files in os.walk(web_dir):
+        dirs.sort()
+        for name in sorted(files):
+            if name.startswith("."):
+                continue
+            full = os.path.join(root, name)
+            rel = os.path.relpath(full, web_dir).replace(os.sep, "/")
+            ext = os.path.splitext(name)[1].lower()
+            if ext not in CONTENT_TYPES:
+                sys.exit("%s: tipo desconhecido" % full)
+            with open(full, "rb") as f:
+                raw = f.read()
+            minified = raw
+            if ext in MINIFIERS:
+                minified = MINIFIERS[ext](raw.decode("utf-8")).encode("utf-8")
+            # mtime 0: a imagem (e o ETag) só muda quando o conteúdo muda
+            data = gzip.compress(minified, compresslevel=9, mtime=0)
+            paths = ["/" + rel]
+            if name == INDEX:
+                paths.insert(0, "/" + rel[:-len(INDEX)])
+            assets.append({
+                "paths": paths,
+                "type": CONTENT_TYPES[ext],
+                "raw_len": len(raw),
+                "min_len": len(minified),
+                "data": data,
+                "etag": '"%s"' % hashlib.sha256(data).hexdigest()[:16],
+            })
+    if not assets:
+        sys.exit("%s: nenhum arquivo" % web_dir)
+    return assets
+
+
+# Linha de status e headers terminam em CRLF (RFC 9112, seção 2.1)
+def headers_ok(asset):
+    return ("HTTP/1.1 200 OK\r\nContent-Length: %d\r\nContent-Type: %s\r\nContent-Encoding: gzip\r\n"
+            "ETag: %s\r\nCache-Control: %s\r\nConnection: close\r\n\r\n"
+            % (len(asset["data"]), asset["type"], asset["etag"], CACHE_CONTROL))
+
+
+def headers_not_modified(asset):
+    return ("HTTP/1.1 304 Not Modified\r\nETag: %s\r\nCache-Control: %s\r\nConnection: close\r\n\r\n"
+            % (asset["etag"], CACHE_CONTROL))
+
+
+def c_literal(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"').replace("\r", "\\r").replace("\n", "\\n") + '"'
+
+
+def write_header(path, assets):
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_assets.py a partir de web/; não editar\n")
+        f.write("#ifndef _WEB_ASSETS_H_\n#define _WEB_ASSETS_H_\n\n")
+        f.write("#include <stddef.h>\n#include <stdint.h>\n\n")
+        f.write("#define WEB_ASSET_COUNT %d\n\n" % len(assets))
+        f.write("typedef struct {\n"
+                "    const char *path;\n"
+                "    const char *etag;           // Com as aspas, como no header\n"
+                "    const uint8_t *data;        // Conteúdo em gzip\n"
+                "    uint32_t len;\n"
+                "    uint32_t raw_len;           // Tamanho do arquivo em web/\n"
+                "    uint32_t min_len;           // Depois da minificação\n"
+                "    const char *headers;        // Resposta 200, até a linha em branco\n"
+                "    uint16_t headers_len;\n"
+                "    const char *not_modified;   // Resposta 304 completa\n"
+                "    uint16_t not_modified_len;\n"
+                "} web_asset_t;\n\n")
+        f.write("extern const web_asset_t web_assets[WEB_ASSET_COUNT];\n\n")
+        f.write("// key aponta para \"GET caminho\" (len bytes, sem terminador); NULL se\n"
+                "// não for um arquivo do painel\n")
+        f.write("const web_asset_t *web_asset_lookup(const char *key, size_t len);\n\n#endif\n")
+
+
+def write_source(path, assets, keys, index, positions, seed, bits):
+    slots = [None] * (1 << bits)
+    for key, i in zip(keys, index):
+        slots[((mix(key, positions) * seed) & MASK) >> (32 - bits)] = (key, i)
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_assets.py a partir de web/; não editar\n")
+        total = sum(len(a["data"]) for a in assets)
+        f.write("// %d arquivos, %d bytes em gzip (%d no original)\n"
+                % (len(assets), total, sum(a["raw_len"] for a in assets)))
+        f.write("#include <string.h>\n\n#include \"web_assets.h\"\n\n")
+        for i, a in enumerate(assets):
+            f.write("// %s: %d -> %d -> %d bytes\n" % (a["paths"][-1], a["raw_len"], a["min_len"], len(a["data"])))
+            f.write("static const uint8_t web_asset_data_%d[%d] = {" % (i, len(a["data"])))
+            for j, b in enumerate(a["data"]):
+                f.write(("\n    " if j % 16 == 0 else " ") + "0x%02x," % b)
+            f.write("\n};\n\n")
+        f.write("const web_asset_t web_assets[WEB_ASSET_COUNT] = {\n")
+        for i, a in enumerate(assets):
+            ok, nm = headers_ok(a), headers_not_modified(a)
+            f.write("    {\n")
+            f.write("        .path = %s,\n" % c_literal(a["paths"][-1]))
+            f.write("        .etag = %s,\n" % c_literal(a["etag"]))
+            f.write("        .data = web_asset_data_%d,\n" % i)
+            f.write("        .len = %d,\n" % len(a["data"]))
+            f.write("        .raw_len = %d,\n" % a["raw_len"])
+            f.write("        .min_len = %d,\n" % a["min_len"])
+            f.write("        .headers = %s,\n" % c_literal(ok))
+            f.write("        .headers_len = %d,\n" % len(ok))
+            f.write("        .not_modified = %s,\n" % c_literal(nm))
+            f.write("        .not_modified_len = %d,\n" % len(nm))
+            f.write("    },\n")
+        f.write("};\n\n")
+        f.write("#define WEB_ASSET_SEED 0x%08Xu\n#define WEB_ASSET_BITS %d\n\n" % (seed, bits))
+        f.write("typedef struct {\n    uint8_t len;            // 0 = posição vazia\n"
+                "    uint8_t asset;\n    const char *key;\n} web_asset_slot_t;\n\n")
+        f.write("static const web_asset_slot_t web_asset_slots[1 << WEB_ASSET_BITS] = {\n")
+        for i, entry in enumerate(slots):
+            if entry:
+                f.write("    [%d] = { %d, %d, %s },\n" % (i, len(entry[0]), entry[1], c_literal(entry[0].decode())))
+        f.write("};\n\n")
+        f.write("const web_asset_t *web_asset_lookup(const char *key, size_t len) {\n")
+        f.write("    uint32_t h = (uint32_t)len;\n")
+        for p in positions:
+            f.write("    h = h * 31u + %s;\n" % c_char_expr(p))
+        f.write("    const web_asset_slot_t *slot = &web_asset_slots[(h * WEB_ASSET_SEED) >> (32 - WEB_ASSET_BITS)];\n")
+        f.write("    if (slot->len != len || memcmp(slot->key, key, len) != 0) {\n")
+        f.write("        return NULL;\n    }\n")
+        f.write("    return &web_assets[slot->asset];\n}\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("web", help="diretório dos arquivos (web/)")
+    ap.add_argument("--out", required=True, help="diretório de saída")
+    args = ap.parse_args()
+
+    assets = load(args.web)
+    keys, index = [], []
+    for i, a in enumerate(assets):
+        for p in a["paths"]:
+            keys.append(("GET " + p).encode())
+            index.append(i)
+    if max(len(k) for k in keys) > 255 or len(keys) > 255:
+        sys.exit("arquivos demais ou caminho longo demais")
+    positions = choose_positions(keys)
+    seed, bits = find_seed(keys, positions)
+
+    os.makedirs(args.out, exist_ok=True)
+    write_header(os.path.join(args.out, "web_assets.h"), assets)
+    write_source(os.path.join(args.out, "web_assets.c"), assets, keys, index, positions, seed, bits)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Gera o despachante de rotas HTTP (hash perfeito) a partir de routes.def.
+
+A chave de uma rota é o começo da linha de requisição, "MÉTODO caminho"
+(ex.: "GET /alarm"). Como no gperf, o hash não percorre a chave: usa o
+comprimento e os caracteres de poucas posições (contadas do início ou do fim),
+escolhidas aqui de forma que nenhum par de rotas coincida. Uma semente
+multiplicativa é então procurada até que cada rota caia numa posição própria
+de uma tabela com tamanho potência de 2. A busca custa um hash de poucas
+operações e no máximo uma comparação de memória; um caminho desconhecido quase
+sempre é descartado pelo comprimento sem comparar nenhum byte.
+
+Saída: http_routes.h (enum das rotas, X-macro HTTP_ROUTES e o protótipo de
+http_route_lookup) e http_routes.c (tabela e busca).
+
+Uso:
+    gen_routes.py http/routes.def --out build/generated
+"""
+import argparse
+import os
+import random
+import sys
+
+METHODS = ("GET", "HEAD", "POST", "PUT", "DELETE", "OPTIONS", "PATCH")
+MASK = 0xFFFFFFFF
+MAX_SEEDS = 200000
+
+
+def parse(path):
+    routes = []
+    with open(path, encoding="utf-8") as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            fields = line.split()
+            if len(fields) != 4:
+                sys.exit("%s:%d: esperado 'método caminho nome handler'" % (path, lineno))
+            method, url, name, handler = fields
+            if method not in METHODS:
+                sys.exit("%s:%d: método desconhecido %s" % (path, lineno, method))
+            if not url.startswith("/") or "?" in url:
+                sys.exit("%s:%d: caminho inválido %s" % (path, lineno, url))
+            if not name.isidentifier() or not (handler == "-" or handler.isidentifier()):
+                sys.exit("%s:%d: nome ou handler inválido" % (path, lineno))
+            routes.append((name, method, url, None if handler == "-" else handler))
+    if not routes:
+        sys.exit("%s: nenhuma rota" % path)
+    if len({r[0] for r in routes}) < len(routes):
+        sys.exit("%s: nome de rota repetido" % path)
+    if len({(r[1], r[2]) for r in routes}) < len(routes):
+        sys.exit("%s: rota repetida" % path)
+    return routes
+
+
+def key_of(route):
+    return ("%s %s" % (route[1], route[2])).encode()
+
+
+def char_at(key, pos):
+    # pos >= 0 conta do início, pos < 0 do fim; fora da chave vale 0
+    i = pos if pos >= 0 else len(key) + pos
+    return key[i] if 0 <= i < len(key) else 0
+
+
+def signature(key, positions):
+    return (len(key),) + tuple(char_at(key, p) for p in positions)
+
+
+def choose_positions(keys):
+    longest = max(len(k) for k in keys)
+    candidates = [p for i in range(longest) for p in (i, -1 - i)]
+    positions = []
+    while len({signature(k, positions) for k in keys}) < len(keys):
+        best = max(candidates, key=lambda p: len({signature(k, positions + [p]) for k in keys}))
+        positions.append(best)
+        candidates.remove(best)
+    return positions
+
+
+def mix(key, positions):
+    h = len(key)
+    for p in positions:
+        h = (h * 31 + char_at(key, p)) & MASK
+    return h
+
+
+def find_seed(keys, positions):
+    hashes = [mix(k, positions) for k in keys]
+    bits = max(1, (len(keys) - 1).bit_length())
+    while bits <= 16:
+        # Sementes ímpares pseudoaleatórias, sempre na mesma ordem: a saída
+        # não muda entre builds
+        rng = random.Random(bits)
+        for _ in range(MAX_SEEDS):
+            seed = rng.getrandbits(32) | 1
+            slots = {((h * seed) & MASK) >> (32 - bits) for h in hashes}
+            if len(slots) == len(keys):
+                return seed, bits
+        bits += 1
+    sys.exit("nenhuma semente encontrada")
+
+
+def c_char_expr(pos):
+    if pos >= 0:
+        return "(len > %d ? (uint8_t)key[%d] : 0u)" % (pos, pos)
+    return "(len >= %d ? (uint8_t)key[len - %d] : 0u)" % (-pos, -pos)
+
+
+def c_string(data):
+    return '"' + data.decode().replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def write_header(path, routes, source):
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_routes.py a partir de %s; não editar\n" % source)
+        f.write("#ifndef _HTTP_ROUTES_H_\n#define _HTTP_ROUTES_H_\n\n")
+        f.write("#include <stddef.h>\n\n")
+        f.write("typedef enum {\n    HTTP_ROUTE_NONE = -1,\n")
+        for name, _, _, _ in routes:
+            f.write("    HTTP_ROUTE_%s,\n" % name)
+        f.write("    HTTP_ROUTE_COUNT,\n} http_route_id_t;\n\n")
+        f.write("// X(nome, método, caminho, handler); handler NULL = servida pelo servidor\n")
+        f.write("#define HTTP_ROUTES(X) \\\n")
+        for name, method, url, handler in routes:
+            f.write('    X(%s, "%s", "%s", %s) \\\n' % (name, method, url, handler or "NULL"))
+        f.write("\n")
+        f.write("// key aponta para \"MÉTODO caminho\" (len bytes, sem terminador)\n")
+        f.write("http_route_id_t http_route_lookup(const char *key, size_t len);\n\n#endif\n")
+
+
+def write_source(path, routes, keys, positions, seed, bits, source):
+    slots = [None] * (1 << bits)
+    for route, key in zip(routes, keys):
+        slot = ((mix(key, positions) * seed) & MASK) >> (32 - bits)
+        slots[slot] = (route[0], key)
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_routes.py a partir de %s; não editar\n" % source)
+        f.write("// %d rotas numa tabela de %d; posições da chave usadas no hash: %s\n"
+                % (len(routes), len(slots), ", ".join(str(p) for p in positions) or "nenhuma"))
+        f.write("#include <stdint.h>\n#include <string.h>\n\n#include \"http_routes.h\"\n\n")
+        f.write("#define HTTP_ROUTE_SEED 0x%08Xu\n#define HTTP_ROUTE_BITS %d\n\n" % (seed, bits))
+        f.write("typedef struct {\n    uint8_t len;            // 0 = posição vazia\n"
+                "    int8_t id;\n    const char *key;\n} http_route_slot_t;\n\n")
+        f.write("static const http_route_slot_t http_route_slots[1 << HTTP_ROUTE_BITS] = {\n")
+        for i, entry in enumerate(slots):
+            if entry:
+                f.write("    [%d] = { %d, HTTP_ROUTE_%s, %s },\n" % (i, len(entry[1]), entry[0], c_string(entry[1])))
+        f.write("};\n\n")
+        f.write("http_route_id_t http_route_lookup(const char *key, size_t len) {\n")
+        f.write("    uint32_t h = (uint32_t)len;\n")
+        for p in positions:
+            f.write("    h = h * 31u + %s;\n" % c_char_expr(p))
+        f.write("    const http_route_slot_t *slot = &http_route_slots[(h * HTTP_ROUTE_SEED) >> (32 - HTTP_ROUTE_BITS)];\n")
+        f.write("    if (slot->len != len || memcmp(slot->key, key, len) != 0) {\n")
+        f.write("        return HTTP_ROUTE_NONE;\n    }\n")
+        f.write("    return (http_route_id_t)slot->id;\n}\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("routes", help="arquivo de rotas (routes.def)")
+    ap.add_argument("--out", required=True, help="diretório de saída")
+    args = ap.parse_args()
+
+    routes = parse(args.routes)
+    keys = [key_of(r) for r in routes]
+    if max(len(k) for k in keys) > 255 or len(routes) > 127:
+        sys.exit("rotas demais ou caminho longo demais")
+    positions = choose_positions(keys)
+    seed, bits = find_seed(keys, positions)
+
+    os.makedirs(args.out, exist_ok=True)
+    source = os.path.basename(args.routes)
+    write_header(os.path.join(args.out, "http_routes.h"), routes, source)
+    write_source(os.path.join(args.out, "http_routes.c"), routes, keys, positions, seed, bits, source)
+
+
+if __name__ == "__main__":
+    main()
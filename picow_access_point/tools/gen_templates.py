@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Compila os templates de resposta (templates/) em sequências de operações.
+
+Um template é texto com slots {{nome}} (string) ou {{nome:u}} (inteiro sem
+sinal, em decimal). Cada arquivo vira um vetor const de operações: literais,
+guardados prontos na flash, e slots, preenchidos na hora com os valores do
+handler. O servidor não interpreta formato nenhum por requisição: percorre as
+operações, e o tamanho do texto (o Content-Length) é a soma dos literais,
+calculada aqui, mais a largura de cada slot.
+
+Os nomes de slot são comuns a todos os templates (um só enum), então um mesmo
+vetor de valores serve, por exemplo, aos headers e à página de erro. Arquivos
+.html são minificados como em gen_assets.py; os .http (headers de resposta)
+são usados byte a byte, inclusive a linha em branco do fim, só com cada fim
+de linha trocado por CRLF, que é o que o HTTP/1.1 pede (RFC 9112, seção 2.1):
+o arquivo fica com LF, como o resto do repositório.
+
+Saída: http_templates.h (enum dos slots e os templates) e
+http_templates.c (literais e operações).
+
+Uso:
+    gen_templates.py templates --out build/generated
+"""
+import argparse
+import os
+import re
+import sys
+
+sys.dont_write_bytecode = True  # Nada de __pycache__ em tools/ durante o build
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from gen_assets import c_literal, minify_html  # noqa: E402
+
+
+def http_crlf(text):
+    """Fins de linha do arquivo (LF ou CRLF) viram CRLF."""
+    return text.replace("\r\n", "\n").replace("\n", "\r\n")
+
+
+SLOT_RE = re.compile(r"\{\{\s*([A-Za-z_][A-Za-z0-9_]*)\s*(?::\s*([a-z]+)\s*)?\}\}")
+SLOT_KINDS = {None: "HTTP_TMPL_STR", "u": "HTTP_TMPL_UINT"}
+EXTENSIONS = {".html": minify_html, ".http": http_crlf}
+# Mesmo valor de HTTP_TEMPLATE_MAX_SLOTS em http/http_template.h
+MAX_SLOTS = 16
+
+
+def parse(path, text):
+    """Lista de ("text", literal) e ("slot", nome, tipo)."""
+    ops, pos = [], 0
+    for m in SLOT_RE.finditer(text):
+        if m.start() > pos:
+            ops.append(("text", text[pos:m.start()]))
+        kind = m.group(2)
+        if kind not in SLOT_KINDS:
+            sys.exit("%s: tipo de slot desconhecido '%s'" % (path, kind))
+        ops.append(("slot", m.group(1), kind))
+        pos = m.end()
+    if pos < len(text):
+        ops.append(("text", text[pos:]))
+    rest = SLOT_RE.sub("", text)
+    if "{{" in rest or "}}" in rest:
+        sys.exit("%s: slot mal formado" % path)
+    return ops
+
+
+def load(template_dir):
+    templates = []
+    for name in sorted(os.listdir(template_dir)):
+        base, ext = os.path.splitext(name)
+        if name.startswith(".") or ext not in EXTENSIONS:
+            continue
+        if not base.isidentifier():
+            sys.exit("%s: nome precisa ser um identificador C" % name)
+        full = os.path.join(template_dir, name)
+        with open(full, encoding="utf-8") as f:
+            text = f.read()
+        if EXTENSIONS[ext]:
+            text = EXTENSIONS[ext](text)
+        templates.append({"name": base, "file": name, "ops": parse(full, text)})
+    if not templates:
+        sys.exit("%s: nenhum template" % template_dir)
+    if len({t["name"] for t in templates}) < len(templates):
+        sys.exit("%s: nome de template repetido" % template_dir)
+    return templates
+
+
+def collect_slots(templates):
+    slots = {}
+    for t in templates:
+        for op in t["ops"]:
+            if op[0] != "slot":
+                continue
+            name, kind = op[1], op[2]
+            if slots.setdefault(name, kind) != kind:
+                sys.exit("%s: slot '%s' com tipos diferentes entre templates" % (t["file"], name))
+    if len(slots) > MAX_SLOTS:
+        sys.exit("slots demais (%d, máximo %d)" % (len(slots), MAX_SLOTS))
+    return sorted(slots)
+
+
+def text_len(op):
+    return len(op[1].encode("utf-8"))
+
+
+def write_header(path, templates, slots):
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_templates.py a partir de templates/; não editar\n")
+        f.write("#ifndef _HTTP_TEMPLATES_H_\n#define _HTTP_TEMPLATES_H_\n\n")
+        f.write("#include \"http_template.h\"\n\n")
+        f.write("// Índice de cada slot no vetor de valores, comum a todos os templates\n")
+        f.write("typedef enum {\n")
+        for s in slots:
+            f.write("    HTTP_SLOT_%s,\n" % s.upper())
+        f.write("    HTTP_SLOT_COUNT,\n} http_slot_t;\n\n")
+        f.write("_Static_assert(HTTP_SLOT_COUNT <= HTTP_TEMPLATE_MAX_SLOTS, \"slots demais\");\n\n")
+        for t in templates:
+            f.write("extern const http_template_t http_template_%s;   // %s\n" % (t["name"], t["file"]))
+        f.write("\n#endif\n")
+
+
+def write_source(path, templates):
+    with open(path, "w") as f:
+        f.write("// Gerado por tools/gen_templates.py a partir de templates/; não editar\n")
+        f.write("#include \"http_templates.h\"\n\n")
+        for t in templates:
+            ops = t["ops"]
+            fixed = sum(text_len(op) for op in ops if op[0] == "text")
+            names = ", ".join(op[1] for op in ops if op[0] == "slot") or "sem slots"
+            f.write("// %s: %d bytes de literais, %d operações (%s)\n" % (t["file"], fixed, len(ops), names))
+            f.write("static const http_tmpl_op_t http_template_%s_ops[%d] = {\n" % (t["name"], len(ops)))
+            for op in ops:
+                if op[0] == "text":
+                    f.write("    { HTTP_TMPL_TEXT, 0, %d, %s },\n" % (text_len(op), c_literal(op[1])))
+                else:
+                    f.write("    { %s, HTTP_SLOT_%s, 0, NULL },\n" % (SLOT_KINDS[op[2]], op[1].upper()))
+            f.write("};\n\n")
+            f.write("const http_template_t http_template_%s = {\n" % t["name"])
+            f.write("    .ops = http_template_%s_ops,\n" % t["name"])
+            f.write("    .count = %d,\n" % len(ops))
+            f.write("    .text_len = %d,\n" % fixed)
+            f.write("};\n\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("templates", help="diretório dos templates (templates/)")
+    ap.add_argument("--out", required=True, help="diretório de saída")
+    args = ap.parse_args()
+
+    templates = load(args.templates)
+    slots = collect_slots(templates)
+    os.makedirs(args.out, exist_ok=True)
+    write_header(os.path.join(args.out, "http_templates.h"), templates, slots)
+    write_source(os.path.join(args.out, "http_templates.c"), templates)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+"""Gera um perfil de lwipopts a partir de coletas do endpoint /metrics.
+
+Uso:
+    curl -s http://192.168.4.1/metrics > carga1.txt
+    ...
+    tools/lwipopts_profile.py carga1.txt carga2.txt > lwipopts_profile.h
+
+Para cada pool é usado o maior high-water mark (picow_lwip_memp_max) visto em
+todas as coletas, com uma folga percentual, e o resultado é escrito como um
+cabeçalho com #define que pode ser incluído antes dos padrões em lwipopts.h.
+"""
+import argparse
+import math
+import re
+import sys
+
+# pool do memp_std.h -> opção do lwipopts
+POOL_OPTIONS = {
+    "PBUF_POOL": "PBUF_POOL_SIZE",
+    "TCP_PCB": "MEMP_NUM_TCP_PCB",
+    "TCP_PCB_LISTEN": "MEMP_NUM_TCP_PCB_LISTEN",
+    "TCP_SEG": "MEMP_NUM_TCP_SEG",
+    "UDP_PCB": "MEMP_NUM_UDP_PCB",
+    "RAW_PCB": "MEMP_NUM_RAW_PCB",
+    "PBUF": "MEMP_NUM_PBUF",
+    "ARP_QUEUE": "MEMP_NUM_ARP_QUEUE",
+    "SYS_TIMEOUT": "MEMP_NUM_SYS_TIMEOUT",
+    "REASSDATA": "MEMP_NUM_REASSDATA",
+    "FRAG_PBUF": "MEMP_NUM_FRAG_PBUF",
+}
+
+SAMPLE_RE = re.compile(r'^(\w+)(?:\{pool="(\w+)"\})?\s+(\d+)\s*$')
+
+
+def parse(path, peaks):
+    with open(path) as f:
+        for line in f:
+            m = SAMPLE_RE.match(line)
+            if not m:
+                continue
+            name, pool, value = m.group(1), m.group(2), int(m.group(3))
+            key = (name, pool)
+            peaks[key] = max(peaks.get(key, 0), value)
+
+
+def with_headroom(value, headroom, minimum=1):
+    return max(minimum, int(math.ceil(value * (1.0 + headroom / 100.0))))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("scrapes", nargs="+", help="arquivos com a saída de /metrics")
+    ap.add_argument("--headroom", type=float, default=25.0,
+                    help="folga percentual sobre o pico (padrão 25)")
+    args = ap.parse_args()
+
+    peaks = {}
+    for path in args.scrapes:
+        parse(path, peaks)
+    if not peaks:
+        sys.exit("nenhuma métrica encontrada")
+
+    out = sys.stdout
+    out.write("// Gerado por tools/lwipopts_profile.py a partir de %d coleta(s), folga %g%%\n"
+              % (len(args.scrapes), args.headroom))
+    out.write("#ifndef LWIPOPTS_PROFILE_H\n#define LWIPOPTS_PROFILE_H\n\n")
+
+    for pool, option in POOL_OPTIONS.items():
+        peak = peaks.get(("picow_lwip_memp_max", pool))
+        if peak is None:
+            continue
+        size = peaks.get(("picow_lwip_memp_avail", pool), 0)
+        errs = peaks.get(("picow_lwip_memp_err_total", pool), 0)
+        note = "pico %d de %d" % (peak, size)
+        if errs:
+            note += ", %d falha(s): o pico real pode ser maior" % errs
+        out.write("#define %-26s %-6d // %s\n" % (option, with_headroom(peak, args.headroom), note))
+
+    mem_peak = peaks.get(("picow_lwip_mem_max_bytes", None))
+    if mem_peak is not None:
+        mem_size = with_headroom(mem_peak, args.headroom, 1024)
+        mem_size = (mem_size + 3) & ~3
+        out.write("\n// Sem efeito com MEM_LIBC_MALLOC=1 (o heap do lwIP vem do malloc)\n")
+        out.write("#define %-26s %-6d // pico %d bytes\n" % ("MEM_SIZE", mem_size, mem_peak))
+
+    out.write("\n#endif\n")
+
+
+if __name__ == "__main__":
+    main()
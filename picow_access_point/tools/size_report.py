@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Relatório de tamanho de um executável a partir da saída do nm.
+
+Soma o tamanho dos símbolos por tipo (código, dados só de leitura, dados,
+bss), lista os maiores e falha se algum símbolo proibido aparecer, definido
+ou importado. Com --forbid scanf, por exemplo, o build quebra se a família
+scanf da newlib voltar ao firmware; no build host (glibc dinâmica) a mesma
+verificação pega o import de sscanf.
+
+Exemplo:
+    size_report.py build/picow_access_point_poll.elf --nm arm-none-eabi-nm \\
+        --forbid scanf --top 20
+"""
+import argparse
+import re
+import subprocess
+import sys
+
+KINDS = [
+    ("código", "Tt"),
+    ("rodata", "Rr"),
+    ("dados", "DdGg"),
+    ("bss", "BbSs"),
+]
+
+
+def read_symbols(nm, path):
+    out = subprocess.run([nm, "-S", path], check=True, capture_output=True, text=True).stdout
+    sized, names = [], []
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 4:
+            size, kind, name = int(fields[1], 16), fields[2], fields[3]
+            sized.append((size, kind, name))
+        elif len(fields) in (2, 3):
+            name = fields[-1]
+        else:
+            continue
+        names.append(name)
+    return sized, names
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("binary")
+    ap.add_argument("--nm", default="nm", help="nm da toolchain (padrão: nm)")
+    ap.add_argument("--top", type=int, default=15, help="quantos símbolos listar")
+    ap.add_argument("--forbid", action="append", default=[],
+                    help="regex de símbolo proibido (pode repetir)")
+    args = ap.parse_args()
+
+    sized, names = read_symbols(args.nm, args.binary)
+
+    print("%s" % args.binary)
+    for label, kinds in KINDS:
+        total = sum(size for size, kind, _ in sized if kind in kinds)
+        print("  %-8s %8d bytes" % (label, total))
+    print("  maiores símbolos:")
+    for size, kind, name in sorted(sized, reverse=True)[:args.top]:
+        print("    %7d %s %s" % (size, kind, name))
+
+    failed = False
+    for pattern in args.forbid:
+        found = sorted({n for n in names if re.search(pattern, n)})
+        if found:
+            failed = True
+            print("símbolos proibidos (%s): %s" % (pattern, ", ".join(found)), file=sys.stderr)
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Relatório estático de uso de pilha a partir de -fcallgraph-info=su.
+
+Lê os arquivos .ci gerados pelo GCC (um por unidade de compilação), monta o
+grafo de chamadas e calcula, para cada raiz, o caminho de maior consumo de
+pilha. Chamadas por ponteiro não aparecem no grafo, por isso um contexto é
+descrito como uma lista de cadeias "a+b+c" (soma dos piores caminhos de cada
+trecho) e o pior caso do contexto é a maior cadeia. Contextos que dividem a
+mesma pilha física (no RP2040 o laço principal e as interrupções usam a MSP)
+são somados e comparados com o orçamento.
+
+Exemplo:
+    stack_report.py --dir build/CMakeFiles/app.dir --budget 2048 \\
+        --context main=main \\
+        --context irq=cyw43_poll+ethernet_input+dhcp_server_process
+"""
+import argparse
+import os
+import re
+import sys
+
+NODE_RE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"(?:\s*label:\s*"([^"]*)")?')
+EDGE_RE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+USAGE_RE = re.compile(r'(\d+) bytes \((\w+(?:,\w+)*)\)')
+
+INDIRECT = "__indirect_call"
+
+
+class Graph:
+    def __init__(self):
+        self.frame = {}        # função -> bytes do próprio quadro
+        self.qualifier = {}    # função -> static / dynamic / dynamic,bounded
+        self.calls = {}        # função -> conjunto de chamadas diretas
+        self.indirect = set()  # funções que fazem chamadas por ponteiro
+        self.aliases = {}      # nome simples -> títulos ("arquivo.c:f" p/ static)
+
+    def load(self, path):
+        with open(path, errors="replace") as f:
+            text = f.read()
+        for title, label in NODE_RE.findall(text):
+            if title == INDIRECT:
+                continue
+            m = USAGE_RE.search(label.replace("\\n", "\n")) if label else None
+            if m:
+                # Funções static homônimas em arquivos diferentes: fica a maior
+                size = int(m.group(1))
+                if size >= self.frame.get(title, -1):
+                    self.frame[title] = size
+                    self.qualifier[title] = m.group(2)
+            self.calls.setdefault(title, set())
+            self.aliases.setdefault(title.rsplit(":", 1)[-1], set()).add(title)
+        for src, dst in EDGE_RE.findall(text):
+            if dst == INDIRECT:
+                self.indirect.add(src)
+            else:
+                self.calls.setdefault(src, set()).add(dst)
+
+    def worst(self, root):
+        """Retorna (bytes, caminho, avisos) do pior caminho a partir de root."""
+        memo = {}
+        warnings = set()
+
+        def visit(fn, stack):
+            if fn in memo:
+                return memo[fn]
+            if fn in stack:
+                warnings.add("recursão em %s" % fn)
+                return (0, [])
+            if fn not in self.frame:
+                if fn in self.calls or fn.startswith("__"):
+                    warnings.add("sem dados de pilha: %s" % fn)
+                return (0, [fn])
+            q = self.qualifier.get(fn, "static")
+            if q.startswith("dynamic") and "bounded" not in q:
+                warnings.add("pilha dinâmica sem limite: %s" % fn)
+            if fn in self.indirect:
+                warnings.add("chamada por ponteiro não seguida: %s" % fn)
+            stack.add(fn)
+            best = (0, [])
+            for callee in sorted(self.calls.get(fn, ())):
+                r = visit(callee, stack)
+                if r[0] > best[0]:
+                    best = r
+            stack.discard(fn)
+            memo[fn] = (self.frame[fn] + best[0], [fn] + best[1])
+            return memo[fn]
+
+        best = None
+        for title in self.aliases.get(root, ()) | ({root} if root in self.calls else set()):
+            total, path = visit(title, set())
+            if best is None or total > best[0]:
+                best = (total, path)
+        if best is None:
+            return None
+        return best[0], best[1], warnings
+
+
+def short(title):
+    """'dir/arquivo.c:f' -> 'arquivo.c:f'"""
+    return os.path.basename(title)
+
+
+def find_ci(paths):
+    for p in paths:
+        if os.path.isfile(p):
+            yield p
+            continue
+        for dirpath, _, files in os.walk(p):
+            for name in files:
+                if name.endswith(".ci"):
+                    yield os.path.join(dirpath, name)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--dir", action="append", required=True,
+                    help="diretório (ou arquivo .ci) a ler; pode repetir")
+    ap.add_argument("--context", action="append", default=[],
+                    help="NOME=cadeia[|cadeia...], cadeia = raiz[+raiz...]")
+    ap.add_argument("--budget", type=int, default=0,
+                    help="bytes disponíveis na pilha compartilhada pelos contextos (0: só relata)")
+    ap.add_argument("--top", type=int, default=10, help="maiores quadros a listar")
+    ap.add_argument("--verbose", action="store_true", help="mostra avisos e caminhos completos")
+    args = ap.parse_args()
+
+    g = Graph()
+    files = list(find_ci(args.dir))
+    if not files:
+        sys.exit("nenhum arquivo .ci encontrado (compilar com -fcallgraph-info=su)")
+    for path in files:
+        g.load(path)
+
+    print("stack report: %d unidades, %d funções" % (len(files), len(g.frame)))
+    print("maiores quadros:")
+    for fn, size in sorted(g.frame.items(), key=lambda kv: -kv[1])[:args.top]:
+        print("  %6d  %s" % (size, short(fn)))
+
+    total = 0
+    failed = False
+    for spec in args.context:
+        name, _, chains = spec.partition("=")
+        worst = None
+        for chain in chains.split("|"):
+            size, path, warnings = 0, [], set()
+            missing = False
+            for root in chain.split("+"):
+                r = g.worst(root)
+                if r is None:
+                    print("contexto %s: função %s não encontrada" % (name, root))
+                    failed = missing = True
+                    break
+                size += r[0]
+                path += [short(fn) for fn in r[1]]
+                warnings |= r[2]
+            if missing:
+                continue
+            if worst is None or size > worst[0]:
+                worst = (size, chain, path, warnings)
+        if worst is None:
+            continue
+        size, chain, path, warnings = worst
+        total += size
+        print("contexto %-6s %6d bytes  (%s)" % (name, size, chain))
+        print("  caminho: %s" % (" > ".join(path) if args.verbose else " > ".join(path[:8]) + (" > ..." if len(path) > 8 else "")))
+        if warnings:
+            print("  %d aviso(s)%s" % (len(warnings), "" if args.verbose else " (--verbose)"))
+            if args.verbose:
+                for w in sorted(warnings):
+                    print("    %s" % w)
+
+    if args.budget:
+        print("total %d de %d bytes" % (total, args.budget))
+        if total > args.budget:
+            print("ERRO: orçamento de pilha excedido em %d bytes" % (total - args.budget))
+            failed = True
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
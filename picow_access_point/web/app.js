@@ -0,0 +1,58 @@
+// Painel do alarme: estado inicial por GET /api/state, comandos por
+// POST /api/alarm e atualizações ao vivo por /alarm/events (Server-Sent
+// Events, que o navegador reconecta sozinho)
+'use strict';
+
+var $ = function (id) { return document.getElementById(id); };
+var active = false;
+
+// s: documento de /api/state, ou o evento de /alarm/events (sem dropped e
+// uptime_ms)
+function show(s) {
+  active = !!s.active;
+  $('state').textContent = active ? 'ATIVADO' : 'DESATIVADO';
+  $('state').className = 'state ' + (active ? 'on' : 'off');
+  $('toggle').textContent = active ? 'Desligar' : 'Ligar';
+  $('toggle').disabled = false;
+  $('test').disabled = false;
+  $('commands').textContent = s.commands;
+  if (s.dropped !== undefined) {
+    $('dropped').textContent = s.dropped;
+  }
+  if (s.uptime_ms !== undefined) {
+    $('uptime').textContent = Math.floor(s.uptime_ms / 1000) + ' s';
+  }
+}
+
+function fail(message) {
+  $('error').textContent = message;
+}
+
+function refresh() {
+  fetch('/api/state')
+    .then(function (r) { return r.json(); })
+    .then(show)
+    .catch(function () { fail('Sem resposta do alarme'); });
+}
+
+function send(alarm) {
+  fail('');
+  fetch('/api/alarm', { method: 'POST', body: JSON.stringify({ alarm: alarm }) })
+    .then(function (r) { return r.json(); })
+    .then(function (s) {
+      if (s.error) {
+        fail(s.error);
+      } else {
+        show(s);
+      }
+    })
+    .catch(function () { fail('Comando não enviado'); });
+}
+
+$('toggle').onclick = function () { send(active ? 'off' : 'on'); };
+$('test').onclick = function () { send('test'); };
+
+refresh();
+if (window.EventSource) {
+  new EventSource('/alarm/events').onmessage = function (e) { show(JSON.parse(e.data)); };
+}